@@ -0,0 +1,260 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::bus::application {
+// Blobs addressed by ID, such as onboard logs or calibration tables. An upload
+// may fill a blob up to GetBlobSize() bytes.
+template <typename T>
+concept BlobStorageConcept =
+    requires(T storage, uint8_t blob_id, uint32_t offset,
+             std::span<std::byte> read_buffer,
+             std::span<const std::byte> write_buffer) {
+      { storage.GetBlobSize(blob_id) } -> std::same_as<Expected<uint32_t>>;
+      {
+        storage.ReadBlob(blob_id, offset, read_buffer)
+      } -> std::same_as<ReturnCode>;
+      {
+        storage.WriteBlob(blob_id, offset, write_buffer)
+      } -> std::same_as<ReturnCode>;
+    };
+
+constexpr uint32_t GetChunksCount(uint32_t length) {
+  return (length + kChunkSize - 1) / kChunkSize;
+}
+
+// Sending half of a windowed transfer. Up to kWindow chunks may be in flight;
+// holes reported by an ack are resent once, everything unacknowledged is
+// resent after a timeout or when the receiver repeats its last ack.
+template <int kWindow = kTransferWindow>
+class BlockSender final {
+ public:
+  static_assert(kWindow > 0 && kWindow <= kTransferWindow,
+                "Window must be covered by the ack bitmap");
+
+  BlockSender() = default;
+  BlockSender(const BlockSender&) = delete;
+  BlockSender(BlockSender&&) = delete;
+  BlockSender& operator=(const BlockSender&) = delete;
+  BlockSender& operator=(BlockSender&&) = delete;
+  ~BlockSender() = default;
+
+  void Start(uint32_t chunks_count);
+  // Returns false when the window allows no chunk to be sent now.
+  bool GetNextChunk(uint32_t& index);
+  // Returns true when the ack acknowledged new chunks.
+  bool HandleAck(const TransferAck& ack);
+  void RetransmitAll();
+
+  [[nodiscard]] bool IsDone() const;
+  [[nodiscard]] uint32_t GetAckedChunks() const;
+
+ private:
+  using Bitmap = uint32_t;
+
+  static Bitmap GetMask(uint32_t length);
+
+  uint32_t chunks_count_ = 0;
+  uint32_t base_ = 0;
+  uint32_t next_ = 0;
+  // Bit i stands for chunk base_ + i.
+  Bitmap acked_ = 0;
+  Bitmap resend_ = 0;
+  Bitmap resent_ = 0;
+  TransferAck last_ack_{};
+};
+
+// Receiving half of a windowed transfer. Acks are due after a quarter of the
+// window, on a new hole, on duplicates and at the end.
+template <int kWindow = kTransferWindow>
+class BlockReceiver final {
+ public:
+  static_assert(kWindow > 0 && kWindow <= kTransferWindow,
+                "Window must be covered by the ack bitmap");
+
+  BlockReceiver() = default;
+  BlockReceiver(const BlockReceiver&) = delete;
+  BlockReceiver(BlockReceiver&&) = delete;
+  BlockReceiver& operator=(const BlockReceiver&) = delete;
+  BlockReceiver& operator=(BlockReceiver&&) = delete;
+  ~BlockReceiver() = default;
+
+  void Start(uint32_t chunks_count);
+  // Returns true for a new chunk which has to be stored.
+  bool Accept(uint32_t index);
+  [[nodiscard]] bool IsAckDue() const;
+  TransferAck MakeAck();
+
+  [[nodiscard]] bool IsDone() const;
+  [[nodiscard]] uint32_t GetReceivedChunks() const;
+
+ private:
+  uint32_t chunks_count_ = 0;
+  uint32_t base_ = 0;
+  uint32_t expected_ = 0;
+  // Bit i stands for chunk base_ + i.
+  uint32_t received_ = 0;
+  int unacked_count_ = 0;
+  bool is_ack_forced_ = false;
+};
+
+template <int kWindow>
+void BlockSender<kWindow>::Start(uint32_t chunks_count) {
+  chunks_count_ = chunks_count;
+  base_ = 0;
+  next_ = 0;
+  acked_ = 0;
+  resend_ = 0;
+  resent_ = 0;
+  last_ack_ = {};
+}
+
+template <int kWindow>
+bool BlockSender<kWindow>::GetNextChunk(uint32_t& index) {
+  if (resend_ != 0) {
+    int position = std::countr_zero(resend_);
+    resend_ &= ~(Bitmap{1} << position);
+    resent_ |= Bitmap{1} << position;
+    index = base_ + position;
+    return true;
+  }
+  if (next_ < chunks_count_ && next_ < base_ + kWindow) {
+    index = next_++;
+    return true;
+  }
+  return false;
+}
+
+template <int kWindow>
+bool BlockSender<kWindow>::HandleAck(const TransferAck& ack) {
+  if (ack.base < base_ || ack.base > next_) {
+    return false;
+  }
+  bool is_repeated = ack.base == last_ack_.base &&
+                     ack.bitmap == last_ack_.bitmap &&
+                     next_ == std::min(chunks_count_, base_ + kWindow);
+  last_ack_ = ack;
+
+  auto shift = ack.base - base_;
+  bool is_progress = shift != 0;
+  if (shift >= static_cast<uint32_t>(kTransferWindow)) {
+    acked_ = 0;
+    resend_ = 0;
+    resent_ = 0;
+  } else {
+    acked_ >>= shift;
+    resend_ >>= shift;
+    resent_ >>= shift;
+  }
+  base_ = ack.base;
+
+  Bitmap acked = (ack.bitmap << 1) & GetMask(next_ - base_);
+  is_progress = is_progress || (acked & ~acked_) != 0;
+  acked_ |= acked;
+  resend_ &= ~acked_;
+
+  if (is_repeated && !is_progress) {
+    RetransmitAll();
+    return false;
+  }
+  if (acked_ != 0) {
+    int highest = std::bit_width(acked_) - 1;
+    Bitmap holes = ~acked_ & GetMask(highest);
+    resend_ |= holes & ~resent_;
+  }
+  return is_progress;
+}
+
+template <int kWindow>
+void BlockSender<kWindow>::RetransmitAll() {
+  resend_ = ~acked_ & GetMask(next_ - base_);
+  resent_ = 0;
+}
+
+template <int kWindow>
+bool BlockSender<kWindow>::IsDone() const {
+  return base_ == chunks_count_;
+}
+
+template <int kWindow>
+uint32_t BlockSender<kWindow>::GetAckedChunks() const {
+  return base_;
+}
+
+template <int kWindow>
+typename BlockSender<kWindow>::Bitmap BlockSender<kWindow>::GetMask(
+    uint32_t length) {
+  if (length >= sizeof(Bitmap) * 8) {
+    return ~Bitmap{0};
+  }
+  return (Bitmap{1} << length) - 1;
+}
+
+template <int kWindow>
+void BlockReceiver<kWindow>::Start(uint32_t chunks_count) {
+  chunks_count_ = chunks_count;
+  base_ = 0;
+  expected_ = 0;
+  received_ = 0;
+  unacked_count_ = 0;
+  is_ack_forced_ = false;
+}
+
+template <int kWindow>
+bool BlockReceiver<kWindow>::Accept(uint32_t index) {
+  if (index >= chunks_count_ || index >= base_ + kWindow) {
+    return false;
+  }
+  if (index < base_ || (received_ & (1U << (index - base_))) != 0) {
+    // The sender missed an ack.
+    is_ack_forced_ = true;
+    return false;
+  }
+
+  if (index != expected_) {
+    is_ack_forced_ = true;
+  }
+  if (index >= expected_) {
+    expected_ = index + 1;
+  }
+  received_ |= 1U << (index - base_);
+  while ((received_ & 1U) != 0) {
+    received_ >>= 1;
+    base_++;
+  }
+  unacked_count_++;
+  return true;
+}
+
+template <int kWindow>
+bool BlockReceiver<kWindow>::IsAckDue() const {
+  return is_ack_forced_ || unacked_count_ >= (kWindow + 3) / 4 ||
+         (IsDone() && unacked_count_ != 0);
+}
+
+template <int kWindow>
+TransferAck BlockReceiver<kWindow>::MakeAck() {
+  unacked_count_ = 0;
+  is_ack_forced_ = false;
+  return {.base = base_, .bitmap = received_ >> 1};
+}
+
+template <int kWindow>
+bool BlockReceiver<kWindow>::IsDone() const {
+  return base_ == chunks_count_;
+}
+
+template <int kWindow>
+uint32_t BlockReceiver<kWindow>::GetReceivedChunks() const {
+  return base_;
+}
+
+}  // namespace hydrolib::bus::application
@@ -4,30 +4,126 @@
 #include <cstdint>
 
 namespace hydrolib::bus::application {
-enum class Command : uint8_t { kWrite, kRead, kResponse, kError };
+// kReadBatch carries a list of MemoryAccessInfo descriptors and is answered
+// with one kResponse holding the regions back to back. kWriteBatch carries a
+// list of MemoryAccessInfo descriptors, each followed by its data.
+// kSubscribe carries a SubscriptionInfo and is answered with the current value
+// of the region; afterwards the slave pushes kPublish messages on its own with
+// the subscription's transaction ID until kUnsubscribe. kReadChanges carries a
+// ChangesRequest and is answered with a ChangesHeader followed by the blocks
+// modified since that version, encoded like the kWriteBatch payload.
+// kOpenTransfer carries a TransferRequest and is answered with a TransferInfo;
+// the sending side then streams kTransferData chunks (a ChunkHeader followed by
+// up to kChunkSize bytes) under the transaction ID of the open request, the
+// receiving side answers with kTransferAck holding a TransferAck, and the
+// master ends the transfer with kCloseTransfer.
+enum class Command : uint8_t {
+  kWrite,
+  kRead,
+  kResponse,
+  kError,
+  kReadBatch,
+  kWriteBatch,
+  kSubscribe,
+  kUnsubscribe,
+  kPublish,
+  kReadChanges,
+  kOpenTransfer,
+  kTransferData,
+  kTransferAck,
+  kCloseTransfer
+};
+
+using TransactionId = uint8_t;
 
 struct MemoryAccessInfo {
   uint8_t address;
   uint8_t length;
 } __attribute__((__packed__));
 
+// Responses and errors echo the transaction ID of the request, so several
+// requests may be outstanding and answered in any order. `info.length` is the
+// payload length of every message except kRead, where it is the requested one.
 struct MemoryAccessHeader {
   Command command;
+  TransactionId transaction_id;
   MemoryAccessInfo info;
 } __attribute__((__packed__));
 
+// kPeriodic pushes the region every period, kOnChange checks it every period
+// (or every slave cycle for a zero period) and pushes only when it changed.
+enum class SubscriptionMode : uint8_t { kPeriodic, kOnChange };
+
+struct SubscriptionInfo {
+  MemoryAccessInfo region;
+  uint16_t period_ms;
+  SubscriptionMode mode;
+} __attribute__((__packed__));
+
+using MemoryVersion = uint16_t;
+
+// Without `is_synced`, or if `since_version` is not the slave's current one,
+// the whole memory is sent.
+struct ChangesRequest {
+  MemoryVersion since_version;
+  uint8_t is_synced;
+} __attribute__((__packed__));
+
+// `has_more` is set when the changes did not fit into one response; the rest
+// is sent for the next request with the returned version.
+struct ChangesHeader {
+  MemoryVersion version;
+  uint8_t has_more;
+} __attribute__((__packed__));
+
+enum class TransferDirection : uint8_t { kDownload, kUpload };
+
+// A transfer starts at `offset` bytes into the blob, so a broken transfer is
+// resumed from the data already received. `size` is the full blob size of an
+// upload and ignored for a download.
+struct TransferRequest {
+  uint8_t blob_id;
+  TransferDirection direction;
+  uint32_t offset;
+  uint32_t size;
+} __attribute__((__packed__));
+
+struct TransferInfo {
+  uint32_t size;
+} __attribute__((__packed__));
+
+// Chunk indices count from the offset of the transfer.
+struct ChunkHeader {
+  uint32_t index;
+} __attribute__((__packed__));
+
+// Every chunk below `base` has been received; bit i of `bitmap` is set when
+// chunk base + 1 + i has been received as well.
+struct TransferAck {
+  uint32_t base;
+  uint32_t bitmap;
+} __attribute__((__packed__));
+
 constexpr unsigned kMaxDataLength = UINT8_MAX;
 constexpr unsigned kMaxMessageLength =
     sizeof(MemoryAccessHeader) + kMaxDataLength;
+constexpr int kMaxBatchRegions = 8;
+constexpr int kMaxSubscriptions = 8;
+// A chunk message has to fit into one sequenced datalink frame: 249 payload
+// bytes minus the two byte sequence header.
+constexpr unsigned kMaxChunkMessageLength = 247;
+constexpr unsigned kChunkSize =
+    kMaxChunkMessageLength - sizeof(MemoryAccessHeader) - sizeof(ChunkHeader);
+// Chunks a sender may have unacknowledged, limited by the ack bitmap.
+constexpr int kTransferWindow = 32;
 
 struct MemoryAccessMessageBuffer {
   MemoryAccessHeader header;
   std::byte data[kMaxDataLength];  // NOLINT
 } __attribute__((__packed__));
 
-struct ResponseMessageBuffer {
-  Command command;
-  std::byte data[kMaxDataLength];  // NOLINT
-} __attribute__((__packed__));
+constexpr unsigned GetPayloadLength(const MemoryAccessHeader& header) {
+  return header.command == Command::kRead ? 0 : header.info.length;
+}
 
 }  // namespace hydrolib::bus::application
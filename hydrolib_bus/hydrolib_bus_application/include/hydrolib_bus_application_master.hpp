@@ -3,116 +3,1058 @@
 #include <unistd.h>
 
 #include <algorithm>
+#include <array>
 #include <chrono>
 #include <cstring>
 #include <span>
 
+#include "hydrolib_bus_application_block_transfer.hpp"
 #include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_bus_application_receiver.hpp"
+#include "hydrolib_clock_concepts.hpp"
 #include "hydrolib_log_macro.hpp"
 #include "hydrolib_return_codes.hpp"
 #include "hydrolib_stream_concepts.hpp"
+#include "hydrolib_timer_wheel.hpp"
 
 namespace hydrolib::bus::application {
 using namespace std::literals::chrono_literals;
 
-template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger>
+struct ReadRegion {
+  int address;
+  std::span<std::byte> data;
+};
+
+struct WriteRegion {
+  int address;
+  std::span<const std::byte> data;
+};
+
+// Up to kWindowSize reads may be outstanding at once. Every request carries a
+// transaction ID, responses are matched by it in any order and each read is
+// retransmitted on its own timeout. Timeouts run on a timer wheel, either a
+// private one advanced by Process() or one shared with other masters and
+// advanced by its owner. Batched requests gather up to kMaxBatchRegions regions
+// into a single bus transaction. Subscribed regions are kept up to date by the
+// slave, each push counts as an update. A mirror of a change-tracking slave
+// memory is kept in sync with RequestChanges, which only transfers the blocks
+// modified since the previous sync. Blobs larger than one message are
+// downloaded or uploaded as a windowed transfer, one at a time; a broken
+// transfer is continued with ResumeTransfer().
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize = 8,
+          concepts::clock::ClockConcept Clock = std::chrono::steady_clock>
 class Master {
  public:
-  static constexpr auto kRequestTimeout = 1s;
+  using Timers = timer::TimerWheel<Clock>;
+
+  static constexpr auto kDefaultRequestTimeout = 1s;
+  static constexpr auto kTimerTick = 1ms;
+  static constexpr int kMaxTransferRetries = 5;
 
-  constexpr Master(TxRxStream& stream, Logger& logger);
+  Master(TxRxStream& stream, Logger& logger);
+  Master(TxRxStream& stream, Logger& logger, Timers& timers);
   Master(const Master&) = delete;
   Master(Master&&) = delete;
   Master& operator=(const Master&) = delete;
   Master& operator=(Master&&) = delete;
-  ~Master() = default;
+  ~Master();
 
   hydrolib::ReturnCode Process();
-  void RequestRead(const std::span<std::byte>& data, int address);
+  Expected<TransactionId> RequestRead(const std::span<std::byte>& data,
+                                      int address);
+  Expected<TransactionId> RequestRead(std::span<const ReadRegion> regions);
   void RequestWrite(std::span<const std::byte> data, int address);
+  hydrolib::ReturnCode RequestWrite(std::span<const WriteRegion> regions);
+
+  Expected<TransactionId> Subscribe(std::span<std::byte> data, int address,
+                                    std::chrono::milliseconds period,
+                                    SubscriptionMode mode);
+  hydrolib::ReturnCode Unsubscribe(TransactionId subscription_id);
+
+  Expected<TransactionId> RequestChanges(std::span<std::byte> mirror);
+  Expected<TransactionId> RequestDownload(uint8_t blob_id,
+                                          std::span<std::byte> destination,
+                                          uint32_t offset = 0);
+  Expected<TransactionId> RequestUpload(uint8_t blob_id,
+                                        std::span<const std::byte> source,
+                                        uint32_t offset = 0);
+  // Reopens the last transfer from the bytes confirmed so far.
+  Expected<TransactionId> ResumeTransfer();
+  // NO_DATA while the transfer runs, OK when it has finished, FAIL without
+  // a transfer and the error of a failed one.
+  [[nodiscard]] hydrolib::ReturnCode GetTransferStatus() const;
+  // Bytes from the start of the blob confirmed by the other side.
+  [[nodiscard]] uint32_t GetTransferredBytes() const;
+
+  // Stops waiting for a read, a late response to it is dropped.
+  hydrolib::ReturnCode Cancel(TransactionId transaction_id);
+  // Applies to the requests and transfers started afterwards.
+  void SetRequestTimeout(typename Clock::duration timeout);
+  [[nodiscard]] bool HasMoreChanges() const;
+
+  [[nodiscard]] bool IsPending(TransactionId transaction_id) const;
+  [[nodiscard]] int GetPendingCount() const;
+  [[nodiscard]] int GetUpdatesCount(TransactionId subscription_id) const;
 
  private:
+  struct Transaction {
+    bool is_active = false;
+    Command command = Command::kRead;
+    TransactionId id = 0;
+    int regions_count = 0;
+    std::array<ReadRegion, kMaxBatchRegions> regions{};
+    SubscriptionInfo subscription{};
+    TransferRequest transfer{};
+    typename Clock::duration timeout{};
+    timer::Timer timer;
+  };
+
+  struct Subscription {
+    bool is_active = false;
+    TransactionId id = 0;
+    std::span<std::byte> data;
+    int updates_count = 0;
+  };
+
+  static_assert(kWindowSize > 0 && kWindowSize <= UINT8_MAX,
+                "Window must fit into transaction IDs");
+
+  static void OnRequestTimeout(void* context);
+
+  Transaction* FindTransaction(TransactionId transaction_id);
+  Subscription* FindSubscription(TransactionId subscription_id);
+  Transaction* StartRead(std::span<const ReadRegion> regions, Command command);
+  void ReleaseTransaction(Transaction& transaction);
+  void TransmitUnsubscribe(TransactionId subscription_id);
+  TransactionId AllocateId();
+  void TransmitRead(const Transaction& transaction);
+  static unsigned GetResponseLength(const Transaction& transaction);
+  void Scatter(const Transaction& transaction,
+               std::span<const std::byte> data);
+  hydrolib::ReturnCode HandleMessage(const MemoryAccessMessageBuffer& message);
+  hydrolib::ReturnCode HandlePublish(const MemoryAccessMessageBuffer& message);
+  hydrolib::ReturnCode ApplyChanges(const Transaction& transaction,
+                                    std::span<const std::byte> payload);
+  Expected<TransactionId> OpenTransfer(TransferRequest request);
+  void StartTransfer();
+  hydrolib::ReturnCode ProcessTransfer();
+  hydrolib::ReturnCode HandleChunk(const MemoryAccessMessageBuffer& message);
+  hydrolib::ReturnCode HandleTransferAck(
+      const MemoryAccessMessageBuffer& message);
+  void TransmitChunk(uint32_t index);
+  void TransmitTransferAck();
+  void FinishTransfer(hydrolib::ReturnCode result);
+  [[nodiscard]] uint32_t GetChunkLength(uint32_t index) const;
+
   TxRxStream& stream_;
   Logger& logger_;
 
-  std::span<std::byte> requested_data_;
+  Timers own_timers_;
+  Timers& timers_;
+  typename Clock::duration request_timeout_ = kDefaultRequestTimeout;
+  int expired_count_ = 0;
 
-  ResponseMessageBuffer rx_buffer_{};
+  MessageReceiver<TxRxStream> receiver_;
   MemoryAccessMessageBuffer tx_buffer_{};
 
-  std::chrono::steady_clock::time_point last_request_time_;
+  std::array<Transaction, kWindowSize> transactions_{};
+  int pending_count_ = 0;
+  TransactionId next_id_ = 0;
+  TransactionId last_transaction_ = 0;
+
+  std::array<Subscription, kMaxSubscriptions> subscriptions_{};
+  int subscriptions_count_ = 0;
+
+  MemoryVersion changes_version_ = 0;
+  bool is_changes_synced_ = false;
+  bool has_more_changes_ = false;
+
+  TransferRequest transfer_{};
+  TransactionId transfer_id_ = 0;
+  std::span<std::byte> download_data_;
+  std::span<const std::byte> upload_data_;
+  std::array<std::byte, sizeof(TransferInfo)> transfer_info_{};
+  uint32_t transfer_size_ = 0;
+  bool is_transferring_ = false;
+  hydrolib::ReturnCode transfer_status_ = hydrolib::ReturnCode::FAIL;
+  BlockSender<> transfer_sender_;
+  BlockReceiver<> transfer_receiver_;
+  timer::Timer transfer_timer_;
+  typename Clock::duration transfer_timeout_{};
+  int transfer_retries_ = 0;
 };
 
-template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger>
-constexpr Master<TxRxStream, Logger>::Master(TxRxStream& stream, Logger& logger)
-    : stream_(stream), logger_(logger) {}
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Master<TxRxStream, Logger, kWindowSize, Clock>::Master(TxRxStream& stream,
+                                                       Logger& logger)
+    : stream_(stream),
+      logger_(logger),
+      own_timers_(kTimerTick),
+      timers_(own_timers_),
+      receiver_(stream) {}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Master<TxRxStream, Logger, kWindowSize, Clock>::Master(TxRxStream& stream,
+                                                       Logger& logger,
+                                                       Timers& timers)
+    : stream_(stream),
+      logger_(logger),
+      own_timers_(kTimerTick),
+      timers_(timers),
+      receiver_(stream) {}
 
-template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger>
-hydrolib::ReturnCode Master<TxRxStream, Logger>::Process() {
-  if (requested_data_.empty()) {
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Master<TxRxStream, Logger, kWindowSize, Clock>::~Master() {
+  for (auto& transaction : transactions_) {
+    timers_.Stop(transaction.timer);
+  }
+  timers_.Stop(transfer_timer_);
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode Master<TxRxStream, Logger, kWindowSize, Clock>::Process() {
+  if (pending_count_ == 0 && subscriptions_count_ == 0 && !is_transferring_) {
     return hydrolib::ReturnCode::FAIL;
   }  // TODO: vscode - fix FAIL after Write
      // https://app.weeek.net/ws/701833/task/1066
 
-  if (std::chrono::steady_clock::now() - last_request_time_ > kRequestTimeout) {
-    LOG_ERROR(logger_, "Request timeout");
-    write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader));
-    last_request_time_ = std::chrono::steady_clock::now();
+  if (&timers_ == &own_timers_) {
+    own_timers_.Process();
+  }
+  for (auto& transaction : transactions_) {
+    if (expired_count_ == 0) {
+      break;
+    }
+    if (transaction.is_active && transaction.timer.IsExpired()) {
+      LOG_ERROR(logger_, "Request {} timeout", transaction.id);
+      expired_count_--;
+      TransmitRead(transaction);
+      timers_.Start(transaction.timer, transaction.timeout, OnRequestTimeout,
+                    this);
+      return hydrolib::ReturnCode::TIMEOUT;
+    }
+  }
+  if (is_transferring_ &&
+      ProcessTransfer() == hydrolib::ReturnCode::TIMEOUT) {
     return hydrolib::ReturnCode::TIMEOUT;
   }
 
-  int read_length = read(stream_, &rx_buffer_, kMaxMessageLength);
-  if (read_length == 0) {
-    return hydrolib::ReturnCode::NO_DATA;
+  auto result = receiver_.Process();
+  if (result != hydrolib::ReturnCode::OK) {
+    return result;
+  }
+  return HandleMessage(receiver_.GetMessage());
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Expected<TransactionId>
+Master<TxRxStream, Logger, kWindowSize, Clock>::RequestRead(
+    const std::span<std::byte>& data, int address) {
+  ReadRegion region{.address = address, .data = data};
+  auto* transaction = StartRead(std::span(&region, 1), Command::kRead);
+  if (transaction == nullptr) {
+    return hydrolib::ReturnCode::OVERFLOW;
+  }
+  TransmitRead(*transaction);
+  return transaction->id;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Expected<TransactionId>
+Master<TxRxStream, Logger, kWindowSize, Clock>::RequestRead(
+    std::span<const ReadRegion> regions) {
+  auto* transaction = StartRead(regions, Command::kReadBatch);
+  if (transaction == nullptr) {
+    return hydrolib::ReturnCode::OVERFLOW;
+  }
+  TransmitRead(*transaction);
+  return transaction->id;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::RequestWrite(
+    std::span<const std::byte> data, int address) {
+  tx_buffer_.header.command = Command::kWrite;
+  tx_buffer_.header.transaction_id = AllocateId();
+  tx_buffer_.header.info.address = address;
+  tx_buffer_.header.info.length = data.size();
+
+  std::ranges::copy(data.begin(), data.end(),
+                    static_cast<std::byte*>(tx_buffer_.data));
+
+  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader) + data.size());
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::RequestWrite(
+    std::span<const WriteRegion> regions) {
+  unsigned length = 0;
+  for (const auto& region : regions) {
+    length += sizeof(MemoryAccessInfo) + region.data.size();
+  }
+  if (regions.empty() || regions.size() > kMaxBatchRegions ||
+      length > kMaxDataLength) {
+    return hydrolib::ReturnCode::OVERFLOW;
+  }
+
+  tx_buffer_.header.command = Command::kWriteBatch;
+  tx_buffer_.header.transaction_id = AllocateId();
+  tx_buffer_.header.info.address = 0;
+  tx_buffer_.header.info.length = length;
+
+  auto* position = static_cast<std::byte*>(tx_buffer_.data);
+  for (const auto& region : regions) {
+    MemoryAccessInfo info{.address = static_cast<uint8_t>(region.address),
+                          .length = static_cast<uint8_t>(region.data.size())};
+    std::memcpy(position, &info, sizeof(info));
+    position = std::ranges::copy(region.data, position + sizeof(info)).out;
+  }
+
+  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader) + length);
+  return hydrolib::ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Expected<TransactionId>
+Master<TxRxStream, Logger, kWindowSize, Clock>::Subscribe(
+    std::span<std::byte> data, int address, std::chrono::milliseconds period,
+    SubscriptionMode mode) {
+  if (period.count() < 0 || period.count() > UINT16_MAX) {
+    return hydrolib::ReturnCode::FAIL;
+  }
+  auto free_subscription = std::ranges::find_if(
+      subscriptions_, [](const Subscription& subscription) {
+        return !subscription.is_active;
+      });
+  if (free_subscription == subscriptions_.end()) {
+    return hydrolib::ReturnCode::OVERFLOW;
+  }
+
+  ReadRegion region{.address = address, .data = data};
+  auto* transaction = StartRead(std::span(&region, 1), Command::kSubscribe);
+  if (transaction == nullptr) {
+    return hydrolib::ReturnCode::OVERFLOW;
+  }
+  transaction->subscription = {
+      .region = {.address = static_cast<uint8_t>(address),
+                 .length = static_cast<uint8_t>(data.size())},
+      .period_ms = static_cast<uint16_t>(period.count()),
+      .mode = mode};
+  *free_subscription = {.is_active = true,
+                        .id = transaction->id,
+                        .data = data,
+                        .updates_count = 0};
+  subscriptions_count_++;
+  TransmitRead(*transaction);
+  return transaction->id;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::Unsubscribe(
+    TransactionId subscription_id) {
+  auto* subscription = FindSubscription(subscription_id);
+  if (subscription == nullptr) {
+    return hydrolib::ReturnCode::FAIL;
+  }
+  subscription->is_active = false;
+  subscriptions_count_--;
+  auto* transaction = FindTransaction(subscription_id);
+  if (transaction != nullptr) {
+    ReleaseTransaction(*transaction);
+  }
+  TransmitUnsubscribe(subscription_id);
+  return hydrolib::ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Expected<TransactionId>
+Master<TxRxStream, Logger, kWindowSize, Clock>::RequestChanges(
+    std::span<std::byte> mirror) {
+  bool is_requested = std::ranges::any_of(
+      transactions_, [](const Transaction& transaction) {
+        return transaction.is_active &&
+               transaction.command == Command::kReadChanges;
+      });
+  if (is_requested) {
+    return hydrolib::ReturnCode::FAIL;
+  }
+
+  ReadRegion region{.address = 0, .data = mirror};
+  auto* transaction = StartRead(std::span(&region, 1), Command::kReadChanges);
+  if (transaction == nullptr) {
+    return hydrolib::ReturnCode::OVERFLOW;
+  }
+  TransmitRead(*transaction);
+  return transaction->id;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Expected<TransactionId>
+Master<TxRxStream, Logger, kWindowSize, Clock>::RequestDownload(
+    uint8_t blob_id, std::span<std::byte> destination, uint32_t offset) {
+  if (offset > destination.size()) {
+    return hydrolib::ReturnCode::FAIL;
+  }
+  download_data_ = destination;
+  upload_data_ = {};
+  return OpenTransfer({.blob_id = blob_id,
+                       .direction = TransferDirection::kDownload,
+                       .offset = offset,
+                       .size = 0});
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Expected<TransactionId>
+Master<TxRxStream, Logger, kWindowSize, Clock>::RequestUpload(
+    uint8_t blob_id, std::span<const std::byte> source, uint32_t offset) {
+  if (offset > source.size()) {
+    return hydrolib::ReturnCode::FAIL;
+  }
+  download_data_ = {};
+  upload_data_ = source;
+  return OpenTransfer({.blob_id = blob_id,
+                       .direction = TransferDirection::kUpload,
+                       .offset = offset,
+                       .size = static_cast<uint32_t>(source.size())});
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Expected<TransactionId>
+Master<TxRxStream, Logger, kWindowSize, Clock>::ResumeTransfer() {
+  if (transfer_status_ == hydrolib::ReturnCode::FAIL ||
+      transfer_status_ == hydrolib::ReturnCode::OK) {
+    return hydrolib::ReturnCode::FAIL;
+  }
+  auto request = transfer_;
+  request.offset = GetTransferredBytes();
+  return OpenTransfer(request);
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::GetTransferStatus() const {
+  return transfer_status_;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+uint32_t
+Master<TxRxStream, Logger, kWindowSize, Clock>::GetTransferredBytes() const {
+  if (!is_transferring_) {
+    return transfer_status_ == hydrolib::ReturnCode::OK ? transfer_size_
+                                                         : transfer_.offset;
+  }
+  uint32_t chunks = transfer_.direction == TransferDirection::kDownload
+                        ? transfer_receiver_.GetReceivedChunks()
+                        : transfer_sender_.GetAckedChunks();
+  return std::min(transfer_size_, transfer_.offset + chunks * kChunkSize);
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode Master<TxRxStream, Logger, kWindowSize, Clock>::Cancel(
+    TransactionId transaction_id) {
+  auto* transaction = FindTransaction(transaction_id);
+  if (transaction == nullptr || transaction->command == Command::kSubscribe) {
+    return hydrolib::ReturnCode::FAIL;
+  }
+  ReleaseTransaction(*transaction);
+  return hydrolib::ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::SetRequestTimeout(
+    typename Clock::duration timeout) {
+  request_timeout_ = timeout;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+bool Master<TxRxStream, Logger, kWindowSize, Clock>::HasMoreChanges() const {
+  return has_more_changes_;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+bool Master<TxRxStream, Logger, kWindowSize, Clock>::IsPending(
+    TransactionId transaction_id) const {
+  return std::ranges::any_of(
+      transactions_, [transaction_id](const Transaction& transaction) {
+        return transaction.is_active && transaction.id == transaction_id;
+      });
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+int Master<TxRxStream, Logger, kWindowSize, Clock>::GetPendingCount() const {
+  return pending_count_;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+int Master<TxRxStream, Logger, kWindowSize, Clock>::GetUpdatesCount(
+    TransactionId subscription_id) const {
+  for (const auto& subscription : subscriptions_) {
+    if (subscription.is_active && subscription.id == subscription_id) {
+      return subscription.updates_count;
+    }
+  }
+  return 0;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+typename Master<TxRxStream, Logger, kWindowSize, Clock>::Transaction*
+Master<TxRxStream, Logger, kWindowSize, Clock>::FindTransaction(
+    TransactionId transaction_id) {
+  for (auto& transaction : transactions_) {
+    if (transaction.is_active && transaction.id == transaction_id) {
+      return &transaction;
+    }
+  }
+  return nullptr;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+typename Master<TxRxStream, Logger, kWindowSize, Clock>::Subscription*
+Master<TxRxStream, Logger, kWindowSize, Clock>::FindSubscription(
+    TransactionId subscription_id) {
+  for (auto& subscription : subscriptions_) {
+    if (subscription.is_active && subscription.id == subscription_id) {
+      return &subscription;
+    }
+  }
+  return nullptr;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+typename Master<TxRxStream, Logger, kWindowSize, Clock>::Transaction*
+Master<TxRxStream, Logger, kWindowSize, Clock>::StartRead(
+    std::span<const ReadRegion> regions, Command command) {
+  unsigned length = 0;
+  for (const auto& region : regions) {
+    length += region.data.size();
+  }
+  // A changes mirror may cover more than one message, only the changed blocks
+  // of it are transferred.
+  if (regions.empty() || regions.size() > kMaxBatchRegions ||
+      (length > kMaxDataLength && command != Command::kReadChanges)) {
+    return nullptr;
+  }
+
+  auto free_transaction = std::ranges::find_if(
+      transactions_,
+      [](const Transaction& transaction) { return !transaction.is_active; });
+  if (free_transaction == transactions_.end()) {
+    return nullptr;
+  }
+
+  free_transaction->is_active = true;
+  free_transaction->command = command;
+  free_transaction->id = AllocateId();
+  free_transaction->regions_count = static_cast<int>(regions.size());
+  std::ranges::copy(regions, free_transaction->regions.begin());
+  free_transaction->timeout = request_timeout_;
+  timers_.Start(free_transaction->timer, request_timeout_, OnRequestTimeout,
+                this);
+  pending_count_++;
+  return &*free_transaction;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::ReleaseTransaction(
+    Transaction& transaction) {
+  if (transaction.timer.IsExpired()) {
+    expired_count_--;
+  }
+  timers_.Stop(transaction.timer);
+  transaction.is_active = false;
+  pending_count_--;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::OnRequestTimeout(
+    void* context) {
+  static_cast<Master*>(context)->expired_count_++;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::TransmitUnsubscribe(
+    TransactionId subscription_id) {
+  MemoryAccessHeader header{.command = Command::kUnsubscribe,
+                            .transaction_id = subscription_id,
+                            .info = {.address = 0, .length = 0}};
+  write(stream_, &header, sizeof(header));
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+TransactionId Master<TxRxStream, Logger, kWindowSize, Clock>::AllocateId() {
+  while (IsPending(next_id_) || FindSubscription(next_id_) != nullptr ||
+         (is_transferring_ && next_id_ == transfer_id_)) {
+    next_id_++;
+  }
+  return next_id_++;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::TransmitRead(
+    const Transaction& transaction) {
+  auto regions =
+      std::span(transaction.regions).first(transaction.regions_count);
+  if (transaction.command == Command::kSubscribe) {
+    MemoryAccessMessageBuffer request{};
+    request.header = {
+        .command = Command::kSubscribe,
+        .transaction_id = transaction.id,
+        .info = {.address = 0, .length = sizeof(SubscriptionInfo)}};
+    std::memcpy(request.data, &transaction.subscription,
+                sizeof(SubscriptionInfo));
+    write(stream_, &request,
+          sizeof(MemoryAccessHeader) + sizeof(SubscriptionInfo));
+    return;
+  }
+  if (transaction.command == Command::kReadChanges) {
+    MemoryAccessMessageBuffer request{};
+    request.header = {
+        .command = Command::kReadChanges,
+        .transaction_id = transaction.id,
+        .info = {.address = 0, .length = sizeof(ChangesRequest)}};
+    ChangesRequest changes{
+        .since_version = changes_version_,
+        .is_synced = static_cast<uint8_t>(is_changes_synced_ ? 1 : 0)};
+    std::memcpy(request.data, &changes, sizeof(changes));
+    write(stream_, &request,
+          sizeof(MemoryAccessHeader) + sizeof(ChangesRequest));
+    return;
+  }
+  if (transaction.command == Command::kOpenTransfer) {
+    MemoryAccessMessageBuffer request{};
+    request.header = {
+        .command = Command::kOpenTransfer,
+        .transaction_id = transaction.id,
+        .info = {.address = 0, .length = sizeof(TransferRequest)}};
+    std::memcpy(request.data, &transaction.transfer, sizeof(TransferRequest));
+    write(stream_, &request,
+          sizeof(MemoryAccessHeader) + sizeof(TransferRequest));
+    return;
+  }
+  if (transaction.command == Command::kRead) {
+    MemoryAccessHeader header{
+        .command = Command::kRead,
+        .transaction_id = transaction.id,
+        .info = {.address = static_cast<uint8_t>(regions[0].address),
+                 .length = static_cast<uint8_t>(regions[0].data.size())}};
+    write(stream_, &header, sizeof(header));
+    return;
+  }
+
+  MemoryAccessMessageBuffer request{};
+  request.header = {
+      .command = Command::kReadBatch,
+      .transaction_id = transaction.id,
+      .info = {.address = 0,
+               .length = static_cast<uint8_t>(regions.size() *
+                                              sizeof(MemoryAccessInfo))}};
+  for (std::size_t i = 0; i < regions.size(); i++) {
+    MemoryAccessInfo info{
+        .address = static_cast<uint8_t>(regions[i].address),
+        .length = static_cast<uint8_t>(regions[i].data.size())};
+    std::memcpy(request.data + i * sizeof(info), &info, sizeof(info));
+  }
+  write(stream_, &request,
+        sizeof(MemoryAccessHeader) + request.header.info.length);
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+unsigned Master<TxRxStream, Logger, kWindowSize, Clock>::GetResponseLength(
+    const Transaction& transaction) {
+  unsigned length = 0;
+  for (const auto& region :
+       std::span(transaction.regions).first(transaction.regions_count)) {
+    length += region.data.size();
+  }
+  return length;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::Scatter(
+    const Transaction& transaction, std::span<const std::byte> data) {
+  for (const auto& region :
+       std::span(transaction.regions).first(transaction.regions_count)) {
+    std::ranges::copy(data.first(region.data.size()), region.data.begin());
+    data = data.subspan(region.data.size());
   }
+}
 
-  switch (rx_buffer_.command) {
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::HandleMessage(
+    const MemoryAccessMessageBuffer& message) {
+  last_transaction_ = message.header.transaction_id;
+  auto* transaction = FindTransaction(message.header.transaction_id);
+
+  switch (message.header.command) {
     case Command::kResponse:
-      if (static_cast<int>(requested_data_.size() + sizeof(Command)) !=
-          read_length) {  // TODO: vscode
-                          // - https://app.weeek.net/ws/701833/task/1067
+      if (transaction == nullptr) {
+        LOG_WARNING(logger_, "Unexpected response {}",
+                    message.header.transaction_id);
+        return hydrolib::ReturnCode::ERROR;
+      }
+      if (transaction->command == Command::kReadChanges) {
+        auto result = ApplyChanges(
+            *transaction, std::span<const std::byte>(
+                              static_cast<const std::byte*>(message.data),
+                              message.header.info.length));
+        ReleaseTransaction(*transaction);
+        return result;
+      }
+      // TODO: vscode - https://app.weeek.net/ws/701833/task/1067
+      if (GetResponseLength(*transaction) != message.header.info.length) {
         return hydrolib::ReturnCode::ERROR;
       }
-      std::ranges::copy(
-          std::span<std::byte>(static_cast<std::byte*>(rx_buffer_.data),
-                               requested_data_.size()),
-          requested_data_.begin());
-      requested_data_ = {};
+      Scatter(*transaction, std::span<const std::byte>(
+                                static_cast<const std::byte*>(message.data),
+                                message.header.info.length));
+      if (transaction->command == Command::kSubscribe) {
+        FindSubscription(transaction->id)->updates_count++;
+      }
+      ReleaseTransaction(*transaction);
+      if (transaction->command == Command::kOpenTransfer) {
+        StartTransfer();
+      }
       return hydrolib::ReturnCode::OK;
     case Command::kError:  // TODO: vscode - make different reaction for
                            // different errors
+      LOG_WARNING(logger_, "Request {} failed", message.header.transaction_id);
+      if (transaction != nullptr) {
+        if (transaction->command == Command::kSubscribe) {
+          FindSubscription(transaction->id)->is_active = false;
+          subscriptions_count_--;
+        }
+        if (transaction->command == Command::kOpenTransfer) {
+          transfer_status_ = hydrolib::ReturnCode::ERROR;
+        }
+        ReleaseTransaction(*transaction);
+      } else if (is_transferring_ &&
+                 message.header.transaction_id == transfer_id_) {
+        FinishTransfer(hydrolib::ReturnCode::ERROR);
+      }
+      return hydrolib::ReturnCode::ERROR;
+    case Command::kPublish:
+      return HandlePublish(message);
+    case Command::kTransferData:
+      return HandleChunk(message);
+    case Command::kTransferAck:
+      return HandleTransferAck(message);
     case Command::kRead:
     case Command::kWrite:
+    case Command::kReadBatch:
+    case Command::kWriteBatch:
+    case Command::kSubscribe:
+    case Command::kUnsubscribe:
+    case Command::kReadChanges:
+    case Command::kOpenTransfer:
+    case Command::kCloseTransfer:
     default:
       LOG_WARNING(logger_, "Wrong command");
       return hydrolib::ReturnCode::ERROR;
   }
 }
 
-template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger>
-void Master<TxRxStream, Logger>::RequestRead(const std::span<std::byte>& data,
-                                             int address) {
-  requested_data_ = data;
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::HandlePublish(
+    const MemoryAccessMessageBuffer& message) {
+  auto* subscription = FindSubscription(message.header.transaction_id);
+  if (subscription == nullptr) {
+    LOG_WARNING(logger_, "Unknown subscription {}",
+                message.header.transaction_id);
+    TransmitUnsubscribe(message.header.transaction_id);
+    return hydrolib::ReturnCode::ERROR;
+  }
+  if (subscription->data.size() != message.header.info.length) {
+    LOG_WARNING(logger_, "Wrong length of subscription {}",
+                message.header.transaction_id);
+    return hydrolib::ReturnCode::ERROR;
+  }
+  std::ranges::copy(std::span<const std::byte>(
+                        static_cast<const std::byte*>(message.data),
+                        message.header.info.length),
+                    subscription->data.begin());
+  subscription->updates_count++;
+  return hydrolib::ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::ApplyChanges(
+    const Transaction& transaction, std::span<const std::byte> payload) {
+  auto mirror = transaction.regions[0].data;
+  ChangesHeader header{};
+  if (payload.size() < sizeof(header)) {
+    LOG_WARNING(logger_, "Truncated changes header");
+    is_changes_synced_ = false;
+    return hydrolib::ReturnCode::ERROR;
+  }
+  std::memcpy(&header, payload.data(), sizeof(header));
+  payload = payload.subspan(sizeof(header));
+
+  while (!payload.empty()) {
+    MemoryAccessInfo info{};
+    if (payload.size() < sizeof(info)) {
+      LOG_WARNING(logger_, "Truncated changes descriptor");
+      is_changes_synced_ = false;
+      return hydrolib::ReturnCode::ERROR;
+    }
+    std::memcpy(&info, payload.data(), sizeof(info));
+    payload = payload.subspan(sizeof(info));
+    if (payload.size() < info.length ||
+        info.address + info.length > mirror.size()) {
+      LOG_WARNING(logger_, "Changes of {} bytes at {} don't fit", info.length,
+                  info.address);
+      is_changes_synced_ = false;
+      return hydrolib::ReturnCode::ERROR;
+    }
+    std::ranges::copy(payload.first(info.length),
+                      mirror.subspan(info.address).begin());
+    payload = payload.subspan(info.length);
+  }
+
+  changes_version_ = header.version;
+  is_changes_synced_ = true;
+  has_more_changes_ = header.has_more != 0;
+  return hydrolib::ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+Expected<TransactionId>
+Master<TxRxStream, Logger, kWindowSize, Clock>::OpenTransfer(
+    TransferRequest request) {
+  if (is_transferring_) {
+    FinishTransfer(hydrolib::ReturnCode::FAIL);
+  }
+  ReadRegion region{.address = 0, .data = transfer_info_};
+  auto* transaction = StartRead(std::span(&region, 1), Command::kOpenTransfer);
+  if (transaction == nullptr) {
+    return hydrolib::ReturnCode::OVERFLOW;
+  }
+  transaction->transfer = request;
+  transfer_ = request;
+  transfer_status_ = hydrolib::ReturnCode::NO_DATA;
+  TransmitRead(*transaction);
+  return transaction->id;
+}
 
-  tx_buffer_.header.command = Command::kRead;
-  tx_buffer_.header.info.address = address;
-  tx_buffer_.header.info.length = data.size();
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::StartTransfer() {
+  TransferInfo info{};
+  std::memcpy(&info, transfer_info_.data(), sizeof(info));
+  auto capacity = transfer_.direction == TransferDirection::kDownload
+                      ? download_data_.size()
+                      : upload_data_.size();
+  if (info.size < transfer_.offset || info.size > capacity) {
+    LOG_WARNING(logger_, "Blob of {} bytes doesn't fit", info.size);
+    transfer_status_ = hydrolib::ReturnCode::OVERFLOW;
+    return;
+  }
 
-  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader));
-  last_request_time_ = std::chrono::steady_clock::now();
+  transfer_id_ = last_transaction_;
+  transfer_size_ = info.size;
+  auto chunks_count = GetChunksCount(info.size - transfer_.offset);
+  if (transfer_.direction == TransferDirection::kDownload) {
+    transfer_receiver_.Start(chunks_count);
+  } else {
+    transfer_sender_.Start(chunks_count);
+  }
+  is_transferring_ = true;
+  transfer_retries_ = 0;
+  transfer_timeout_ = request_timeout_;
+  timers_.Start(transfer_timer_, transfer_timeout_);
+  LOG_INFO(logger_, "Transfer {} of {} bytes from {}", transfer_id_, info.size,
+           transfer_.offset);
+  if (chunks_count == 0) {
+    FinishTransfer(hydrolib::ReturnCode::OK);
+  }
 }
 
-template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger>
-void Master<TxRxStream, Logger>::RequestWrite(std::span<const std::byte> data,
-                                              int address) {
-  tx_buffer_.header.command = Command::kWrite;
-  tx_buffer_.header.info.address = address;
-  tx_buffer_.header.info.length = data.size();
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::ProcessTransfer() {
+  if (transfer_timer_.IsExpired()) {
+    transfer_retries_++;
+    if (transfer_retries_ > kMaxTransferRetries) {
+      LOG_ERROR(logger_, "Transfer {} failed", transfer_id_);
+      FinishTransfer(hydrolib::ReturnCode::TIMEOUT);
+      return hydrolib::ReturnCode::TIMEOUT;
+    }
+    LOG_WARNING(logger_, "Transfer {} stalled", transfer_id_);
+    timers_.Start(transfer_timer_, transfer_timeout_);
+    if (transfer_.direction == TransferDirection::kDownload) {
+      TransmitTransferAck();
+    } else {
+      transfer_sender_.RetransmitAll();
+    }
+  }
 
-  std::ranges::copy(data.begin(), data.end(),
-                    static_cast<std::byte*>(tx_buffer_.data));
+  if (transfer_.direction == TransferDirection::kUpload) {
+    uint32_t index = 0;
+    while (transfer_sender_.GetNextChunk(index)) {
+      TransmitChunk(index);
+    }
+  }
+  return hydrolib::ReturnCode::OK;
+}
 
-  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader) + data.size());
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::HandleChunk(
+    const MemoryAccessMessageBuffer& message) {
+  if (!is_transferring_ || message.header.transaction_id != transfer_id_ ||
+      transfer_.direction != TransferDirection::kDownload ||
+      message.header.info.length < sizeof(ChunkHeader)) {
+    LOG_WARNING(logger_, "Unexpected chunk of transfer {}",
+                message.header.transaction_id);
+    return hydrolib::ReturnCode::ERROR;
+  }
+  ChunkHeader chunk{};
+  std::memcpy(&chunk, message.data, sizeof(chunk));
+  auto length = message.header.info.length - sizeof(ChunkHeader);
+  if (chunk.index >= GetChunksCount(transfer_size_ - transfer_.offset) ||
+      length != GetChunkLength(chunk.index)) {
+    LOG_WARNING(logger_, "Wrong chunk {}", chunk.index);
+    return hydrolib::ReturnCode::ERROR;
+  }
+
+  if (transfer_receiver_.Accept(chunk.index)) {
+    std::memcpy(download_data_.data() + transfer_.offset +
+                    chunk.index * kChunkSize,
+                message.data + sizeof(ChunkHeader), length);
+    timers_.Start(transfer_timer_, transfer_timeout_);
+    transfer_retries_ = 0;
+  }
+  if (transfer_receiver_.IsAckDue()) {
+    TransmitTransferAck();
+  }
+  if (transfer_receiver_.IsDone()) {
+    FinishTransfer(hydrolib::ReturnCode::OK);
+  }
+  return hydrolib::ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+Master<TxRxStream, Logger, kWindowSize, Clock>::HandleTransferAck(
+    const MemoryAccessMessageBuffer& message) {
+  if (!is_transferring_ || message.header.transaction_id != transfer_id_ ||
+      transfer_.direction != TransferDirection::kUpload ||
+      message.header.info.length != sizeof(TransferAck)) {
+    LOG_WARNING(logger_, "Unexpected ack of transfer {}",
+                message.header.transaction_id);
+    return hydrolib::ReturnCode::ERROR;
+  }
+  TransferAck ack{};
+  std::memcpy(&ack, message.data, sizeof(ack));
+  if (transfer_sender_.HandleAck(ack)) {
+    timers_.Start(transfer_timer_, transfer_timeout_);
+    transfer_retries_ = 0;
+  }
+  if (transfer_sender_.IsDone()) {
+    FinishTransfer(hydrolib::ReturnCode::OK);
+  }
+  return hydrolib::ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void
+Master<TxRxStream, Logger, kWindowSize, Clock>::TransmitChunk(uint32_t index) {
+  auto length = GetChunkLength(index);
+  ChunkHeader chunk{.index = index};
+  tx_buffer_.header = {
+      .command = Command::kTransferData,
+      .transaction_id = transfer_id_,
+      .info = {.address = 0,
+               .length = static_cast<uint8_t>(sizeof(chunk) + length)}};
+  std::memcpy(tx_buffer_.data, &chunk, sizeof(chunk));
+  std::memcpy(tx_buffer_.data + sizeof(chunk),
+              upload_data_.data() + transfer_.offset + index * kChunkSize,
+              length);
+  write(stream_, &tx_buffer_,
+        sizeof(MemoryAccessHeader) + sizeof(chunk) + length);
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::TransmitTransferAck() {
+  auto ack = transfer_receiver_.MakeAck();
+  tx_buffer_.header = {
+      .command = Command::kTransferAck,
+      .transaction_id = transfer_id_,
+      .info = {.address = 0, .length = sizeof(TransferAck)}};
+  std::memcpy(tx_buffer_.data, &ack, sizeof(ack));
+  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader) + sizeof(ack));
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+void Master<TxRxStream, Logger, kWindowSize, Clock>::FinishTransfer(
+    hydrolib::ReturnCode result) {
+  if (result == hydrolib::ReturnCode::OK) {
+    LOG_INFO(logger_, "Transfer {} done", transfer_id_);
+  } else {
+    transfer_.offset = GetTransferredBytes();
+  }
+  is_transferring_ = false;
+  timers_.Stop(transfer_timer_);
+  transfer_status_ = result;
+  MemoryAccessHeader header{.command = Command::kCloseTransfer,
+                            .transaction_id = transfer_id_,
+                            .info = {.address = 0, .length = 0}};
+  write(stream_, &header, sizeof(header));
+}
+
+template <concepts::stream::ByteFullStreamConcept TxRxStream, typename Logger,
+          int kWindowSize, concepts::clock::ClockConcept Clock>
+uint32_t Master<TxRxStream, Logger, kWindowSize, Clock>::GetChunkLength(
+    uint32_t index) const {
+  return std::min(kChunkSize,
+                  transfer_size_ - transfer_.offset - index * kChunkSize);
 }
 
 }  // namespace hydrolib::bus::application
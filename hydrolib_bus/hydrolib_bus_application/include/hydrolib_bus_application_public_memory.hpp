@@ -0,0 +1,165 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <climits>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::bus::application {
+// Memory that remembers which blocks were written since the last delta sync.
+// The slave answers Command::kReadChanges from it, so only modified blocks
+// travel over the bus.
+template <typename T>
+concept DirtyTrackingMemoryConcept =
+    requires(T mem, const T const_mem, int block) {
+      { T::kBlockSize } -> std::convertible_to<int>;
+      { const_mem.GetSize() } -> std::same_as<int>;
+      { const_mem.GetBlocksCount() } -> std::same_as<int>;
+      { const_mem.GetVersion() } -> std::same_as<MemoryVersion>;
+      { const_mem.FindDirtyBlock(block) } -> std::same_as<int>;
+      { mem.ClearDirty(block) };
+      { mem.MarkAllDirty() };
+      { mem.NextVersion() };
+    };
+
+// Byte array of kSize bytes split into blocks of kBlockSize bytes. Every write
+// sets the dirty bits of the blocks it touches; the bits are kept in a bitmap
+// of one bit per block.
+template <int kSize, int kBlockSize_>
+class PublicMemory final {
+ public:
+  static constexpr int kBlockSize = kBlockSize_;
+
+  constexpr PublicMemory() = default;
+  PublicMemory(const PublicMemory&) = delete;
+  PublicMemory(PublicMemory&&) = delete;
+  PublicMemory& operator=(const PublicMemory&) = delete;
+  PublicMemory& operator=(PublicMemory&&) = delete;
+  ~PublicMemory() = default;
+
+  ReturnCode Read(std::span<std::byte> read_buffer, unsigned address) const;
+  ReturnCode Write(std::span<const std::byte> write_buffer, unsigned address);
+
+  [[nodiscard]] std::span<const std::byte, kSize> GetData() const;
+
+  [[nodiscard]] int GetSize() const;
+  [[nodiscard]] int GetBlocksCount() const;
+  [[nodiscard]] MemoryVersion GetVersion() const;
+  // Returns the first dirty block starting from `block`, or GetBlocksCount().
+  [[nodiscard]] int FindDirtyBlock(int block) const;
+  void ClearDirty(int block);
+  void MarkAllDirty();
+  void NextVersion();
+
+ private:
+  using Word = uint32_t;
+
+  static constexpr int kBlocksCount = (kSize + kBlockSize - 1) / kBlockSize;
+  static constexpr int kWordBits = sizeof(Word) * CHAR_BIT;
+  static constexpr int kWordsCount = (kBlocksCount + kWordBits - 1) / kWordBits;
+
+  static_assert(kSize > 0 && kSize <= UINT8_MAX + 1,
+                "Memory must be addressable by MemoryAccessInfo");
+  static_assert(kBlockSize > 0 &&
+                    kBlockSize <= kMaxDataLength - sizeof(ChangesHeader) -
+                                      sizeof(MemoryAccessInfo),
+                "Block must fit into one kReadChanges response");
+
+  void MarkDirty(int first_block, int last_block);
+
+  std::array<std::byte, kSize> data_{};
+  std::array<Word, kWordsCount> dirty_{};
+  MemoryVersion version_ = 0;
+};
+
+template <int kSize, int kBlockSize_>
+ReturnCode PublicMemory<kSize, kBlockSize_>::Read(
+    std::span<std::byte> read_buffer, unsigned address) const {
+  if (address + read_buffer.size() > kSize) {
+    return ReturnCode::FAIL;
+  }
+  std::memcpy(read_buffer.data(), data_.data() + address, read_buffer.size());
+  return ReturnCode::OK;
+}
+
+template <int kSize, int kBlockSize_>
+ReturnCode PublicMemory<kSize, kBlockSize_>::Write(
+    std::span<const std::byte> write_buffer, unsigned address) {
+  if (address + write_buffer.size() > kSize) {
+    return ReturnCode::FAIL;
+  }
+  if (write_buffer.empty()) {
+    return ReturnCode::OK;
+  }
+  std::memcpy(data_.data() + address, write_buffer.data(),
+              write_buffer.size());
+  MarkDirty(static_cast<int>(address / kBlockSize),
+            static_cast<int>((address + write_buffer.size() - 1) / kBlockSize));
+  return ReturnCode::OK;
+}
+
+template <int kSize, int kBlockSize_>
+std::span<const std::byte, kSize> PublicMemory<kSize, kBlockSize_>::GetData()
+    const {
+  return data_;
+}
+
+template <int kSize, int kBlockSize_>
+int PublicMemory<kSize, kBlockSize_>::GetSize() const {
+  return kSize;
+}
+
+template <int kSize, int kBlockSize_>
+int PublicMemory<kSize, kBlockSize_>::GetBlocksCount() const {
+  return kBlocksCount;
+}
+
+template <int kSize, int kBlockSize_>
+MemoryVersion PublicMemory<kSize, kBlockSize_>::GetVersion() const {
+  return version_;
+}
+
+template <int kSize, int kBlockSize_>
+int PublicMemory<kSize, kBlockSize_>::FindDirtyBlock(int block) const {
+  while (block < kBlocksCount) {
+    Word word = dirty_[block / kWordBits] >> (block % kWordBits);
+    if (word != 0) {
+      block += std::countr_zero(word);
+      return block < kBlocksCount ? block : kBlocksCount;
+    }
+    block = (block / kWordBits + 1) * kWordBits;
+  }
+  return kBlocksCount;
+}
+
+template <int kSize, int kBlockSize_>
+void PublicMemory<kSize, kBlockSize_>::ClearDirty(int block) {
+  dirty_[block / kWordBits] &= ~(Word{1} << (block % kWordBits));
+}
+
+template <int kSize, int kBlockSize_>
+void PublicMemory<kSize, kBlockSize_>::MarkAllDirty() {
+  MarkDirty(0, kBlocksCount - 1);
+}
+
+template <int kSize, int kBlockSize_>
+void PublicMemory<kSize, kBlockSize_>::NextVersion() {
+  version_++;
+}
+
+template <int kSize, int kBlockSize_>
+void PublicMemory<kSize, kBlockSize_>::MarkDirty(int first_block,
+                                                 int last_block) {
+  for (int block = first_block; block <= last_block; block++) {
+    dirty_[block / kWordBits] |= Word{1} << (block % kWordBits);
+  }
+}
+
+}  // namespace hydrolib::bus::application
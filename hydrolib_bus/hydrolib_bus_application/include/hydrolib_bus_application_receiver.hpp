@@ -0,0 +1,70 @@
+#pragma once
+
+#include <cstddef>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::bus::application {
+// Assembles one message at a time from the stream: the header first, then
+// exactly the payload it announces. Messages queued back to back are never
+// read past, and partial reads are resumed on the next call.
+template <concepts::stream::ByteFullStreamConcept RxStream>
+class MessageReceiver final {
+ public:
+  constexpr explicit MessageReceiver(RxStream& stream);
+  MessageReceiver(const MessageReceiver&) = delete;
+  MessageReceiver(MessageReceiver&&) = delete;
+  MessageReceiver& operator=(const MessageReceiver&) = delete;
+  MessageReceiver& operator=(MessageReceiver&&) = delete;
+  ~MessageReceiver() = default;
+
+  ReturnCode Process();
+  [[nodiscard]] const MemoryAccessMessageBuffer& GetMessage() const;
+
+ private:
+  bool ReadUpTo(unsigned length);
+
+  RxStream& stream_;
+
+  MemoryAccessMessageBuffer buffer_{};
+  unsigned length_ = 0;
+};
+
+template <concepts::stream::ByteFullStreamConcept RxStream>
+constexpr MessageReceiver<RxStream>::MessageReceiver(RxStream& stream)
+    : stream_(stream) {}
+
+template <concepts::stream::ByteFullStreamConcept RxStream>
+ReturnCode MessageReceiver<RxStream>::Process() {
+  if (!ReadUpTo(sizeof(MemoryAccessHeader))) {
+    return ReturnCode::NO_DATA;
+  }
+  if (!ReadUpTo(sizeof(MemoryAccessHeader) +
+                GetPayloadLength(buffer_.header))) {
+    return ReturnCode::NO_DATA;
+  }
+  length_ = 0;
+  return ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxStream>
+const MemoryAccessMessageBuffer& MessageReceiver<RxStream>::GetMessage() const {
+  return buffer_;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxStream>
+bool MessageReceiver<RxStream>::ReadUpTo(unsigned length) {
+  if (length_ < length) {
+    int read_length = read(stream_, reinterpret_cast<std::byte*>(&buffer_) +
+                                        length_,
+                           length - length_);
+    if (read_length > 0) {
+      length_ += read_length;
+    }
+  }
+  return length_ >= length;
+}
+
+}  // namespace hydrolib::bus::application
@@ -0,0 +1,387 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_clock_concepts.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::bus::application {
+// Caching front-end for a Master. Reads younger than the caller's max age are
+// served locally; misses are queued and overlapping or adjacent ones go out as
+// one bus read on the next Process(). Writes are merged with neighbouring
+// writes until the flush window expires. The slave doesn't acknowledge writes,
+// so a written range stays invalid until it is read back: a read of a range
+// with a pending write flushes the write first, so the fill sees its result,
+// or the old value if the slave refused it.
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills = 4, int kMaxPendingWrites = kMaxBatchRegions>
+class RegisterCache final {
+ public:
+  struct Stats {
+    int64_t hits = 0;
+    int64_t misses = 0;
+    int64_t coalesced_reads = 0;
+    int64_t merged_writes = 0;
+    int64_t bus_reads = 0;
+    int64_t bus_writes = 0;
+
+    [[nodiscard]] double GetHitRate() const;
+  };
+
+  RegisterCache(MasterType& master, typename Clock::duration flush_window);
+  RegisterCache(const RegisterCache&) = delete;
+  RegisterCache(RegisterCache&&) = delete;
+  RegisterCache& operator=(const RegisterCache&) = delete;
+  RegisterCache& operator=(RegisterCache&&) = delete;
+  ~RegisterCache() = default;
+
+  // Returns NO_DATA on a miss; the value arrives with a later Process().
+  ReturnCode Read(std::span<std::byte> data, int address,
+                  typename Clock::duration max_age);
+  ReturnCode Write(std::span<const std::byte> data, int address);
+  ReturnCode Flush();
+  ReturnCode Process();
+
+  [[nodiscard]] const Stats& GetStats() const;
+
+ private:
+  static constexpr int kMemorySize = UINT8_MAX + 1;
+
+  static_assert(kMaxPendingWrites <= kMaxBatchRegions,
+                "Pending writes must fit into one batch");
+
+  struct Range {
+    int address = 0;
+    int length = 0;
+
+    [[nodiscard]] int GetEnd() const;
+    [[nodiscard]] bool Overlaps(const Range& other) const;
+    [[nodiscard]] bool Touches(const Range& other) const;
+    [[nodiscard]] Range Merge(const Range& other) const;
+  };
+
+  struct Fill {
+    bool is_active = false;
+    bool is_sent = false;
+    bool is_stale = false;
+    TransactionId id = 0;
+    Range range;
+    std::array<std::byte, kMaxDataLength> buffer{};
+  };
+
+  [[nodiscard]] bool IsFresh(const Range& range,
+                             typename Clock::duration max_age) const;
+  [[nodiscard]] bool IsCovered(const Range& range) const;
+  [[nodiscard]] bool HasFillAfterWrite() const;
+  ReturnCode QueueFill(const Range& range);
+  void SendFills();
+  void CompleteFills(bool is_successful);
+
+  MasterType& master_;
+  const typename Clock::duration flush_window_;
+
+  std::array<std::byte, kMemorySize> values_{};
+  std::array<typename Clock::time_point, kMemorySize> update_times_{};
+  std::array<bool, kMemorySize> is_valid_{};
+
+  std::array<Fill, kMaxFills> fills_{};
+
+  std::array<Range, kMaxPendingWrites> pending_writes_{};
+  int pending_writes_count_ = 0;
+  typename Clock::time_point first_write_time_{};
+
+  Stats stats_;
+};
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+double RegisterCache<MasterType, Clock, kMaxFills,
+                     kMaxPendingWrites>::Stats::GetHitRate() const {
+  if (hits + misses == 0) {
+    return 0;
+  }
+  return static_cast<double>(hits) / static_cast<double>(hits + misses);
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+int RegisterCache<MasterType, Clock, kMaxFills,
+                  kMaxPendingWrites>::Range::GetEnd() const {
+  return address + length;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+bool RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::Range::
+    Overlaps(const Range& other) const {
+  return address < other.GetEnd() && other.address < GetEnd();
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+bool RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::Range::
+    Touches(const Range& other) const {
+  return address <= other.GetEnd() && other.address <= GetEnd();
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+typename RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::Range
+RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::Range::Merge(
+    const Range& other) const {
+  int merged_address = std::min(address, other.address);
+  return {.address = merged_address,
+          .length = std::max(GetEnd(), other.GetEnd()) - merged_address};
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::RegisterCache(
+    MasterType& master, typename Clock::duration flush_window)
+    : master_(master), flush_window_(flush_window) {}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+ReturnCode RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::Read(
+    std::span<std::byte> data, int address, typename Clock::duration max_age) {
+  Range range{.address = address, .length = static_cast<int>(data.size())};
+  if (address < 0 || data.empty() || data.size() > kMaxDataLength ||
+      range.GetEnd() > kMemorySize) {
+    return ReturnCode::FAIL;
+  }
+
+  if (IsFresh(range, max_age)) {
+    std::ranges::copy(std::span(values_).subspan(address, data.size()),
+                      data.begin());
+    stats_.hits++;
+    return ReturnCode::OK;
+  }
+
+  stats_.misses++;
+  if (IsCovered(range)) {
+    stats_.coalesced_reads++;
+    return ReturnCode::NO_DATA;
+  }
+  auto result = QueueFill(range);
+  return result == ReturnCode::OK ? ReturnCode::NO_DATA : result;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+ReturnCode
+RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::Write(
+    std::span<const std::byte> data, int address) {
+  Range range{.address = address, .length = static_cast<int>(data.size())};
+  if (address < 0 || data.empty() || data.size() > kMaxDataLength ||
+      range.GetEnd() > kMemorySize) {
+    return ReturnCode::FAIL;
+  }
+
+  std::ranges::copy(data, values_.begin() + address);
+  std::fill_n(is_valid_.begin() + address, data.size(), false);
+  // A read already on the bus would bring back the value from before this
+  // write.
+  for (auto& fill : fills_) {
+    if (fill.is_active && fill.is_sent && fill.range.Overlaps(range)) {
+      fill.is_stale = true;
+    }
+  }
+
+  for (auto& pending :
+       std::span(pending_writes_).first(pending_writes_count_)) {
+    if (pending.Touches(range) &&
+        pending.Merge(range).length <= static_cast<int>(kMaxDataLength)) {
+      pending = pending.Merge(range);
+      stats_.merged_writes++;
+      return ReturnCode::OK;
+    }
+  }
+
+  if (pending_writes_count_ == kMaxPendingWrites) {
+    Flush();
+  }
+  if (pending_writes_count_ == 0) {
+    first_write_time_ = Clock::now();
+  }
+  pending_writes_[pending_writes_count_++] = range;
+  return ReturnCode::OK;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+ReturnCode
+RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::Flush() {
+  if (pending_writes_count_ == 0) {
+    return ReturnCode::OK;
+  }
+
+  std::array<WriteRegion, kMaxPendingWrites> regions{};
+  for (int i = 0; i < pending_writes_count_; i++) {
+    regions[i] = {.address = pending_writes_[i].address,
+                  .data = std::span(values_).subspan(
+                      pending_writes_[i].address, pending_writes_[i].length)};
+  }
+  auto batch = std::span(regions).first(pending_writes_count_);
+  pending_writes_count_ = 0;
+
+  if (batch.size() > 1 && master_.RequestWrite(batch) == ReturnCode::OK) {
+    stats_.bus_writes++;
+    return ReturnCode::OK;
+  }
+  for (const auto& region : batch) {
+    master_.RequestWrite(region.data, region.address);
+    stats_.bus_writes++;
+  }
+  return ReturnCode::OK;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+ReturnCode
+RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::Process() {
+  while (true) {
+    auto result = master_.Process();
+    if (result == ReturnCode::OK || result == ReturnCode::ERROR) {
+      CompleteFills(result == ReturnCode::OK);
+    } else if (result != ReturnCode::TIMEOUT) {
+      break;
+    }
+  }
+
+  if (pending_writes_count_ != 0 &&
+      (Clock::now() - first_write_time_ >= flush_window_ ||
+       HasFillAfterWrite())) {
+    Flush();
+  }
+  SendFills();
+  return ReturnCode::OK;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+const typename RegisterCache<MasterType, Clock, kMaxFills,
+                             kMaxPendingWrites>::Stats&
+RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::GetStats()
+    const {
+  return stats_;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+bool RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::IsFresh(
+    const Range& range, typename Clock::duration max_age) const {
+  auto now = Clock::now();
+  for (int address = range.address; address < range.GetEnd(); address++) {
+    if (!is_valid_[address] || now - update_times_[address] > max_age) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+bool RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::IsCovered(
+    const Range& range) const {
+  for (int address = range.address; address < range.GetEnd(); address++) {
+    bool is_covered = std::ranges::any_of(fills_, [address](const Fill& fill) {
+      return fill.is_active && !fill.is_stale &&
+             fill.range.address <= address && address < fill.range.GetEnd();
+    });
+    if (!is_covered) {
+      return false;
+    }
+  }
+  return true;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+bool RegisterCache<MasterType, Clock, kMaxFills,
+                   kMaxPendingWrites>::HasFillAfterWrite() const {
+  return std::ranges::any_of(fills_, [this](const Fill& fill) {
+    return fill.is_active && !fill.is_sent &&
+           std::ranges::any_of(
+               std::span(pending_writes_).first(pending_writes_count_),
+               [&fill](const Range& write) {
+                 return write.Overlaps(fill.range);
+               });
+  });
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+ReturnCode
+RegisterCache<MasterType, Clock, kMaxFills, kMaxPendingWrites>::QueueFill(
+    const Range& range) {
+  for (auto& fill : fills_) {
+    if (fill.is_active && !fill.is_sent && fill.range.Touches(range) &&
+        fill.range.Merge(range).length <= static_cast<int>(kMaxDataLength)) {
+      fill.range = fill.range.Merge(range);
+      stats_.coalesced_reads++;
+      return ReturnCode::OK;
+    }
+  }
+
+  auto free_fill = std::ranges::find_if(
+      fills_, [](const Fill& fill) { return !fill.is_active; });
+  if (free_fill == fills_.end()) {
+    return ReturnCode::OVERFLOW;
+  }
+  free_fill->is_active = true;
+  free_fill->is_sent = false;
+  free_fill->is_stale = false;
+  free_fill->range = range;
+  return ReturnCode::OK;
+}
+
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+void RegisterCache<MasterType, Clock, kMaxFills,
+                   kMaxPendingWrites>::SendFills() {
+  for (auto& fill : fills_) {
+    if (!fill.is_active || fill.is_sent) {
+      continue;
+    }
+    auto id = master_.RequestRead(
+        std::span(fill.buffer).first(fill.range.length), fill.range.address);
+    if (static_cast<ReturnCode>(id) != ReturnCode::OK) {
+      return;
+    }
+    fill.id = static_cast<TransactionId>(id);
+    fill.is_sent = true;
+    stats_.bus_reads++;
+  }
+}
+
+// Master::Process() finishes at most one transaction per call, so the fill
+// that stopped being pending is the one the returned status belongs to.
+template <typename MasterType, concepts::clock::ClockConcept Clock,
+          int kMaxFills, int kMaxPendingWrites>
+void RegisterCache<MasterType, Clock, kMaxFills,
+                   kMaxPendingWrites>::CompleteFills(bool is_successful) {
+  for (auto& fill : fills_) {
+    if (!fill.is_active || !fill.is_sent || master_.IsPending(fill.id)) {
+      continue;
+    }
+    fill.is_active = false;
+    if (!is_successful || fill.is_stale) {
+      continue;
+    }
+    auto now = Clock::now();
+    std::ranges::copy(std::span(fill.buffer).first(fill.range.length),
+                      values_.begin() + fill.range.address);
+    std::fill_n(update_times_.begin() + fill.range.address, fill.range.length,
+                now);
+    std::fill_n(is_valid_.begin() + fill.range.address, fill.range.length,
+                true);
+  }
+}
+
+}  // namespace hydrolib::bus::application
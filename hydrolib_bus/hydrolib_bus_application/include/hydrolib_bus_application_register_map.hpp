@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <type_traits>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::bus::application {
+enum class Access : uint8_t { kReadOnly, kWriteOnly, kReadWrite };
+
+// Describes one register of a slave. A register is named by deriving a type
+// from it:
+//
+//   struct Speed : Register<int16_t, 0, Access::kReadWrite> {};
+template <typename T, int kAddress_, Access kAccess_ = Access::kReadWrite>
+struct Register {
+  static_assert(std::is_trivially_copyable_v<T>,
+                "Register value must be sent as raw bytes");
+  static_assert(kAddress_ >= 0, "Register address must not be negative");
+
+  using ValueType = T;
+
+  static constexpr int kAddress = kAddress_;
+  static constexpr int kSize = sizeof(T);
+  static constexpr Access kAccess = kAccess_;
+};
+
+template <typename T>
+concept RegisterConcept = requires {
+  typename T::ValueType;
+  { T::kAddress } -> std::convertible_to<int>;
+  { T::kSize } -> std::convertible_to<int>;
+  { T::kAccess } -> std::convertible_to<Access>;
+};
+
+// Compile-time layout of a slave's registers. For every address it precomputes
+// how far readable and writable bytes continue from it, so an access of any
+// length is checked with one table lookup.
+template <RegisterConcept... Registers>
+class RegisterMap final {
+ public:
+  static constexpr int kRegistersCount = sizeof...(Registers);
+  static constexpr int kSize =
+      std::max({0, (Registers::kAddress + Registers::kSize)...});
+
+  static constexpr bool HasOverlaps();
+  static constexpr bool IsLayoutValid();
+
+  template <RegisterConcept Reg>
+  static constexpr bool Contains();
+
+  static constexpr bool IsReadable(unsigned address, unsigned length);
+  static constexpr bool IsWritable(unsigned address, unsigned length);
+
+ private:
+  using EndTable = std::array<uint16_t, kSize + 1>;
+
+  static constexpr bool IsReadAllowed(Access access);
+  static constexpr bool IsWriteAllowed(Access access);
+  template <bool (*kIsAllowed)(Access)>
+  static constexpr EndTable MakeEndTable();
+
+  static const EndTable kReadableEnd;
+  static const EndTable kWritableEnd;
+};
+
+// Slave-side memory generated from a register map. The bus may only touch
+// bytes of registers with matching access rights; the firmware itself reads
+// and writes any register through Get and Set.
+template <typename Map>
+class RegisterMemory final {
+ public:
+  static_assert(Map::IsLayoutValid(),
+                "Registers overlap or don't fit into the address space");
+
+  constexpr RegisterMemory() = default;
+  RegisterMemory(const RegisterMemory&) = delete;
+  RegisterMemory(RegisterMemory&&) = delete;
+  RegisterMemory& operator=(const RegisterMemory&) = delete;
+  RegisterMemory& operator=(RegisterMemory&&) = delete;
+  ~RegisterMemory() = default;
+
+  ReturnCode Read(std::span<std::byte> read_buffer, unsigned address) const;
+  ReturnCode Write(std::span<const std::byte> write_buffer, unsigned address);
+
+  template <RegisterConcept Reg>
+  [[nodiscard]] typename Reg::ValueType Get() const;
+  template <RegisterConcept Reg>
+  void Set(const typename Reg::ValueType& value);
+
+ private:
+  std::array<std::byte, Map::kSize> data_{};
+};
+
+// Master-side typed accessors for the registers of one slave.
+template <typename Map, typename MasterType>
+class RegisterClient final {
+ public:
+  static_assert(Map::IsLayoutValid(),
+                "Registers overlap or don't fit into the address space");
+
+  explicit RegisterClient(MasterType& master);
+  RegisterClient(const RegisterClient&) = delete;
+  RegisterClient(RegisterClient&&) = delete;
+  RegisterClient& operator=(const RegisterClient&) = delete;
+  RegisterClient& operator=(RegisterClient&&) = delete;
+  ~RegisterClient() = default;
+
+  // The value is filled in once the master receives the response.
+  template <RegisterConcept Reg>
+  Expected<TransactionId> RequestRead(typename Reg::ValueType& value);
+  template <RegisterConcept Reg>
+  void RequestWrite(const typename Reg::ValueType& value);
+
+ private:
+  MasterType& master_;
+};
+
+template <RegisterConcept... Registers>
+constexpr bool RegisterMap<Registers...>::HasOverlaps() {
+  constexpr std::array<int, kRegistersCount> kAddresses{Registers::kAddress...};
+  constexpr std::array<int, kRegistersCount> kSizes{Registers::kSize...};
+  for (int i = 0; i < kRegistersCount; i++) {
+    for (int j = i + 1; j < kRegistersCount; j++) {
+      if (kAddresses[i] < kAddresses[j] + kSizes[j] &&
+          kAddresses[j] < kAddresses[i] + kSizes[i]) {
+        return true;
+      }
+    }
+  }
+  return false;
+}
+
+template <RegisterConcept... Registers>
+constexpr bool RegisterMap<Registers...>::IsLayoutValid() {
+  return !HasOverlaps() && kSize <= UINT8_MAX + 1;
+}
+
+template <RegisterConcept... Registers>
+template <RegisterConcept Reg>
+constexpr bool RegisterMap<Registers...>::Contains() {
+  return (std::is_same_v<Reg, Registers> || ...);
+}
+
+template <RegisterConcept... Registers>
+constexpr bool RegisterMap<Registers...>::IsReadable(unsigned address,
+                                                     unsigned length) {
+  return address < static_cast<unsigned>(kSize) &&
+         address + length <= kReadableEnd[address];
+}
+
+template <RegisterConcept... Registers>
+constexpr bool RegisterMap<Registers...>::IsWritable(unsigned address,
+                                                     unsigned length) {
+  return address < static_cast<unsigned>(kSize) &&
+         address + length <= kWritableEnd[address];
+}
+
+template <RegisterConcept... Registers>
+constexpr bool RegisterMap<Registers...>::IsReadAllowed(Access access) {
+  return access != Access::kWriteOnly;
+}
+
+template <RegisterConcept... Registers>
+constexpr bool RegisterMap<Registers...>::IsWriteAllowed(Access access) {
+  return access != Access::kReadOnly;
+}
+
+template <RegisterConcept... Registers>
+template <bool (*kIsAllowed)(Access)>
+constexpr typename RegisterMap<Registers...>::EndTable
+RegisterMap<Registers...>::MakeEndTable() {
+  std::array<bool, kSize + 1> is_allowed{};
+  (std::fill_n(is_allowed.begin() + Registers::kAddress, Registers::kSize,
+               kIsAllowed(Registers::kAccess)),
+   ...);
+
+  EndTable end{};
+  for (int address = kSize - 1; address >= 0; address--) {
+    end[address] = is_allowed[address]
+                       ? (is_allowed[address + 1] ? end[address + 1]
+                                                  : address + 1)
+                       : address;
+  }
+  return end;
+}
+
+template <RegisterConcept... Registers>
+constexpr typename RegisterMap<Registers...>::EndTable
+    RegisterMap<Registers...>::kReadableEnd = MakeEndTable<IsReadAllowed>();
+
+template <RegisterConcept... Registers>
+constexpr typename RegisterMap<Registers...>::EndTable
+    RegisterMap<Registers...>::kWritableEnd = MakeEndTable<IsWriteAllowed>();
+
+template <typename Map>
+ReturnCode RegisterMemory<Map>::Read(std::span<std::byte> read_buffer,
+                                     unsigned address) const {
+  if (!Map::IsReadable(address, read_buffer.size())) {
+    return ReturnCode::FAIL;
+  }
+  std::memcpy(read_buffer.data(), data_.data() + address, read_buffer.size());
+  return ReturnCode::OK;
+}
+
+template <typename Map>
+ReturnCode RegisterMemory<Map>::Write(std::span<const std::byte> write_buffer,
+                                      unsigned address) {
+  if (!Map::IsWritable(address, write_buffer.size())) {
+    return ReturnCode::FAIL;
+  }
+  std::memcpy(data_.data() + address, write_buffer.data(),
+              write_buffer.size());
+  return ReturnCode::OK;
+}
+
+template <typename Map>
+template <RegisterConcept Reg>
+typename Reg::ValueType RegisterMemory<Map>::Get() const {
+  static_assert(Map::template Contains<Reg>(), "Register is not in the map");
+  typename Reg::ValueType value;
+  std::memcpy(&value, data_.data() + Reg::kAddress, Reg::kSize);
+  return value;
+}
+
+template <typename Map>
+template <RegisterConcept Reg>
+void RegisterMemory<Map>::Set(const typename Reg::ValueType& value) {
+  static_assert(Map::template Contains<Reg>(), "Register is not in the map");
+  std::memcpy(data_.data() + Reg::kAddress, &value, Reg::kSize);
+}
+
+template <typename Map, typename MasterType>
+RegisterClient<Map, MasterType>::RegisterClient(MasterType& master)
+    : master_(master) {}
+
+template <typename Map, typename MasterType>
+template <RegisterConcept Reg>
+Expected<TransactionId> RegisterClient<Map, MasterType>::RequestRead(
+    typename Reg::ValueType& value) {
+  static_assert(Map::template Contains<Reg>(), "Register is not in the map");
+  static_assert(Reg::kAccess != Access::kWriteOnly, "Register is write-only");
+  return master_.RequestRead(std::as_writable_bytes(std::span(&value, 1)),
+                             Reg::kAddress);
+}
+
+template <typename Map, typename MasterType>
+template <RegisterConcept Reg>
+void RegisterClient<Map, MasterType>::RequestWrite(
+    const typename Reg::ValueType& value) {
+  static_assert(Map::template Contains<Reg>(), "Register is not in the map");
+  static_assert(Reg::kAccess != Access::kReadOnly, "Register is read-only");
+  master_.RequestWrite(std::as_bytes(std::span(&value, 1)), Reg::kAddress);
+}
+
+}  // namespace hydrolib::bus::application
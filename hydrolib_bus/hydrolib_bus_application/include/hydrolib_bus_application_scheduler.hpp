@@ -0,0 +1,312 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_clock_concepts.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::bus::application {
+enum class SchedulingPolicy {
+  // The due poll with the shortest period goes first.
+  kRateMonotonic,
+  // Due polls take turns in the order they were added.
+  kRoundRobin
+};
+
+// Polls registers of several slaves, one Master session per slave, over one
+// shared bus. Only one request is on the bus at a time, so masters never
+// collide, and the next due poll is sent as soon as the previous one completes.
+// A poll instance released at time R has to complete by R + period, otherwise
+// it counts as a deadline miss; instances which can't even start before their
+// deadline are skipped.
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+class PollScheduler final {
+ public:
+  struct PollStats {
+    int64_t completed = 0;
+    int64_t deadline_misses = 0;
+    int64_t errors = 0;
+    int64_t timeouts = 0;
+    // Delay between release and transmission of the request.
+    typename Clock::duration max_jitter{};
+    typename Clock::duration total_jitter{};
+    // Delay between release and completion.
+    typename Clock::duration max_latency{};
+
+    [[nodiscard]] typename Clock::duration GetMeanJitter() const;
+  };
+
+  PollScheduler(SchedulingPolicy policy,
+                typename Clock::duration response_timeout,
+                Masters&... masters);
+  PollScheduler(const PollScheduler&) = delete;
+  PollScheduler(PollScheduler&&) = delete;
+  PollScheduler& operator=(const PollScheduler&) = delete;
+  PollScheduler& operator=(PollScheduler&&) = delete;
+  ~PollScheduler() = default;
+
+  // Reads data.size() bytes at the address of the session's slave every
+  // period. Returns the poll index.
+  Expected<int> AddPoll(int session, std::span<std::byte> data, int address,
+                        typename Clock::duration period);
+
+  ReturnCode Process();
+
+  [[nodiscard]] const PollStats& GetPollStats(int poll) const;
+  // Share of the time since construction the bus was busy with a poll.
+  [[nodiscard]] double GetUtilization() const;
+
+ private:
+  static constexpr int kNoPoll = -1;
+  static constexpr int kSessionsCount = sizeof...(Masters);
+
+  struct Poll {
+    int session = 0;
+    int address = 0;
+    std::span<std::byte> data;
+    typename Clock::duration period{};
+    typename Clock::time_point release_time{};
+    typename Clock::time_point start_time{};
+    TransactionId transaction_id = 0;
+    PollStats stats;
+  };
+
+  template <typename Function>
+  void VisitSession(int session, Function&& function);
+  template <typename Function, std::size_t... kIndices>
+  void VisitSession(int session, Function& function,
+                    std::index_sequence<kIndices...> indices);
+
+  void SkipMissed(Poll& poll, typename Clock::time_point now);
+  int SelectPoll(typename Clock::time_point now);
+  ReturnCode StartPoll(int poll_index, typename Clock::time_point now);
+  void FinishPoll(typename Clock::time_point now);
+
+  const SchedulingPolicy policy_;
+  const typename Clock::duration response_timeout_;
+  std::tuple<Masters&...> sessions_;
+
+  std::array<Poll, kMaxPolls> polls_{};
+  int polls_count_ = 0;
+  int next_round_robin_ = 0;
+  int in_flight_ = kNoPoll;
+
+  typename Clock::time_point start_time_;
+  typename Clock::duration busy_time_{};
+};
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+typename Clock::duration
+PollScheduler<Clock, kMaxPolls, Masters...>::PollStats::GetMeanJitter() const {
+  if (completed + timeouts == 0) {
+    return {};
+  }
+  return total_jitter / (completed + timeouts);
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+PollScheduler<Clock, kMaxPolls, Masters...>::PollScheduler(
+    SchedulingPolicy policy, typename Clock::duration response_timeout,
+    Masters&... masters)
+    : policy_(policy),
+      response_timeout_(response_timeout),
+      sessions_(masters...),
+      start_time_(Clock::now()) {}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+Expected<int> PollScheduler<Clock, kMaxPolls, Masters...>::AddPoll(
+    int session, std::span<std::byte> data, int address,
+    typename Clock::duration period) {
+  if (polls_count_ == kMaxPolls) {
+    return ReturnCode::OVERFLOW;
+  }
+  if (session < 0 || session >= kSessionsCount || data.empty() ||
+      data.size() > kMaxDataLength || period <= typename Clock::duration{}) {
+    return ReturnCode::FAIL;
+  }
+  polls_[polls_count_] = {.session = session,
+                          .address = address,
+                          .data = data,
+                          .period = period,
+                          .release_time = Clock::now(),
+                          .stats = {}};
+  return polls_count_++;
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+ReturnCode PollScheduler<Clock, kMaxPolls, Masters...>::Process() {
+  auto now = Clock::now();
+  if (in_flight_ != kNoPoll) {
+    auto& poll = polls_[in_flight_];
+    bool is_pending = true;
+    bool is_failed = false;
+    // Process() handles at most one message, so an ERROR belongs to the poll
+    // only if the same call released its transaction. Late responses to
+    // cancelled polls are reported as ERROR too, but leave the poll pending.
+    VisitSession(poll.session, [&poll, &is_pending, &is_failed](auto& master) {
+      auto result = master.Process();
+      is_pending = master.IsPending(poll.transaction_id);
+      is_failed = !is_pending && result == ReturnCode::ERROR;
+    });
+
+    if (is_pending) {
+      if (now - poll.start_time <= response_timeout_) {
+        return ReturnCode::NO_DATA;
+      }
+      VisitSession(poll.session, [&poll](auto& master) {
+        master.Cancel(poll.transaction_id);
+      });
+      poll.stats.timeouts++;
+      poll.stats.deadline_misses++;
+      poll.release_time += poll.period;
+      busy_time_ += now - poll.start_time;
+      in_flight_ = kNoPoll;
+    } else {
+      if (is_failed) {
+        poll.stats.errors++;
+      }
+      FinishPoll(now);
+    }
+  }
+
+  int next = SelectPoll(now);
+  if (next == kNoPoll) {
+    return ReturnCode::NO_DATA;
+  }
+  return StartPoll(next, now);
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+const typename PollScheduler<Clock, kMaxPolls, Masters...>::PollStats&
+PollScheduler<Clock, kMaxPolls, Masters...>::GetPollStats(int poll) const {
+  return polls_[poll].stats;
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+double PollScheduler<Clock, kMaxPolls, Masters...>::GetUtilization() const {
+  auto now = Clock::now();
+  auto busy_time = busy_time_;
+  if (in_flight_ != kNoPoll) {
+    busy_time += now - polls_[in_flight_].start_time;
+  }
+  if (now == start_time_) {
+    return 0;
+  }
+  return static_cast<double>(busy_time.count()) /
+         static_cast<double>((now - start_time_).count());
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+template <typename Function>
+void PollScheduler<Clock, kMaxPolls, Masters...>::VisitSession(
+    int session, Function&& function) {
+  VisitSession(session, function, std::index_sequence_for<Masters...>{});
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+template <typename Function, std::size_t... kIndices>
+void PollScheduler<Clock, kMaxPolls, Masters...>::VisitSession(
+    int session, Function& function,
+    [[maybe_unused]] std::index_sequence<kIndices...> indices) {
+  ((static_cast<int>(kIndices) == session
+        ? (function(std::get<kIndices>(sessions_)), true)
+        : false) ||
+   ...);
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+void PollScheduler<Clock, kMaxPolls, Masters...>::SkipMissed(
+    Poll& poll, typename Clock::time_point now) {
+  if (now < poll.release_time + poll.period) {
+    return;
+  }
+  auto missed = (now - poll.release_time) / poll.period;
+  poll.stats.deadline_misses += missed;
+  poll.release_time += missed * poll.period;
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+int PollScheduler<Clock, kMaxPolls, Masters...>::SelectPoll(
+    typename Clock::time_point now) {
+  int selected = kNoPoll;
+  for (int i = 0; i < polls_count_; i++) {
+    int index = policy_ == SchedulingPolicy::kRoundRobin
+                    ? (next_round_robin_ + i) % polls_count_
+                    : i;
+    auto& poll = polls_[index];
+    SkipMissed(poll, now);
+    if (poll.release_time > now) {
+      continue;
+    }
+    if (policy_ == SchedulingPolicy::kRoundRobin) {
+      return index;
+    }
+    if (selected == kNoPoll || poll.period < polls_[selected].period) {
+      selected = index;
+    }
+  }
+  return selected;
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+ReturnCode PollScheduler<Clock, kMaxPolls, Masters...>::StartPoll(
+    int poll_index, typename Clock::time_point now) {
+  auto& poll = polls_[poll_index];
+  ReturnCode result = ReturnCode::FAIL;
+  VisitSession(poll.session, [&poll, &result](auto& master) {
+    auto transaction_id = master.RequestRead(poll.data, poll.address);
+    result = static_cast<ReturnCode>(transaction_id);
+    poll.transaction_id = static_cast<TransactionId>(transaction_id);
+  });
+  if (result != ReturnCode::OK) {
+    return result;
+  }
+
+  auto jitter = now - poll.release_time;
+  poll.stats.total_jitter += jitter;
+  if (jitter > poll.stats.max_jitter) {
+    poll.stats.max_jitter = jitter;
+  }
+  poll.start_time = now;
+  in_flight_ = poll_index;
+  next_round_robin_ = (poll_index + 1) % polls_count_;
+  return ReturnCode::OK;
+}
+
+template <concepts::clock::ClockConcept Clock, int kMaxPolls,
+          typename... Masters>
+void PollScheduler<Clock, kMaxPolls, Masters...>::FinishPoll(
+    typename Clock::time_point now) {
+  auto& poll = polls_[in_flight_];
+  auto latency = now - poll.release_time;
+  if (latency > poll.period) {
+    poll.stats.deadline_misses++;
+  }
+  if (latency > poll.stats.max_latency) {
+    poll.stats.max_latency = latency;
+  }
+  poll.stats.completed++;
+  poll.release_time += poll.period;
+  busy_time_ += now - poll.start_time;
+  in_flight_ = kNoPoll;
+}
+
+}  // namespace hydrolib::bus::application
@@ -1,9 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstdint>
 #include <cstring>
 #include <span>
 
+#include "hydrolib_bus_application_block_transfer.hpp"
 #include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_bus_application_public_memory.hpp"
+#include "hydrolib_bus_application_receiver.hpp"
+#include "hydrolib_clock_concepts.hpp"
 #include "hydrolib_log_macro.hpp"
 #include "hydrolib_return_codes.hpp"
 #include "hydrolib_stream_concepts.hpp"
@@ -18,8 +26,39 @@ concept PublicMemoryConcept =
       { mem.Write(write_buffer, address) } -> std::same_as<ReturnCode>;
     };
 
+// Memory backed by slow hardware. BeginRead and BeginWrite return OK when the
+// access is done at once and NO_DATA when it has only been started; the read
+// buffer has to stay untouched until it finishes, write data is copied by the
+// memory. Poll() reports the oldest started access: NO_DATA while it runs, its
+// result once it is finished. Read and Write stay synchronous and may serve
+// the last known values.
+template <typename T>
+concept DeferredMemoryConcept =
+    PublicMemoryConcept<T> &&
+    requires(T mem, std::span<std::byte> read_buffer,
+             std::span<const std::byte> write_buffer, unsigned address) {
+      { mem.BeginRead(read_buffer, address) } -> std::same_as<ReturnCode>;
+      { mem.BeginWrite(write_buffer, address) } -> std::same_as<ReturnCode>;
+      { mem.Poll() } -> std::same_as<ReturnCode>;
+    };
+
+// Besides answering requests the slave pushes subscribed regions on its own
+// from Process(). On-change subscriptions compare a hash of the region, so no
+// copy of the subscribed data is kept. Delta sync (kReadChanges) is available
+// when the memory also satisfies DirtyTrackingMemoryConcept, blob transfers
+// when it satisfies BlobStorageConcept. With a
+// DeferredMemoryConcept memory, reads and writes that can't finish at once are
+// parked in up to kMaxDeferred slots and answered from a later Process(),
+// while requests to fast registers keep being answered in the meantime.
+// A batch write is checked as a whole before anything is written, and with a
+// synchronous memory the regions written before a failing one are restored,
+// so the batch applies atomically. Deferred writes can't be taken back: a
+// failing region leaves the earlier ones applied. Either way the error
+// response carries the address of the region that failed.
 template <PublicMemoryConcept Memory, typename Logger,
-          concepts::stream::ByteFullStreamConcept TxRxStream>
+          concepts::stream::ByteFullStreamConcept TxRxStream,
+          int kMaxDeferred = 4,
+          concepts::clock::ClockConcept Clock = std::chrono::steady_clock>
 class Slave {
  public:
   constexpr Slave(TxRxStream& stream, Memory& memory, Logger& logger);
@@ -32,75 +71,823 @@ class Slave {
   void Process();
 
  private:
+  struct Subscription {
+    bool is_active = false;
+    TransactionId id = 0;
+    SubscriptionInfo info{};
+    uint32_t hash = 0;
+    typename Clock::time_point next_publish_time;
+  };
+
+  struct DeferredRequest {
+    MemoryAccessMessageBuffer response{};
+    int pending_accesses = 0;
+    bool has_response = false;
+    bool is_failed = false;
+  };
+
+  static constexpr int kDeferredSlots =
+      DeferredMemoryConcept<Memory> ? kMaxDeferred : 0;
+
+  static uint32_t Hash(std::span<const std::byte> data);
+
+  void HandleRequest(const MemoryAccessMessageBuffer& request);
+  ReturnCode ReadMemory(std::span<std::byte> data, unsigned address);
+  ReturnCode WriteMemory(std::span<const std::byte> data, unsigned address);
+  MemoryAccessMessageBuffer& GetResponseBuffer();
+  void FinishRequest(MemoryAccessMessageBuffer& response,
+                     const MemoryAccessHeader& request, ReturnCode result,
+                     bool has_response);
+  void CompleteDeferred()
+    requires DeferredMemoryConcept<Memory>;
+  ReturnCode ReadBatch(const MemoryAccessMessageBuffer& request,
+                       MemoryAccessMessageBuffer& response);
+  ReturnCode WriteBatch(const MemoryAccessMessageBuffer& request,
+                        uint8_t& failed_address);
+  ReturnCode ReadChanges(const MemoryAccessMessageBuffer& request)
+    requires DirtyTrackingMemoryConcept<Memory>;
+  ReturnCode Subscribe(const MemoryAccessMessageBuffer& request);
+  void Unsubscribe(TransactionId subscription_id);
+  void Publish();
+  ReturnCode OpenTransfer(const MemoryAccessMessageBuffer& request)
+    requires BlobStorageConcept<Memory>;
+  ReturnCode HandleChunk(const MemoryAccessMessageBuffer& request)
+    requires BlobStorageConcept<Memory>;
+  void HandleTransferAck(const MemoryAccessMessageBuffer& request)
+    requires BlobStorageConcept<Memory>;
+  void SendChunks()
+    requires BlobStorageConcept<Memory>;
+  void TransmitTransferAck()
+    requires BlobStorageConcept<Memory>;
+  void TransmitError(const MemoryAccessHeader& request);
+
   TxRxStream& stream_;
   Memory& memory_;
 
   Logger& logger_;
 
-  MemoryAccessMessageBuffer rx_buffer_{};
-  ResponseMessageBuffer tx_buffer_{};
+  MessageReceiver<TxRxStream> receiver_;
+  MemoryAccessMessageBuffer tx_buffer_{};
+
+  std::array<Subscription, kMaxSubscriptions> subscriptions_{};
+  int subscriptions_count_ = 0;
+
+  std::array<DeferredRequest, kDeferredSlots> deferred_{};
+  int deferred_head_ = 0;
+  int deferred_count_ = 0;
+  int started_accesses_ = 0;
+
+  bool is_transferring_ = false;
+  TransactionId transfer_id_ = 0;
+  TransferRequest transfer_{};
+  uint32_t transfer_size_ = 0;
+  BlockSender<> transfer_sender_;
+  BlockReceiver<> transfer_receiver_;
 };
 
 template <PublicMemoryConcept Memory, typename Logger,
-          concepts::stream::ByteFullStreamConcept TxRxStream>
-constexpr Slave<Memory, Logger, TxRxStream>::Slave(TxRxStream& stream,
-                                                   Memory& memory,
-                                                   Logger& logger)
-    : stream_(stream), memory_(memory), logger_(logger) {}
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+constexpr Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::Slave(
+    TxRxStream& stream, Memory& memory, Logger& logger)
+    : stream_(stream), memory_(memory), logger_(logger), receiver_(stream) {}
 
 template <PublicMemoryConcept Memory, typename Logger,
-          concepts::stream::ByteFullStreamConcept TxRxStream>
-void Slave<Memory, Logger, TxRxStream>::Process() {
-  int read_length = read(stream_, &rx_buffer_, kMaxMessageLength);
-  if (read_length == 0) {
-    return;
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::Process() {
+  if constexpr (DeferredMemoryConcept<Memory>) {
+    CompleteDeferred();
+  }
+  // With every slot taken new requests wait in the stream.
+  if (deferred_count_ < kDeferredSlots || kDeferredSlots == 0) {
+    if (receiver_.Process() == ReturnCode::OK) {
+      HandleRequest(receiver_.GetMessage());
+    }
+  }
+  if (subscriptions_count_ != 0) {
+    Publish();
+  }
+  if constexpr (BlobStorageConcept<Memory>) {
+    if (is_transferring_ &&
+        transfer_.direction == TransferDirection::kDownload) {
+      SendChunks();
+    }
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+uint32_t Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::Hash(
+    std::span<const std::byte> data) {
+  constexpr uint32_t kFnvOffsetBasis = 2166136261U;
+  constexpr uint32_t kFnvPrime = 16777619U;
+  uint32_t hash = kFnvOffsetBasis;
+  for (auto byte : data) {
+    hash = (hash ^ static_cast<uint8_t>(byte)) * kFnvPrime;
   }
+  return hash;
+}
 
-  switch (rx_buffer_.header.command) {
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::HandleRequest(
+    const MemoryAccessMessageBuffer& request) {
+  started_accesses_ = 0;
+  switch (request.header.command) {
     case Command::kRead: {
-      ReturnCode res = memory_.Read(
-          std::span<std::byte>(static_cast<std::byte*>(tx_buffer_.data),
-                               rx_buffer_.header.info.length),
-          rx_buffer_.header.info.address);
+      auto& response = GetResponseBuffer();
+      ReturnCode res = ReadMemory(
+          std::span<std::byte>(static_cast<std::byte*>(response.data),
+                               request.header.info.length),
+          request.header.info.address);
       if (res == ReturnCode::OK) {
         LOG_INFO(logger_, "Transmitting {} bytes from {}",
-                 rx_buffer_.header.info.length, rx_buffer_.header.info.address);
-        tx_buffer_.command = Command::kResponse;
-        write(stream_, &tx_buffer_,
-              sizeof(Command) + rx_buffer_.header.info.length);
+                 request.header.info.length, request.header.info.address);
+        response.header = request.header;
+        response.header.command = Command::kResponse;
       } else {
         LOG_WARNING(logger_, "Can't read {} bytes from {}",
-                    rx_buffer_.header.info.length,
-                    rx_buffer_.header.info.address);
-        tx_buffer_.command = Command::kError;
-        write(stream_, &tx_buffer_, sizeof(Command));
+                    request.header.info.length, request.header.info.address);
       }
+      FinishRequest(response, request.header, res, true);
       break;
     }
     case Command::kWrite: {
-      ReturnCode res =
-          memory_.Write(std::span<const std::byte>(
-                            static_cast<const std::byte*>(rx_buffer_.data),
-                            rx_buffer_.header.info.length),
-                        rx_buffer_.header.info.address);
+      ReturnCode res = WriteMemory(
+          std::span<const std::byte>(
+              static_cast<const std::byte*>(request.data),
+              request.header.info.length),
+          request.header.info.address);
       if (res != ReturnCode::OK) {
         LOG_WARNING(logger_, "Can't write {} bytes to {}",
-                    rx_buffer_.header.info.length,
-                    rx_buffer_.header.info.address);
-        tx_buffer_.command = Command::kError;
-        write(stream_, &tx_buffer_, sizeof(Command));
+                    request.header.info.length, request.header.info.address);
       } else {
-        LOG_INFO(logger_, "Wrote {} bytes to {}", rx_buffer_.header.info.length,
-                 rx_buffer_.header.info.address);
+        LOG_INFO(logger_, "Wrote {} bytes to {}", request.header.info.length,
+                 request.header.info.address);
       }
+      FinishRequest(GetResponseBuffer(), request.header, res, false);
+    } break;
+    case Command::kReadBatch: {
+      auto& response = GetResponseBuffer();
+      FinishRequest(response, request.header, ReadBatch(request, response),
+                    true);
+    } break;
+    case Command::kWriteBatch: {
+      uint8_t failed_address = request.header.info.address;
+      ReturnCode res = WriteBatch(request, failed_address);
+      MemoryAccessHeader header = request.header;
+      header.info.address = failed_address;
+      FinishRequest(GetResponseBuffer(), header, res, false);
     } break;
+    case Command::kSubscribe:
+      if (Subscribe(request) != ReturnCode::OK) {
+        TransmitError(request.header);
+      }
+      break;
+    case Command::kUnsubscribe:
+      Unsubscribe(request.header.transaction_id);
+      break;
+    case Command::kReadChanges:
+      if constexpr (DirtyTrackingMemoryConcept<Memory>) {
+        if (ReadChanges(request) != ReturnCode::OK) {
+          TransmitError(request.header);
+        }
+      } else {
+        LOG_WARNING(logger_, "Memory doesn't track changes");
+        TransmitError(request.header);
+      }
+      break;
+    case Command::kOpenTransfer:
+    case Command::kTransferData:
+    case Command::kTransferAck:
+    case Command::kCloseTransfer:
+      if constexpr (BlobStorageConcept<Memory>) {
+        if (request.header.command == Command::kOpenTransfer) {
+          if (OpenTransfer(request) != ReturnCode::OK) {
+            TransmitError(request.header);
+          }
+        } else if (!is_transferring_ ||
+                   request.header.transaction_id != transfer_id_) {
+          LOG_WARNING(logger_, "Unknown transfer {}",
+                      request.header.transaction_id);
+        } else if (request.header.command == Command::kTransferData) {
+          if (HandleChunk(request) != ReturnCode::OK) {
+            is_transferring_ = false;
+            TransmitError(request.header);
+          }
+        } else if (request.header.command == Command::kTransferAck) {
+          HandleTransferAck(request);
+        } else {
+          LOG_INFO(logger_, "Transfer {} closed", transfer_id_);
+          is_transferring_ = false;
+        }
+      } else {
+        LOG_WARNING(logger_, "Memory doesn't store blobs");
+        TransmitError(request.header);
+      }
+      break;
     case Command::kError:
     case Command::kResponse:
+    case Command::kPublish:
     default:
       LOG_WARNING(logger_, "Wrong command");
-      tx_buffer_.command = Command::kError;
-      write(stream_, &tx_buffer_, sizeof(Command));
+      TransmitError(request.header);
+      break;
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+ReturnCode Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::ReadMemory(
+    std::span<std::byte> data, unsigned address) {
+  if constexpr (DeferredMemoryConcept<Memory>) {
+    ReturnCode res = memory_.BeginRead(data, address);
+    if (res == ReturnCode::NO_DATA) {
+      started_accesses_++;
+      return ReturnCode::OK;
+    }
+    return res;
+  } else {
+    return memory_.Read(data, address);
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+ReturnCode Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::WriteMemory(
+    std::span<const std::byte> data, unsigned address) {
+  if constexpr (DeferredMemoryConcept<Memory>) {
+    ReturnCode res = memory_.BeginWrite(data, address);
+    if (res == ReturnCode::NO_DATA) {
+      started_accesses_++;
+      return ReturnCode::OK;
+    }
+    return res;
+  } else {
+    return memory_.Write(data, address);
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+MemoryAccessMessageBuffer&
+Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::GetResponseBuffer() {
+  if constexpr (DeferredMemoryConcept<Memory>) {
+    return deferred_[(deferred_head_ + deferred_count_) % kDeferredSlots]
+        .response;
+  } else {
+    return tx_buffer_;
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::FinishRequest(
+    MemoryAccessMessageBuffer& response, const MemoryAccessHeader& request,
+    ReturnCode result, bool has_response) {
+  if constexpr (DeferredMemoryConcept<Memory>) {
+    // Accesses started before a failure still report through Poll(), so the
+    // request is parked until they are drained.
+    if (started_accesses_ != 0) {
+      auto& deferred =
+          deferred_[(deferred_head_ + deferred_count_) % kDeferredSlots];
+      if (result != ReturnCode::OK || !has_response) {
+        response.header = request;
+      }
+      deferred.pending_accesses = started_accesses_;
+      deferred.has_response = has_response;
+      deferred.is_failed = result != ReturnCode::OK;
+      deferred_count_++;
+      LOG_INFO(logger_, "Request {} deferred", request.transaction_id);
+      return;
+    }
+  }
+  if (result != ReturnCode::OK) {
+    TransmitError(request);
+  } else if (has_response) {
+    write(stream_, &response,
+          sizeof(MemoryAccessHeader) + response.header.info.length);
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::CompleteDeferred()
+  requires DeferredMemoryConcept<Memory>
+{
+  while (deferred_count_ != 0) {
+    auto& deferred = deferred_[deferred_head_];
+    while (deferred.pending_accesses != 0) {
+      ReturnCode res = memory_.Poll();
+      if (res == ReturnCode::NO_DATA) {
+        return;
+      }
+      deferred.pending_accesses--;
+      if (res != ReturnCode::OK) {
+        deferred.is_failed = true;
+      }
+    }
+
+    if (deferred.is_failed) {
+      LOG_WARNING(logger_, "Deferred request {} failed",
+                  deferred.response.header.transaction_id);
+      TransmitError(deferred.response.header);
+    } else if (deferred.has_response) {
+      write(stream_, &deferred.response,
+            sizeof(MemoryAccessHeader) + deferred.response.header.info.length);
+    }
+    deferred_head_ = (deferred_head_ + 1) % kDeferredSlots;
+    deferred_count_--;
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+ReturnCode Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::ReadBatch(
+    const MemoryAccessMessageBuffer& request,
+    MemoryAccessMessageBuffer& response) {
+  if (request.header.info.length % sizeof(MemoryAccessInfo) != 0) {
+    LOG_WARNING(logger_, "Wrong batch length {}", request.header.info.length);
+    return ReturnCode::ERROR;
+  }
+
+  unsigned response_length = 0;
+  for (unsigned position = 0; position < request.header.info.length;
+       position += sizeof(MemoryAccessInfo)) {
+    MemoryAccessInfo info{};
+    std::memcpy(&info, request.data + position, sizeof(info));
+    if (response_length + info.length > kMaxDataLength) {
+      LOG_WARNING(logger_, "Batch response exceeds {} bytes", kMaxDataLength);
+      return ReturnCode::OVERFLOW;
+    }
+    ReturnCode res = ReadMemory(
+        std::span<std::byte>(response.data + response_length, info.length),
+        info.address);
+    if (res != ReturnCode::OK) {
+      LOG_WARNING(logger_, "Can't read {} bytes from {}", info.length,
+                  info.address);
+      return res;
+    }
+    response_length += info.length;
+  }
+
+  LOG_INFO(logger_, "Transmitting {} batched bytes", response_length);
+  response.header = {.command = Command::kResponse,
+                     .transaction_id = request.header.transaction_id,
+                     .info = {.address = 0,
+                              .length = static_cast<uint8_t>(response_length)}};
+  return ReturnCode::OK;
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+ReturnCode Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::WriteBatch(
+    const MemoryAccessMessageBuffer& request, uint8_t& failed_address) {
+  struct Region {
+    MemoryAccessInfo info;
+    std::span<const std::byte> data;
+  };
+  std::array<Region, kMaxBatchRegions> regions{};
+  int regions_count = 0;
+
+  auto payload = std::span<const std::byte>(request.data,
+                                            request.header.info.length);
+  while (!payload.empty()) {
+    MemoryAccessInfo info{};
+    if (payload.size() < sizeof(info)) {
+      LOG_WARNING(logger_, "Truncated batch descriptor");
+      return ReturnCode::ERROR;
+    }
+    std::memcpy(&info, payload.data(), sizeof(info));
+    payload = payload.subspan(sizeof(info));
+    if (payload.size() < info.length) {
+      LOG_WARNING(logger_, "Truncated batch data for {}", info.address);
+      failed_address = info.address;
+      return ReturnCode::ERROR;
+    }
+    if (regions_count == kMaxBatchRegions) {
+      LOG_WARNING(logger_, "Batch exceeds {} regions", kMaxBatchRegions);
+      return ReturnCode::OVERFLOW;
+    }
+    regions[regions_count++] = {.info = info,
+                                .data = payload.first(info.length)};
+    payload = payload.subspan(info.length);
+  }
+
+  std::array<std::byte, kMaxDataLength> backup{};
+  if constexpr (!DeferredMemoryConcept<Memory>) {
+    auto* position = backup.data();
+    for (const auto& region : std::span(regions).first(regions_count)) {
+      ReturnCode res = memory_.Read(
+          std::span<std::byte>(position, region.info.length),
+          region.info.address);
+      if (res != ReturnCode::OK) {
+        LOG_WARNING(logger_, "Can't write {} bytes to {}", region.info.length,
+                    region.info.address);
+        failed_address = region.info.address;
+        return res;
+      }
+      position += region.info.length;
+    }
+  }
+
+  auto* position = backup.data();
+  for (int i = 0; i < regions_count; i++) {
+    const auto& region = regions[i];
+    ReturnCode res = WriteMemory(region.data, region.info.address);
+    if (res != ReturnCode::OK) {
+      LOG_WARNING(logger_, "Can't write {} bytes to {}", region.info.length,
+                  region.info.address);
+      failed_address = region.info.address;
+      if constexpr (!DeferredMemoryConcept<Memory>) {
+        for (int j = i - 1; j >= 0; j--) {
+          position -= regions[j].info.length;
+          memory_.Write(std::span<const std::byte>(position,
+                                                   regions[j].info.length),
+                        regions[j].info.address);
+        }
+      }
+      return res;
+    }
+    LOG_INFO(logger_, "Wrote {} bytes to {}", region.info.length,
+             region.info.address);
+    position += region.info.length;
+  }
+  return ReturnCode::OK;
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+ReturnCode Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::ReadChanges(
+    const MemoryAccessMessageBuffer& request)
+  requires DirtyTrackingMemoryConcept<Memory>
+{
+  if (request.header.info.length != sizeof(ChangesRequest)) {
+    LOG_WARNING(logger_, "Wrong changes request length {}",
+                request.header.info.length);
+    return ReturnCode::ERROR;
+  }
+  ChangesRequest changes{};
+  std::memcpy(&changes, request.data, sizeof(changes));
+  if (changes.is_synced == 0 ||
+      changes.since_version != memory_.GetVersion()) {
+    memory_.MarkAllDirty();
+  }
+
+  ChangesHeader header{.version = 0, .has_more = 0};
+  unsigned length = sizeof(header);
+  int blocks_count = memory_.GetBlocksCount();
+  int block = memory_.FindDirtyBlock(0);
+  while (block < blocks_count) {
+    int end_block = block + 1;
+    while (end_block < blocks_count &&
+           memory_.FindDirtyBlock(end_block) == end_block) {
+      end_block++;
+    }
+
+    int room = static_cast<int>(kMaxDataLength) - static_cast<int>(length);
+    if (room < static_cast<int>(sizeof(MemoryAccessInfo)) +
+                   Memory::kBlockSize) {
+      header.has_more = 1;
+      break;
+    }
+    int fitting_blocks = (room - static_cast<int>(sizeof(MemoryAccessInfo))) /
+                         Memory::kBlockSize;
+    if (end_block - block > fitting_blocks) {
+      end_block = block + fitting_blocks;
+      header.has_more = 1;
+    }
+    if (end_block == block) {
+      break;
+    }
+
+    int address = block * Memory::kBlockSize;
+    int run_length =
+        std::min(end_block * Memory::kBlockSize, memory_.GetSize()) - address;
+    MemoryAccessInfo info{.address = static_cast<uint8_t>(address),
+                          .length = static_cast<uint8_t>(run_length)};
+    std::memcpy(tx_buffer_.data + length, &info, sizeof(info));
+    length += sizeof(info);
+    ReturnCode res = memory_.Read(
+        std::span<std::byte>(tx_buffer_.data + length, run_length), address);
+    if (res != ReturnCode::OK) {
+      return res;
+    }
+    length += run_length;
+    for (int sent_block = block; sent_block < end_block; sent_block++) {
+      memory_.ClearDirty(sent_block);
+    }
+    if (header.has_more != 0) {
       break;
+    }
+    block = memory_.FindDirtyBlock(end_block);
+  }
+
+  memory_.NextVersion();
+  header.version = memory_.GetVersion();
+  std::memcpy(tx_buffer_.data, &header, sizeof(header));
+  LOG_INFO(logger_, "Transmitting changes up to version {}", header.version);
+  tx_buffer_.header = {
+      .command = Command::kResponse,
+      .transaction_id = request.header.transaction_id,
+      .info = {.address = 0, .length = static_cast<uint8_t>(length)}};
+  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader) + length);
+  return ReturnCode::OK;
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+ReturnCode Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::Subscribe(
+    const MemoryAccessMessageBuffer& request) {
+  if (request.header.info.length != sizeof(SubscriptionInfo)) {
+    LOG_WARNING(logger_, "Wrong subscription length {}",
+                request.header.info.length);
+    return ReturnCode::ERROR;
+  }
+  SubscriptionInfo info{};
+  std::memcpy(&info, request.data, sizeof(info));
+  if (info.mode == SubscriptionMode::kPeriodic && info.period_ms == 0) {
+    LOG_WARNING(logger_, "Zero period of subscription {}",
+                request.header.transaction_id);
+    return ReturnCode::ERROR;
+  }
+
+  // A retransmitted request renews the subscription it has already created.
+  auto subscription = std::ranges::find_if(
+      subscriptions_, [&request](const Subscription& subscription) {
+        return subscription.is_active &&
+               subscription.id == request.header.transaction_id;
+      });
+  if (subscription == subscriptions_.end()) {
+    subscription = std::ranges::find_if(
+        subscriptions_, [](const Subscription& subscription) {
+          return !subscription.is_active;
+        });
+    if (subscription == subscriptions_.end()) {
+      LOG_WARNING(logger_, "No room for subscription {}",
+                  request.header.transaction_id);
+      return ReturnCode::OVERFLOW;
+    }
+    subscriptions_count_++;
+  }
+  subscription->is_active = false;
+
+  auto data = std::span<std::byte>(static_cast<std::byte*>(tx_buffer_.data),
+                                   info.region.length);
+  ReturnCode res = memory_.Read(data, info.region.address);
+  if (res != ReturnCode::OK) {
+    LOG_WARNING(logger_, "Can't subscribe to {} bytes from {}",
+                info.region.length, info.region.address);
+    subscriptions_count_--;
+    return res;
+  }
+
+  LOG_INFO(logger_, "Subscription {} to {} bytes from {}",
+           request.header.transaction_id, info.region.length,
+           info.region.address);
+  *subscription = {.is_active = true,
+                   .id = request.header.transaction_id,
+                   .info = info,
+                   .hash = Hash(data),
+                   .next_publish_time =
+                       Clock::now() +
+                       std::chrono::milliseconds(info.period_ms)};
+  tx_buffer_.header = {.command = Command::kResponse,
+                       .transaction_id = request.header.transaction_id,
+                       .info = info.region};
+  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader) + info.region.length);
+  return ReturnCode::OK;
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::Unsubscribe(
+    TransactionId subscription_id) {
+  for (auto& subscription : subscriptions_) {
+    if (subscription.is_active && subscription.id == subscription_id) {
+      LOG_INFO(logger_, "Subscription {} cancelled", subscription_id);
+      subscription.is_active = false;
+      subscriptions_count_--;
+      return;
+    }
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::Publish() {
+  auto now = Clock::now();
+  for (auto& subscription : subscriptions_) {
+    if (!subscription.is_active || now < subscription.next_publish_time) {
+      continue;
+    }
+    subscription.next_publish_time =
+        now + std::chrono::milliseconds(subscription.info.period_ms);
+
+    auto data = std::span<std::byte>(static_cast<std::byte*>(tx_buffer_.data),
+                                     subscription.info.region.length);
+    if (memory_.Read(data, subscription.info.region.address) !=
+        ReturnCode::OK) {
+      continue;
+    }
+    if (subscription.info.mode == SubscriptionMode::kOnChange) {
+      auto hash = Hash(data);
+      if (hash == subscription.hash) {
+        continue;
+      }
+      subscription.hash = hash;
+    }
+
+    tx_buffer_.header = {.command = Command::kPublish,
+                         .transaction_id = subscription.id,
+                         .info = subscription.info.region};
+    write(stream_, &tx_buffer_,
+          sizeof(MemoryAccessHeader) + subscription.info.region.length);
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+ReturnCode Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::OpenTransfer(
+    const MemoryAccessMessageBuffer& request)
+  requires BlobStorageConcept<Memory>
+{
+  if (request.header.info.length != sizeof(TransferRequest)) {
+    LOG_WARNING(logger_, "Wrong transfer request length {}",
+                request.header.info.length);
+    return ReturnCode::ERROR;
+  }
+  TransferRequest transfer{};
+  std::memcpy(&transfer, request.data, sizeof(transfer));
+  auto blob_size = memory_.GetBlobSize(transfer.blob_id);
+  if (static_cast<ReturnCode>(blob_size) != ReturnCode::OK) {
+    LOG_WARNING(logger_, "Unknown blob {}", transfer.blob_id);
+    return ReturnCode::FAIL;
+  }
+
+  uint32_t size = transfer.direction == TransferDirection::kDownload
+                      ? static_cast<uint32_t>(blob_size)
+                      : transfer.size;
+  if (size > static_cast<uint32_t>(blob_size) || transfer.offset > size) {
+    LOG_WARNING(logger_, "Transfer of {} bytes from {} doesn't fit blob {}",
+                size, transfer.offset, transfer.blob_id);
+    return ReturnCode::OVERFLOW;
+  }
+
+  // A retransmitted open restarts the transfer from the same offset.
+  auto chunks_count = GetChunksCount(size - transfer.offset);
+  if (transfer.direction == TransferDirection::kDownload) {
+    transfer_sender_.Start(chunks_count);
+  } else {
+    transfer_receiver_.Start(chunks_count);
+  }
+  is_transferring_ = true;
+  transfer_id_ = request.header.transaction_id;
+  transfer_ = transfer;
+  transfer_size_ = size;
+  LOG_INFO(logger_, "Transfer {} of blob {} from {}", transfer_id_,
+           transfer.blob_id, transfer.offset);
+
+  TransferInfo info{.size = size};
+  tx_buffer_.header = {
+      .command = Command::kResponse,
+      .transaction_id = transfer_id_,
+      .info = {.address = 0, .length = sizeof(TransferInfo)}};
+  std::memcpy(tx_buffer_.data, &info, sizeof(info));
+  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader) + sizeof(info));
+  return ReturnCode::OK;
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+ReturnCode Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::HandleChunk(
+    const MemoryAccessMessageBuffer& request)
+  requires BlobStorageConcept<Memory>
+{
+  if (transfer_.direction != TransferDirection::kUpload ||
+      request.header.info.length < sizeof(ChunkHeader)) {
+    LOG_WARNING(logger_, "Unexpected chunk");
+    return ReturnCode::ERROR;
+  }
+  ChunkHeader chunk{};
+  std::memcpy(&chunk, request.data, sizeof(chunk));
+  auto offset = transfer_.offset + chunk.index * kChunkSize;
+  unsigned length = request.header.info.length - sizeof(ChunkHeader);
+  if (offset >= transfer_size_ ||
+      length != std::min(kChunkSize, transfer_size_ - offset)) {
+    LOG_WARNING(logger_, "Wrong chunk {}", chunk.index);
+    return ReturnCode::ERROR;
+  }
+
+  if (transfer_receiver_.Accept(chunk.index)) {
+    ReturnCode res = memory_.WriteBlob(
+        transfer_.blob_id, offset,
+        std::span<const std::byte>(request.data + sizeof(ChunkHeader),
+                                   length));
+    if (res != ReturnCode::OK) {
+      LOG_WARNING(logger_, "Can't write chunk {} of blob {}", chunk.index,
+                  transfer_.blob_id);
+      return res;
+    }
+  }
+  if (transfer_receiver_.IsAckDue()) {
+    TransmitTransferAck();
+  }
+  return ReturnCode::OK;
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::HandleTransferAck(
+    const MemoryAccessMessageBuffer& request)
+  requires BlobStorageConcept<Memory>
+{
+  if (transfer_.direction != TransferDirection::kDownload ||
+      request.header.info.length != sizeof(TransferAck)) {
+    LOG_WARNING(logger_, "Unexpected transfer ack");
+    return;
   }
+  TransferAck ack{};
+  std::memcpy(&ack, request.data, sizeof(ack));
+  transfer_sender_.HandleAck(ack);
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::SendChunks()
+  requires BlobStorageConcept<Memory>
+{
+  uint32_t index = 0;
+  while (transfer_sender_.GetNextChunk(index)) {
+    auto offset = transfer_.offset + index * kChunkSize;
+    auto length = std::min(kChunkSize, transfer_size_ - offset);
+    ChunkHeader chunk{.index = index};
+    std::memcpy(tx_buffer_.data, &chunk, sizeof(chunk));
+    ReturnCode res = memory_.ReadBlob(
+        transfer_.blob_id, offset,
+        std::span<std::byte>(tx_buffer_.data + sizeof(chunk), length));
+    if (res != ReturnCode::OK) {
+      LOG_WARNING(logger_, "Can't read chunk {} of blob {}", index,
+                  transfer_.blob_id);
+      is_transferring_ = false;
+      TransmitError({.command = Command::kTransferData,
+                     .transaction_id = transfer_id_,
+                     .info = {.address = 0, .length = 0}});
+      return;
+    }
+    tx_buffer_.header = {
+        .command = Command::kTransferData,
+        .transaction_id = transfer_id_,
+        .info = {.address = 0,
+                 .length = static_cast<uint8_t>(sizeof(chunk) + length)}};
+    write(stream_, &tx_buffer_,
+          sizeof(MemoryAccessHeader) + sizeof(chunk) + length);
+  }
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred,
+           Clock>::TransmitTransferAck()
+  requires BlobStorageConcept<Memory>
+{
+  auto ack = transfer_receiver_.MakeAck();
+  tx_buffer_.header = {
+      .command = Command::kTransferAck,
+      .transaction_id = transfer_id_,
+      .info = {.address = 0, .length = sizeof(TransferAck)}};
+  std::memcpy(tx_buffer_.data, &ack, sizeof(ack));
+  write(stream_, &tx_buffer_, sizeof(MemoryAccessHeader) + sizeof(ack));
+}
+
+template <PublicMemoryConcept Memory, typename Logger,
+          concepts::stream::ByteFullStreamConcept TxRxStream, int kMaxDeferred,
+          concepts::clock::ClockConcept Clock>
+void Slave<Memory, Logger, TxRxStream, kMaxDeferred, Clock>::TransmitError(
+    const MemoryAccessHeader& request) {
+  MemoryAccessHeader header{.command = Command::kError,
+                            .transaction_id = request.transaction_id,
+                            .info = {.address = request.info.address,
+                                     .length = 0}};
+  write(stream_, &header, sizeof(header));
 }
 }  // namespace hydrolib::bus::application
@@ -145,11 +145,10 @@ TEST_F(TestHydrolibBusApplication, ReadTimeoutTest) {
   ASSERT_LE(test_case.address + test_case.length,
             TestPublicMemory::kPublicMemoryLength);
   std::ranges::copy(test_data, memory.memory.begin());
-  auto start_time = std::chrono::steady_clock::now();
   master.RequestRead(buffer, test_case.address);
-  while (std::chrono::steady_clock::now() - start_time <
-         decltype(master)::kRequestTimeout) {
-  }
+  hydrolib::streams::mock::TestClock::current_time +=
+      decltype(master)::kDefaultRequestTimeout +
+      2 * decltype(master)::kTimerTick;
   stream.Clear();
   EXPECT_EQ(hydrolib::ReturnCode::TIMEOUT, master.Process());
   stream.MakeAllbytesAvailable();
@@ -167,11 +166,9 @@ TEST_F(TestHydrolibBusApplication, ReadAlmostTimeoutTest) {
   ASSERT_LE(test_case.address + test_case.length,
             TestPublicMemory::kPublicMemoryLength);
   std::ranges::copy(test_data, memory.memory.begin());
-  auto start_time = std::chrono::steady_clock::now();
   master.RequestRead(buffer, test_case.address);
-  while (std::chrono::steady_clock::now() - start_time <
-         decltype(master)::kRequestTimeout - 10ms) {
-  }
+  hydrolib::streams::mock::TestClock::current_time +=
+      decltype(master)::kDefaultRequestTimeout;
   stream.MakeAllbytesAvailable();
   slave.Process();
   stream.MakeAllbytesAvailable();
@@ -181,6 +178,51 @@ TEST_F(TestHydrolibBusApplication, ReadAlmostTimeoutTest) {
   }
 }
 
+TEST_F(TestHydrolibBusApplication, RequestTimeoutIsConfigurable) {
+  std::array<std::byte, 4> buffer{};
+  master.SetRequestTimeout(20ms);
+  master.RequestRead(buffer, 0);
+  hydrolib::streams::mock::TestClock::current_time += 20ms;
+  EXPECT_EQ(hydrolib::ReturnCode::NO_DATA, master.Process());
+  hydrolib::streams::mock::TestClock::current_time +=
+      2 * decltype(master)::kTimerTick;
+  stream.Clear();
+  EXPECT_EQ(hydrolib::ReturnCode::TIMEOUT, master.Process());
+  EXPECT_EQ(hydrolib::ReturnCode::NO_DATA, master.Process());
+  EXPECT_FALSE(stream.IsEmpty());
+}
+
+TEST_F(TestHydrolibBusApplication, MastersShareTimers) {
+  using TestClock = hydrolib::streams::mock::TestClock;
+  using SharedMaster = hydrolib::bus::application::Master<
+      hydrolib::streams::mock::MockByteStream,
+      decltype(hydrolib::logger::mock_logger), 8, TestClock>;
+  SharedMaster::Timers timers(1ms);
+  hydrolib::streams::mock::MockByteStream fast_stream;
+  hydrolib::streams::mock::MockByteStream slow_stream;
+  SharedMaster fast(fast_stream, hydrolib::logger::mock_logger, timers);
+  SharedMaster slow(slow_stream, hydrolib::logger::mock_logger, timers);
+  fast.SetRequestTimeout(10ms);
+  slow.SetRequestTimeout(50ms);
+  std::array<std::byte, 4> buffer{};
+  auto fast_id = fast.RequestRead(buffer, 0);
+  slow.RequestRead(buffer, 0);
+  EXPECT_EQ(timers.GetRunningCount(), 2);
+
+  TestClock::current_time += 12ms;
+  // Masters only react to timers advanced by the owner of the wheel.
+  EXPECT_EQ(hydrolib::ReturnCode::NO_DATA, fast.Process());
+  EXPECT_EQ(timers.Process(), 1);
+  EXPECT_EQ(hydrolib::ReturnCode::TIMEOUT, fast.Process());
+  EXPECT_EQ(hydrolib::ReturnCode::NO_DATA, slow.Process());
+
+  TestClock::current_time += 40ms;
+  timers.Process();
+  EXPECT_EQ(hydrolib::ReturnCode::TIMEOUT, slow.Process());
+  EXPECT_EQ(fast.Cancel(fast_id), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(timers.GetRunningCount(), 1);
+}
+
 TEST_F(TestHydrolibBusApplication,
        MemoryAccessReadError) {  // TODO: vscode - modernize mock
                                  // https://app.weeek.net/ws/701833/task/1065
@@ -265,8 +307,116 @@ TEST_F(TestHydrolibBusApplication, UnexpectedLenghtDataTest) {
   wrong_data.header.info.length = requested_lenght + 1;
 
   write(stream, &wrong_data,
-        sizeof(hydrolib::bus::application::MemoryAccessHeader) + 1);
+        sizeof(hydrolib::bus::application::MemoryAccessHeader) +
+            wrong_data.header.info.length);
 
   stream.MakeAllbytesAvailable();
   EXPECT_EQ(master.Process(), hydrolib::ReturnCode::ERROR);
-}
\ No newline at end of file
+}
+TEST_F(TestHydrolibBusApplication, BatchReadTest) {
+  std::ranges::copy(test_data, memory.memory.begin());
+  std::array<std::byte, 2> yaw{};
+  std::array<std::byte, 4> depth{};
+  std::array<std::byte, 1> thrusters{};
+  std::array regions = {
+      hydrolib::bus::application::ReadRegion{.address = 20, .data = yaw},
+      hydrolib::bus::application::ReadRegion{.address = 3, .data = depth},
+      hydrolib::bus::application::ReadRegion{.address = 11,
+                                             .data = thrusters}};
+
+  master.RequestRead(regions);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  EXPECT_FALSE(stream.IsEmpty());
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_TRUE(stream.IsEmpty());
+
+  EXPECT_EQ(yaw[0], memory.memory[20]);
+  EXPECT_EQ(yaw[1], memory.memory[21]);
+  for (int i = 0; i < 4; i++) {
+    EXPECT_EQ(depth[i], memory.memory[3 + i]);
+  }
+  EXPECT_EQ(thrusters[0], memory.memory[11]);
+}
+
+TEST_F(TestHydrolibBusApplication, BatchWriteTest) {
+  std::array<std::byte, 2> first{std::byte(0xA1), std::byte(0xA2)};
+  std::array<std::byte, 3> second{std::byte(0xB1), std::byte(0xB2),
+                                  std::byte(0xB3)};
+  std::array regions = {
+      hydrolib::bus::application::WriteRegion{.address = 1, .data = first},
+      hydrolib::bus::application::WriteRegion{.address = 25, .data = second}};
+
+  EXPECT_EQ(master.RequestWrite(regions), hydrolib::ReturnCode::OK);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  EXPECT_TRUE(stream.IsEmpty());
+
+  EXPECT_EQ(memory.memory[0], std::byte(0));
+  EXPECT_EQ(memory.memory[1], std::byte(0xA1));
+  EXPECT_EQ(memory.memory[2], std::byte(0xA2));
+  EXPECT_EQ(memory.memory[25], std::byte(0xB1));
+  EXPECT_EQ(memory.memory[27], std::byte(0xB3));
+}
+
+TEST_F(TestHydrolibBusApplication, BatchWriteIsAtomicTest) {
+  std::array<std::byte, 2> first{std::byte(0xA1), std::byte(0xA2)};
+  std::array<std::byte, 2> second{std::byte(0xB1), std::byte(0xB2)};
+  std::array<std::byte, 2> invalid{std::byte(0xC1), std::byte(0xC2)};
+  std::array regions = {
+      hydrolib::bus::application::WriteRegion{.address = 1, .data = first},
+      hydrolib::bus::application::WriteRegion{.address = 10, .data = second},
+      hydrolib::bus::application::WriteRegion{
+          .address = TestPublicMemory::kPublicMemoryLength - 1,
+          .data = invalid}};
+
+  EXPECT_EQ(master.RequestWrite(regions), hydrolib::ReturnCode::OK);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  ASSERT_EQ(stream.GetSize(),
+            sizeof(hydrolib::bus::application::MemoryAccessHeader));
+  EXPECT_EQ(static_cast<hydrolib::bus::application::Command>(stream[0]),
+            hydrolib::bus::application::Command::kError);
+  EXPECT_EQ(stream[2], TestPublicMemory::kPublicMemoryLength - 1);
+  for (auto byte : memory.memory) {
+    EXPECT_EQ(byte, std::byte(0));
+  }
+}
+
+TEST_F(TestHydrolibBusApplication, BatchReadErrorTest) {
+  std::array<std::byte, 2> valid{};
+  std::array<std::byte, 2> invalid{};
+  std::array regions = {
+      hydrolib::bus::application::ReadRegion{.address = 0, .data = valid},
+      hydrolib::bus::application::ReadRegion{
+          .address = TestPublicMemory::kPublicMemoryLength - 1,
+          .data = invalid}};
+
+  master.RequestRead(regions);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::ERROR);
+  EXPECT_EQ(master.GetPendingCount(), 0);
+}
+
+TEST_F(TestHydrolibBusApplication, BatchTooLargeTest) {
+  std::array<std::byte, hydrolib::bus::application::kMaxDataLength> buffer{};
+  std::array<std::byte, 1> extra{};
+  std::array read_regions = {
+      hydrolib::bus::application::ReadRegion{.address = 0, .data = buffer},
+      hydrolib::bus::application::ReadRegion{.address = 0, .data = extra}};
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(master.RequestRead(read_regions)),
+            hydrolib::ReturnCode::OVERFLOW);
+
+  std::array<hydrolib::bus::application::WriteRegion,
+             hydrolib::bus::application::kMaxBatchRegions + 1>
+      write_regions{};
+  for (auto& region : write_regions) {
+    region = {.address = 0, .data = extra};
+  }
+  EXPECT_EQ(master.RequestWrite(write_regions),
+            hydrolib::ReturnCode::OVERFLOW);
+  EXPECT_TRUE(stream.IsEmpty());
+}
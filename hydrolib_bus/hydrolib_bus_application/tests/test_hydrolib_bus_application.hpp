@@ -6,6 +6,7 @@
 #include "hydrolib_bus_application_slave.hpp"
 #include "hydrolib_logger_mock.hpp"
 #include "hydrolib_return_codes.hpp"
+#include "mock_clock.hpp"
 #include "mock_stream.hpp"
 
 class TestPublicMemory {
@@ -35,7 +36,8 @@ class TestHydrolibBusApplication
   TestPublicMemory memory{};
 
   hydrolib::bus::application::Master<hydrolib::streams::mock::MockByteStream,
-                                     decltype(hydrolib::logger::mock_logger)>
+                                     decltype(hydrolib::logger::mock_logger), 8,
+                                     hydrolib::streams::mock::TestClock>
       master;
   hydrolib::bus::application::Slave<TestPublicMemory,
                                     decltype(hydrolib::logger::mock_logger),
@@ -0,0 +1,182 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_bus_application_register_cache.hpp"
+#include "hydrolib_bus_application_slave.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "mock_stream.hpp"
+#include "test_hydrolib_bus_application.hpp"
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+using TestClock = hydrolib::streams::mock::TestClock;
+
+class TestHydrolibBusApplicationCache : public TestHydrolibBusApplication {
+ protected:
+  static constexpr auto kFlushWindow = 5ms;
+
+  TestHydrolibBusApplicationCache() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+    TestClock::current_time = {};
+    std::ranges::copy(test_data, memory.memory.begin());
+  }
+
+  // The slave takes one request per Process(), so it runs once per request
+  // the cache has sent.
+  void Cycle(int requests = 1) {
+    cache.Process();
+    stream.MakeAllbytesAvailable();
+    for (int i = 0; i < requests; i++) {
+      slave.Process();
+    }
+    stream.MakeAllbytesAvailable();
+    cache.Process();
+  }
+
+  hydrolib::bus::application::RegisterCache<decltype(master), TestClock> cache{
+      master, kFlushWindow};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusApplicationCache, ServesFreshReadsLocally) {
+  std::array<std::byte, 3> data{};
+  EXPECT_EQ(cache.Read(data, 4, 10ms), hydrolib::ReturnCode::NO_DATA);
+  Cycle();
+  EXPECT_EQ(cache.Read(data, 4, 10ms), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(data[2], memory.memory[6]);
+
+  TestClock::current_time += 8ms;
+  EXPECT_EQ(cache.Read(data, 4, 10ms), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(cache.Read(data, 4, 5ms), hydrolib::ReturnCode::NO_DATA);
+  EXPECT_TRUE(stream.IsEmpty());
+
+  const auto& stats = cache.GetStats();
+  EXPECT_EQ(stats.hits, 2);
+  EXPECT_EQ(stats.misses, 2);
+  EXPECT_EQ(stats.bus_reads, 1);
+  EXPECT_DOUBLE_EQ(stats.GetHitRate(), 0.5);
+}
+
+TEST_F(TestHydrolibBusApplicationCache, CoalescesOverlappingReads) {
+  std::array<std::byte, 4> first{};
+  std::array<std::byte, 4> second{};
+  std::array<std::byte, 2> third{};
+  EXPECT_EQ(cache.Read(first, 0, 10ms), hydrolib::ReturnCode::NO_DATA);
+  EXPECT_EQ(cache.Read(second, 2, 10ms), hydrolib::ReturnCode::NO_DATA);
+  EXPECT_EQ(cache.Read(third, 6, 10ms), hydrolib::ReturnCode::NO_DATA);
+  cache.Process();
+  EXPECT_EQ(cache.Read(second, 3, 10ms), hydrolib::ReturnCode::NO_DATA);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  cache.Process();
+
+  EXPECT_EQ(cache.Read(first, 0, 10ms), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(cache.Read(second, 2, 10ms), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(cache.Read(third, 6, 10ms), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(second[3], memory.memory[5]);
+  EXPECT_EQ(third[1], memory.memory[7]);
+  EXPECT_EQ(cache.GetStats().bus_reads, 1);
+  EXPECT_EQ(cache.GetStats().coalesced_reads, 3);
+}
+
+TEST_F(TestHydrolibBusApplicationCache, MergesWritesWithinFlushWindow) {
+  std::array<std::byte, 2> first{std::byte(0xA1), std::byte(0xA2)};
+  std::array<std::byte, 2> second{std::byte(0xB1), std::byte(0xB2)};
+  std::array<std::byte, 1> third{std::byte(0xC1)};
+  cache.Write(first, 0);
+  cache.Write(second, 2);
+  cache.Write(third, 20);
+
+  cache.Process();
+  EXPECT_TRUE(stream.IsEmpty());
+  TestClock::current_time += kFlushWindow;
+  cache.Process();
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  EXPECT_TRUE(stream.IsEmpty());
+
+  EXPECT_EQ(memory.memory[1], std::byte(0xA2));
+  EXPECT_EQ(memory.memory[2], std::byte(0xB1));
+  EXPECT_EQ(memory.memory[20], std::byte(0xC1));
+  EXPECT_EQ(cache.GetStats().merged_writes, 1);
+  EXPECT_EQ(cache.GetStats().bus_writes, 1);
+}
+
+TEST_F(TestHydrolibBusApplicationCache, WriteWinsOverReadInFlight) {
+  std::array<std::byte, 1> data{};
+  EXPECT_EQ(cache.Read(data, 9, 10ms), hydrolib::ReturnCode::NO_DATA);
+  cache.Process();
+  std::array<std::byte, 1> written{std::byte(0xEE)};
+  cache.Write(written, 9);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  cache.Process();
+
+  EXPECT_EQ(cache.Read(data, 9, 10ms), hydrolib::ReturnCode::NO_DATA);
+  Cycle(2);
+  EXPECT_EQ(cache.Read(data, 9, 10ms), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(data[0], std::byte(0xEE));
+}
+
+TEST_F(TestHydrolibBusApplicationCache, ReadsWrittenRangeBackAfterFlush) {
+  std::array<std::byte, 2> written{std::byte(0xD1), std::byte(0xD2)};
+  cache.Write(written, 12);
+  std::array<std::byte, 4> data{};
+  EXPECT_EQ(cache.Read(data, 11, 10ms), hydrolib::ReturnCode::NO_DATA);
+
+  Cycle(2);
+  EXPECT_EQ(cache.GetStats().bus_writes, 1);
+  EXPECT_EQ(cache.GetStats().bus_reads, 1);
+
+  EXPECT_EQ(cache.Read(data, 11, 10ms), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(data[0], memory.memory[11]);
+  EXPECT_EQ(data[1], std::byte(0xD1));
+  EXPECT_EQ(data[2], std::byte(0xD2));
+}
+
+TEST_F(TestHydrolibBusApplicationCache, FailedFillLeavesOtherFillsIntact) {
+  std::array<std::byte, 2> valid{};
+  std::array<std::byte, 4> invalid{};
+  EXPECT_EQ(cache.Read(valid, 0, 10ms), hydrolib::ReturnCode::NO_DATA);
+  EXPECT_EQ(cache.Read(invalid, TestPublicMemory::kPublicMemoryLength - 2,
+                       10ms),
+            hydrolib::ReturnCode::NO_DATA);
+  Cycle(2);
+  EXPECT_EQ(cache.GetStats().bus_reads, 2);
+
+  EXPECT_EQ(cache.Read(valid, 0, 10ms), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(valid[1], memory.memory[1]);
+  EXPECT_EQ(cache.Read(invalid, TestPublicMemory::kPublicMemoryLength - 2,
+                       10ms),
+            hydrolib::ReturnCode::NO_DATA);
+  EXPECT_EQ(master.GetPendingCount(), 0);
+}
+
+TEST_F(TestHydrolibBusApplicationCache, ReportsHitRateOfSharedPolling) {
+  constexpr int kComponents = 5;
+  constexpr int kCycles = 100;
+  std::array<std::array<std::byte, 4>, kComponents> buffers{};
+  for (int cycle = 0; cycle < kCycles; cycle++) {
+    for (auto& buffer : buffers) {
+      cache.Read(buffer, 8, 10ms);
+    }
+    Cycle();
+    TestClock::current_time += 1ms;
+  }
+  const auto& stats = cache.GetStats();
+  std::cout << "Hit rate: " << stats.GetHitRate()
+            << ", bus reads: " << stats.bus_reads << " for "
+            << kComponents * kCycles << " reads\n";
+  EXPECT_GE(stats.GetHitRate(), 0.9);
+  EXPECT_LE(stats.bus_reads, kCycles / 10 + 1);
+}
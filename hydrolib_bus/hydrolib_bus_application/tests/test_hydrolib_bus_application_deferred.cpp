@@ -0,0 +1,269 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <deque>
+#include <span>
+
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_bus_application_slave.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_stream.hpp"
+
+namespace {
+// Registers below kFastSize live in RAM, the rest sits behind a slow sensor
+// bus where every access takes kLatencyPolls calls of Poll().
+class SensorMemory {
+ public:
+  static constexpr int kSize = 32;
+  static constexpr int kFastSize = 16;
+  static constexpr int kLatencyPolls = 5;
+  // Writes to the sensor registers from here on are refused by the sensor.
+  static constexpr int kReadOnlyAddress = 28;
+
+  hydrolib::ReturnCode Read(std::span<std::byte> buffer, unsigned address) {
+    if (address + buffer.size() > kSize) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    std::copy_n(memory.begin() + address, buffer.size(), buffer.begin());
+    return hydrolib::ReturnCode::OK;
+  }
+
+  hydrolib::ReturnCode Write(std::span<const std::byte> buffer,
+                             unsigned address) {
+    if (address + buffer.size() > kSize) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    std::ranges::copy(buffer, memory.begin() + address);
+    return hydrolib::ReturnCode::OK;
+  }
+
+  hydrolib::ReturnCode BeginRead(std::span<std::byte> buffer,
+                                 unsigned address) {
+    if (address + buffer.size() <= kFastSize) {
+      return Read(buffer, address);
+    }
+    if (address + buffer.size() > kSize) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    accesses_.push_back({.read_buffer = buffer, .address = address});
+    return hydrolib::ReturnCode::NO_DATA;
+  }
+
+  hydrolib::ReturnCode BeginWrite(std::span<const std::byte> buffer,
+                                  unsigned address) {
+    if (address + buffer.size() <= kFastSize) {
+      return Write(buffer, address);
+    }
+    if (address + buffer.size() > kSize) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    Access access{.read_buffer = {},
+                  .address = address,
+                  .write_data = {},
+                  .write_length = static_cast<unsigned>(buffer.size()),
+                  .polls = 0};
+    std::ranges::copy(buffer, access.write_data.begin());
+    accesses_.push_back(access);
+    return hydrolib::ReturnCode::NO_DATA;
+  }
+
+  hydrolib::ReturnCode Poll() {
+    if (accesses_.empty()) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    auto& access = accesses_.front();
+    if (++access.polls < kLatencyPolls) {
+      return hydrolib::ReturnCode::NO_DATA;
+    }
+    auto result = hydrolib::ReturnCode::OK;
+    if (!access.read_buffer.empty()) {
+      result = Read(access.read_buffer, access.address);
+    } else if (access.address + access.write_length > kReadOnlyAddress) {
+      result = hydrolib::ReturnCode::FAIL;
+    } else {
+      result = Write(std::span(access.write_data).first(access.write_length),
+                     access.address);
+    }
+    accesses_.pop_front();
+    return result;
+  }
+
+  [[nodiscard]] bool IsBusy() const { return !accesses_.empty(); }
+
+  std::array<std::byte, kSize> memory{};
+
+ private:
+  struct Access {
+    std::span<std::byte> read_buffer;
+    unsigned address = 0;
+    std::array<std::byte, kSize> write_data{};
+    unsigned write_length = 0;
+    int polls = 0;
+  };
+
+  std::deque<Access> accesses_;
+};
+
+static_assert(hydrolib::bus::application::DeferredMemoryConcept<SensorMemory>);
+
+// Decodes the header of the message starting at offset without consuming it.
+hydrolib::bus::application::MemoryAccessHeader PeekHeader(
+    const hydrolib::streams::mock::MockByteStream& stream,
+    std::size_t offset) {
+  std::array<uint8_t, sizeof(hydrolib::bus::application::MemoryAccessHeader)>
+      bytes{};
+  for (std::size_t i = 0; i < bytes.size(); i++) {
+    bytes[i] = stream[offset + i];
+  }
+  hydrolib::bus::application::MemoryAccessHeader header{};
+  std::memcpy(&header, bytes.data(), sizeof(header));
+  return header;
+}
+
+struct LinkEnd {
+  hydrolib::streams::mock::MockByteStream& rx;
+  hydrolib::streams::mock::MockByteStream& tx;
+};
+
+int read(LinkEnd& end, void* dest, unsigned length) {
+  return read(end.rx, dest, length);
+}
+
+int write(LinkEnd& end, const void* source, unsigned length) {
+  int written = write(end.tx, source, length);
+  end.tx.MakeAllbytesAvailable();
+  return written;
+}
+
+class TestHydrolibBusApplicationDeferred : public ::testing::Test {
+ protected:
+  TestHydrolibBusApplicationDeferred() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+    for (int i = 0; i < SensorMemory::kSize; i++) {
+      memory.memory[i] = static_cast<std::byte>(i + 1);
+    }
+  }
+
+  void Cycle() {
+    slave.Process();
+    while (master.Process() == hydrolib::ReturnCode::OK) {
+    }
+  }
+
+  hydrolib::streams::mock::MockByteStream uplink;
+  hydrolib::streams::mock::MockByteStream downlink;
+  LinkEnd master_end{downlink, uplink};
+  LinkEnd slave_end{uplink, downlink};
+  SensorMemory memory;
+  hydrolib::bus::application::Master<LinkEnd,
+                                     decltype(hydrolib::logger::mock_logger)>
+      master{master_end, hydrolib::logger::mock_logger};
+  hydrolib::bus::application::Slave<
+      SensorMemory, decltype(hydrolib::logger::mock_logger), LinkEnd, 2>
+      slave{slave_end, memory, hydrolib::logger::mock_logger};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusApplicationDeferred, FastReadOvertakesSlowRead) {
+  std::array<std::byte, 4> slow{};
+  std::array<std::byte, 4> fast{};
+  auto slow_id = master.RequestRead(slow, 20);
+  auto fast_id = master.RequestRead(fast, 2);
+
+  Cycle();
+  Cycle();
+  EXPECT_TRUE(master.IsPending(slow_id));
+  EXPECT_FALSE(master.IsPending(fast_id));
+  EXPECT_EQ(fast[0], memory.memory[2]);
+
+  for (int i = 0; i < SensorMemory::kLatencyPolls; i++) {
+    Cycle();
+  }
+  EXPECT_FALSE(master.IsPending(slow_id));
+  EXPECT_EQ(slow[3], memory.memory[23]);
+}
+
+TEST_F(TestHydrolibBusApplicationDeferred, BatchWaitsForAllParts) {
+  std::array<std::byte, 2> first{};
+  std::array<std::byte, 2> second{};
+  std::array<std::byte, 2> third{};
+  std::array<hydrolib::bus::application::ReadRegion, 3> regions{
+      {{.address = 18, .data = first},
+       {.address = 4, .data = second},
+       {.address = 24, .data = third}}};
+  auto id = master.RequestRead(regions);
+
+  for (int i = 0; i < SensorMemory::kLatencyPolls; i++) {
+    Cycle();
+  }
+  EXPECT_TRUE(master.IsPending(id));
+  for (int i = 0; i < SensorMemory::kLatencyPolls; i++) {
+    Cycle();
+  }
+  EXPECT_FALSE(master.IsPending(id));
+  EXPECT_EQ(first[1], memory.memory[19]);
+  EXPECT_EQ(second[0], memory.memory[4]);
+  EXPECT_EQ(third[1], memory.memory[25]);
+}
+
+TEST_F(TestHydrolibBusApplicationDeferred, FailedWriteIsReported) {
+  std::array<std::byte, 2> accepted{std::byte(0xAA), std::byte(0xBB)};
+  std::array<std::byte, 2> refused{std::byte(0xCC), std::byte(0xDD)};
+  master.RequestWrite(accepted, 20);
+  master.RequestWrite(refused, 29);
+  auto refused_offset =
+      sizeof(hydrolib::bus::application::MemoryAccessHeader) + accepted.size();
+  auto refused_id = PeekHeader(uplink, refused_offset).transaction_id;
+  // Writes are not tracked, so a slow read queued behind them keeps the
+  // master listening until the error arrives.
+  std::array<std::byte, 1> probe{};
+  auto probe_id = master.RequestRead(probe, SensorMemory::kFastSize);
+
+  hydrolib::ReturnCode refused_result = hydrolib::ReturnCode::OK;
+  for (int i = 0; i < 3 * SensorMemory::kLatencyPolls + 1; i++) {
+    slave.Process();
+    if (downlink.IsEmpty()) {
+      continue;
+    }
+    auto header = PeekHeader(downlink, 0);
+    auto result = master.Process();
+    if (header.transaction_id == refused_id) {
+      EXPECT_EQ(header.command, hydrolib::bus::application::Command::kError);
+      refused_result = result;
+    }
+  }
+  EXPECT_FALSE(memory.IsBusy());
+  EXPECT_EQ(refused_result, hydrolib::ReturnCode::ERROR);
+  EXPECT_FALSE(master.IsPending(probe_id));
+  EXPECT_EQ(memory.memory[21], std::byte(0xBB));
+  EXPECT_EQ(memory.memory[29], std::byte(30));
+}
+
+TEST_F(TestHydrolibBusApplicationDeferred, FullSlotsHoldBackRequests) {
+  std::array<std::array<std::byte, 1>, 3> slow{};
+  std::array<std::byte, 1> fast{};
+  std::array<hydrolib::bus::application::TransactionId, 3> slow_ids{};
+  for (int i = 0; i < 3; i++) {
+    slow_ids[i] = master.RequestRead(slow[i], 20 + i);
+  }
+  auto fast_id = master.RequestRead(fast, 0);
+
+  for (int i = 0; i < 4; i++) {
+    Cycle();
+  }
+  EXPECT_TRUE(master.IsPending(fast_id));
+
+  for (int i = 0; i < 3 * SensorMemory::kLatencyPolls; i++) {
+    Cycle();
+  }
+  EXPECT_FALSE(master.IsPending(fast_id));
+  for (int i = 0; i < 3; i++) {
+    EXPECT_FALSE(master.IsPending(slow_ids[i]));
+    EXPECT_EQ(slow[i][0], memory.memory[20 + i]);
+  }
+}
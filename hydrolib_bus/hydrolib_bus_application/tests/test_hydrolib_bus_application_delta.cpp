@@ -0,0 +1,177 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <iostream>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_bus_application_public_memory.hpp"
+#include "hydrolib_bus_application_slave.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_stream.hpp"
+#include "test_hydrolib_bus_application.hpp"
+
+namespace {
+template <int kSize, int kBlockSize>
+class TestDeltaSync : public ::testing::Test {
+ protected:
+  using Memory = hydrolib::bus::application::PublicMemory<kSize, kBlockSize>;
+
+  TestDeltaSync() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+    for (int i = 0; i < kSize; i++) {
+      auto byte = static_cast<std::byte>(i);
+      memory.Write(std::span(&byte, 1), i);
+    }
+  }
+
+  // Returns the number of bytes the slave answered with.
+  int Sync() {
+    EXPECT_EQ(
+        static_cast<hydrolib::ReturnCode>(master.RequestChanges(mirror)),
+        hydrolib::ReturnCode::OK);
+    stream.MakeAllbytesAvailable();
+    slave.Process();
+    int response_size = static_cast<int>(stream.GetSize());
+    stream.MakeAllbytesAvailable();
+    EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+    return response_size;
+  }
+
+  void ExpectMirrorEqual() {
+    for (int i = 0; i < kSize; i++) {
+      EXPECT_EQ(mirror[i], memory.GetData()[i]) << "at " << i;
+    }
+  }
+
+  // Syncs until the slave has no more changes. Returns the number of
+  // responses.
+  int SyncAll() {
+    int responses = 0;
+    do {
+      Sync();
+      responses++;
+    } while (master.HasMoreChanges());
+    return responses;
+  }
+
+  // Changes one byte in every other block, so every change is a run of its
+  // own.
+  void DirtySparseBlocks() {
+    for (int address = 0; address < kSize; address += 2 * kBlockSize) {
+      auto byte = static_cast<std::byte>(~address);
+      memory.Write(std::span(&byte, 1), address);
+    }
+  }
+
+  hydrolib::streams::mock::MockByteStream stream;
+  Memory memory;
+  hydrolib::bus::application::Master<hydrolib::streams::mock::MockByteStream,
+                                     decltype(hydrolib::logger::mock_logger)>
+      master{stream, hydrolib::logger::mock_logger};
+  hydrolib::bus::application::Slave<Memory,
+                                    decltype(hydrolib::logger::mock_logger),
+                                    hydrolib::streams::mock::MockByteStream>
+      slave{stream, memory, hydrolib::logger::mock_logger};
+  std::array<std::byte, kSize> mirror{};
+};
+
+using TestHydrolibBusApplicationDelta = TestDeltaSync<64, 4>;
+using TestHydrolibBusApplicationLargeDelta = TestDeltaSync<256, 8>;
+using TestHydrolibBusApplicationByteDelta = TestDeltaSync<256, 1>;
+using TestHydrolibBusApplicationWordDelta = TestDeltaSync<256, 2>;
+}  // namespace
+
+TEST_F(TestHydrolibBusApplicationDelta, TracksDirtyBlocks) {
+  for (int block = 0; block < memory.GetBlocksCount(); block++) {
+    memory.ClearDirty(block);
+  }
+  EXPECT_EQ(memory.FindDirtyBlock(0), memory.GetBlocksCount());
+
+  std::array<std::byte, 3> data{};
+  memory.Write(data, 7);
+  memory.Write(data, 60);
+  EXPECT_EQ(memory.FindDirtyBlock(0), 1);
+  EXPECT_EQ(memory.FindDirtyBlock(2), 2);
+  EXPECT_EQ(memory.FindDirtyBlock(3), 15);
+  EXPECT_EQ(memory.Write(data, 62), hydrolib::ReturnCode::FAIL);
+}
+
+TEST_F(TestHydrolibBusApplicationDelta, TransfersOnlyChangedBlocks) {
+  auto full_size = Sync();
+  ExpectMirrorEqual();
+  EXPECT_FALSE(master.HasMoreChanges());
+
+  EXPECT_EQ(Sync(), sizeof(hydrolib::bus::application::MemoryAccessHeader) +
+                        sizeof(hydrolib::bus::application::ChangesHeader));
+
+  std::array<std::byte, 2> data{std::byte(0xAA), std::byte(0xBB)};
+  memory.Write(data, 31);
+  auto delta_size = Sync();
+  ExpectMirrorEqual();
+  std::cout << "Full sync: " << full_size << " bytes, delta: " << delta_size
+            << " bytes\n";
+  EXPECT_EQ(delta_size,
+            sizeof(hydrolib::bus::application::MemoryAccessHeader) +
+                sizeof(hydrolib::bus::application::ChangesHeader) +
+                sizeof(hydrolib::bus::application::MemoryAccessInfo) + 8);
+}
+
+TEST_F(TestHydrolibBusApplicationDelta, StaleVersionGetsFullMemory) {
+  auto full_size = Sync();
+  hydrolib::bus::application::MemoryAccessMessageBuffer request{};
+  request.header = {
+      .command = hydrolib::bus::application::Command::kReadChanges,
+      .transaction_id = 77,
+      .info = {.address = 0,
+               .length = sizeof(hydrolib::bus::application::ChangesRequest)}};
+  hydrolib::bus::application::ChangesRequest changes{
+      .since_version = static_cast<hydrolib::bus::application::MemoryVersion>(
+          memory.GetVersion() - 1),
+      .is_synced = 1};
+  std::memcpy(request.data, &changes, sizeof(changes));
+  write(stream, &request, sizeof(request.header) + sizeof(changes));
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  EXPECT_EQ(stream.GetSize(), full_size);
+}
+
+TEST_F(TestHydrolibBusApplicationLargeDelta, SplitsChangesAcrossResponses) {
+  EXPECT_GT(SyncAll(), 1);
+  ExpectMirrorEqual();
+
+  std::array<std::byte, 1> data{std::byte(0xCC)};
+  memory.Write(data, 0);
+  memory.Write(data, 255);
+  Sync();
+  EXPECT_FALSE(master.HasMoreChanges());
+  ExpectMirrorEqual();
+}
+
+TEST_F(TestHydrolibBusApplicationByteDelta, SplitsSparseChanges) {
+  SyncAll();
+  DirtySparseBlocks();
+  EXPECT_GT(SyncAll(), 1);
+  ExpectMirrorEqual();
+}
+
+TEST_F(TestHydrolibBusApplicationWordDelta, SplitsSparseChanges) {
+  SyncAll();
+  DirtySparseBlocks();
+  EXPECT_GT(SyncAll(), 1);
+  ExpectMirrorEqual();
+}
+
+TEST_F(TestHydrolibBusApplication, ChangesNeedTrackingMemory) {
+  std::array<std::byte, TestPublicMemory::kPublicMemoryLength> mirror{};
+  master.RequestChanges(mirror);
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(master.RequestChanges(mirror)),
+            hydrolib::ReturnCode::FAIL);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::ERROR);
+  EXPECT_EQ(master.GetPendingCount(), 0);
+}
@@ -0,0 +1,221 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <iostream>
+#include <span>
+#include <utility>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_bus_application_slave.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_stream.hpp"
+#include "test_hydrolib_bus_application.hpp"
+
+namespace {
+// One direction of a simulated link: bytes become readable kLatencyTicks
+// after they were written.
+class DelayLine {
+ public:
+  static constexpr int kLatencyTicks = 10;
+
+  void Write(const std::byte* data, unsigned length) {
+    for (unsigned i = 0; i < length; i++) {
+      bytes_.emplace_back(data[i], tick_ + kLatencyTicks);
+    }
+  }
+
+  int Read(std::byte* data, unsigned length) {
+    unsigned read_length = 0;
+    while (read_length < length && !bytes_.empty() &&
+           bytes_.front().second <= tick_) {
+      data[read_length++] = bytes_.front().first;
+      bytes_.pop_front();
+    }
+    return static_cast<int>(read_length);
+  }
+
+  void Tick() { tick_++; }
+
+ private:
+  std::deque<std::pair<std::byte, int>> bytes_;
+  int tick_ = 0;
+};
+
+struct LinkEnd {
+  DelayLine& rx;
+  DelayLine& tx;
+};
+
+int read(LinkEnd& end, void* dest, unsigned length) {
+  return end.rx.Read(static_cast<std::byte*>(dest), length);
+}
+
+int write(LinkEnd& end, const void* source, unsigned length) {
+  end.tx.Write(static_cast<const std::byte*>(source), length);
+  return static_cast<int>(length);
+}
+
+class TestHydrolibBusApplicationPipeline : public ::testing::Test {
+ protected:
+  TestHydrolibBusApplicationPipeline() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+    for (int i = 0; i < TestPublicMemory::kPublicMemoryLength; i++) {
+      memory.memory[i] = static_cast<std::byte>(i);
+    }
+  }
+
+  // Keeps the window full for kTicks ticks of the simulated link and returns
+  // completed reads per tick.
+  template <int kWindowSize>
+  double RunPipeline() {
+    constexpr int kTicks = 20000;
+    constexpr int kReadLength = 4;
+
+    DelayLine uplink;
+    DelayLine downlink;
+    LinkEnd master_end{downlink, uplink};
+    LinkEnd slave_end{uplink, downlink};
+    hydrolib::bus::application::Master<
+        LinkEnd, decltype(hydrolib::logger::mock_logger), kWindowSize>
+        master(master_end, hydrolib::logger::mock_logger);
+    hydrolib::bus::application::Slave<
+        TestPublicMemory, decltype(hydrolib::logger::mock_logger), LinkEnd>
+        slave(slave_end, memory, hydrolib::logger::mock_logger);
+
+    std::array<std::array<std::byte, kReadLength>, kWindowSize> buffers{};
+    std::array<hydrolib::bus::application::TransactionId, kWindowSize> ids{};
+    std::array<bool, kWindowSize> is_issued{};
+    int completed = 0;
+
+    for (int tick = 0; tick < kTicks; tick++) {
+      for (int i = 0; i < kWindowSize; i++) {
+        if (is_issued[i] && master.IsPending(ids[i])) {
+          continue;
+        }
+        if (is_issued[i]) {
+          EXPECT_EQ(buffers[i][0], memory.memory[i]);
+          completed++;
+        }
+        ids[i] = master.RequestRead(buffers[i], i);
+        is_issued[i] = true;
+      }
+      for (int i = 0; i < kWindowSize; i++) {
+        slave.Process();
+      }
+      while (master.Process() == hydrolib::ReturnCode::OK) {
+      }
+      uplink.Tick();
+      downlink.Tick();
+    }
+    return static_cast<double>(completed) / kTicks;
+  }
+
+  TestPublicMemory memory{};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusApplicationPipeline, ResponsesMatchedOutOfOrder) {
+  hydrolib::streams::mock::MockByteStream master_stream;
+  hydrolib::bus::application::Master<hydrolib::streams::mock::MockByteStream,
+                                     decltype(hydrolib::logger::mock_logger)>
+      master(master_stream, hydrolib::logger::mock_logger);
+
+  std::array<std::byte, 2> first{};
+  std::array<std::byte, 3> second{};
+  auto first_id = master.RequestRead(first, 0);
+  auto second_id = master.RequestRead(second, 10);
+  EXPECT_EQ(master.GetPendingCount(), 2);
+  master_stream.Clear();
+
+  hydrolib::bus::application::MemoryAccessMessageBuffer response{};
+  response.header.command = hydrolib::bus::application::Command::kResponse;
+  response.header.transaction_id = second_id;
+  response.header.info = {.address = 10, .length = 3};
+  response.data[2] = std::byte(7);
+  write(master_stream, &response,
+        sizeof(response.header) + response.header.info.length);
+  response.header.transaction_id = first_id;
+  response.header.info = {.address = 0, .length = 2};
+  response.data[1] = std::byte(5);
+  write(master_stream, &response,
+        sizeof(response.header) + response.header.info.length);
+  master_stream.MakeAllbytesAvailable();
+
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_FALSE(master.IsPending(second_id));
+  EXPECT_TRUE(master.IsPending(first_id));
+  EXPECT_EQ(second[2], std::byte(7));
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(first[1], std::byte(5));
+  EXPECT_EQ(master.GetPendingCount(), 0);
+}
+
+TEST_F(TestHydrolibBusApplicationPipeline, RejectsRequestsBeyondWindow) {
+  hydrolib::streams::mock::MockByteStream stream;
+  hydrolib::bus::application::Master<hydrolib::streams::mock::MockByteStream,
+                                     decltype(hydrolib::logger::mock_logger), 2>
+      master(stream, hydrolib::logger::mock_logger);
+
+  std::array<std::byte, 1> buffer{};
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(master.RequestRead(buffer, 0)),
+            hydrolib::ReturnCode::OK);
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(master.RequestRead(buffer, 1)),
+            hydrolib::ReturnCode::OK);
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(master.RequestRead(buffer, 2)),
+            hydrolib::ReturnCode::OVERFLOW);
+  EXPECT_EQ(master.GetPendingCount(), 2);
+}
+
+TEST_F(TestHydrolibBusApplicationPipeline, SlaveServesQueuedRequests) {
+  hydrolib::streams::mock::MockByteStream stream;
+  hydrolib::bus::application::Master<hydrolib::streams::mock::MockByteStream,
+                                     decltype(hydrolib::logger::mock_logger)>
+      master(stream, hydrolib::logger::mock_logger);
+  hydrolib::bus::application::Slave<TestPublicMemory,
+                                    decltype(hydrolib::logger::mock_logger),
+                                    hydrolib::streams::mock::MockByteStream>
+      slave(stream, memory, hydrolib::logger::mock_logger);
+
+  constexpr int kRequestsCount = 5;
+  std::array<std::array<std::byte, 2>, kRequestsCount> buffers{};
+  std::array<std::byte, 1> written{std::byte(0xEE)};
+  master.RequestWrite(written, 20);
+  for (int i = 0; i < kRequestsCount; i++) {
+    master.RequestRead(buffers[i], i * 2);
+  }
+  stream.MakeAllbytesAvailable();
+  for (int i = 0; i < kRequestsCount + 1; i++) {
+    slave.Process();
+  }
+  stream.MakeAllbytesAvailable();
+  for (int i = 0; i < kRequestsCount; i++) {
+    EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+    EXPECT_EQ(buffers[i][1], memory.memory[i * 2 + 1]);
+  }
+  EXPECT_EQ(memory.memory[20], std::byte(0xEE));
+  EXPECT_TRUE(stream.IsEmpty());
+}
+
+TEST_F(TestHydrolibBusApplicationPipeline, ThroughputScalesWithWindow) {
+  auto window_1 = RunPipeline<1>();
+  auto window_4 = RunPipeline<4>();
+  auto window_16 = RunPipeline<16>();
+
+  // One tick stands for 100 us of link time.
+  constexpr double kTicksPerSecond = 10000;
+  std::cout << "Reads per second (RTT " << 2 * DelayLine::kLatencyTicks
+            << " ticks): window 1: " << window_1 * kTicksPerSecond
+            << ", window 4: " << window_4 * kTicksPerSecond
+            << ", window 16: " << window_16 * kTicksPerSecond << "\n";
+  RecordProperty("window_1", static_cast<int>(window_1 * kTicksPerSecond));
+  RecordProperty("window_4", static_cast<int>(window_4 * kTicksPerSecond));
+  RecordProperty("window_16", static_cast<int>(window_16 * kTicksPerSecond));
+
+  EXPECT_GT(window_4, window_1 * 3.5);
+  EXPECT_GT(window_16, window_1 * 14);
+}
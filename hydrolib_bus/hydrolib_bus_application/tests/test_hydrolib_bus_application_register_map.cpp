@@ -0,0 +1,120 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_bus_application_register_map.hpp"
+#include "hydrolib_bus_application_slave.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_stream.hpp"
+
+namespace {
+using hydrolib::bus::application::Access;
+using hydrolib::bus::application::Register;
+
+struct Speed : Register<int16_t, 0, Access::kReadWrite> {};
+struct Current : Register<uint16_t, 2, Access::kReadOnly> {};
+struct Temperature : Register<float, 4, Access::kReadOnly> {};
+struct Command : Register<uint8_t, 8, Access::kWriteOnly> {};
+// Addresses 9-11 are a gap.
+struct Limit : Register<int32_t, 12> {};
+
+using ThrusterMap =
+    hydrolib::bus::application::RegisterMap<Speed, Current, Temperature,
+                                            Command, Limit>;
+
+struct Overlapping : Register<uint16_t, 3> {};
+
+static_assert(ThrusterMap::kSize == 16);
+static_assert(ThrusterMap::IsLayoutValid());
+static_assert(hydrolib::bus::application::RegisterMap<
+              Speed, Current, Overlapping>::HasOverlaps());
+static_assert(hydrolib::bus::application::PublicMemoryConcept<
+              hydrolib::bus::application::RegisterMemory<ThrusterMap>>);
+
+static_assert(ThrusterMap::IsReadable(0, 8));
+static_assert(!ThrusterMap::IsReadable(6, 3));
+static_assert(!ThrusterMap::IsReadable(10, 4));
+static_assert(ThrusterMap::IsReadable(12, 4));
+static_assert(!ThrusterMap::IsReadable(12, 5));
+static_assert(ThrusterMap::IsWritable(0, 2));
+static_assert(!ThrusterMap::IsWritable(0, 3));
+static_assert(ThrusterMap::IsWritable(8, 1));
+static_assert(!ThrusterMap::IsWritable(16, 0));
+
+class TestHydrolibBusApplicationRegisterMap : public ::testing::Test {
+ protected:
+  TestHydrolibBusApplicationRegisterMap() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+  }
+
+  void Exchange() {
+    stream.MakeAllbytesAvailable();
+    slave.Process();
+    stream.MakeAllbytesAvailable();
+    master.Process();
+  }
+
+  hydrolib::streams::mock::MockByteStream stream;
+  hydrolib::bus::application::RegisterMemory<ThrusterMap> memory;
+  hydrolib::bus::application::Master<hydrolib::streams::mock::MockByteStream,
+                                     decltype(hydrolib::logger::mock_logger)>
+      master{stream, hydrolib::logger::mock_logger};
+  hydrolib::bus::application::Slave<
+      hydrolib::bus::application::RegisterMemory<ThrusterMap>,
+      decltype(hydrolib::logger::mock_logger),
+      hydrolib::streams::mock::MockByteStream>
+      slave{stream, memory, hydrolib::logger::mock_logger};
+  hydrolib::bus::application::RegisterClient<ThrusterMap, decltype(master)>
+      client{master};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusApplicationRegisterMap, TypedReadAndWrite) {
+  memory.Set<Temperature>(36.6F);
+  memory.Set<Current>(1500);
+
+  float temperature = 0;
+  auto id = client.RequestRead<Temperature>(temperature);
+  Exchange();
+  EXPECT_FALSE(master.IsPending(id));
+  EXPECT_FLOAT_EQ(temperature, 36.6F);
+
+  uint16_t current = 0;
+  client.RequestRead<Current>(current);
+  Exchange();
+  EXPECT_EQ(current, 1500);
+
+  client.RequestWrite<Speed>(-300);
+  client.RequestWrite<Limit>(100000);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  slave.Process();
+  EXPECT_EQ(memory.Get<Speed>(), -300);
+  EXPECT_EQ(memory.Get<Limit>(), 100000);
+}
+
+TEST_F(TestHydrolibBusApplicationRegisterMap, RejectsForbiddenAccess) {
+  std::array<std::byte, 2> data{std::byte(1), std::byte(2)};
+  EXPECT_EQ(memory.Write(data, 2), hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(memory.Write(data, 8), hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(memory.Write(data, 10), hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(memory.Write(data, 15), hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(memory.Read(data, 8), hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(memory.Read(data, 200), hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(memory.Get<Current>(), 0);
+
+  std::array<std::byte, 1> command{std::byte(7)};
+  EXPECT_EQ(memory.Write(command, 8), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(memory.Get<Command>(), 7);
+}
+
+TEST_F(TestHydrolibBusApplicationRegisterMap, SlaveAnswersErrorForGap) {
+  std::array<std::byte, 4> data{};
+  auto id = master.RequestRead(data, 9);
+  Exchange();
+  EXPECT_FALSE(master.IsPending(id));
+}
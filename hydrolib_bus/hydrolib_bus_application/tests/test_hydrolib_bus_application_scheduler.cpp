@@ -0,0 +1,299 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <deque>
+#include <iostream>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_bus_application_scheduler.hpp"
+#include "hydrolib_bus_application_slave.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "test_hydrolib_bus_application.hpp"
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+using TestClock = hydrolib::streams::mock::TestClock;
+
+// Half-duplex wire shared by all nodes. A transmission started while another
+// one is still on the wire is a collision; it is delivered after the current
+// one, as if the transceiver waited for the line.
+class SimulatedBus {
+ public:
+  static constexpr auto kByteTime = 10us;
+
+  TestClock::time_point Transmit(unsigned length) {
+    auto now = TestClock::now();
+    if (now < busy_until_) {
+      collisions_++;
+    }
+    auto start = std::max(now, busy_until_);
+    busy_until_ = start + length * kByteTime;
+    busy_time_ += length * kByteTime;
+    return start;
+  }
+
+  [[nodiscard]] int GetCollisions() const { return collisions_; }
+  [[nodiscard]] TestClock::duration GetBusyTime() const { return busy_time_; }
+
+ private:
+  TestClock::time_point busy_until_{};
+  TestClock::duration busy_time_{};
+  int collisions_ = 0;
+};
+
+using Wire = std::deque<std::pair<std::byte, TestClock::time_point>>;
+
+struct BusEnd {
+  SimulatedBus& bus;
+  Wire& rx;
+  Wire& tx;
+};
+
+int read(BusEnd& end, void* dest, unsigned length) {
+  auto* bytes = static_cast<std::byte*>(dest);
+  unsigned read_length = 0;
+  while (read_length < length && !end.rx.empty() &&
+         end.rx.front().second <= TestClock::now()) {
+    bytes[read_length++] = end.rx.front().first;
+    end.rx.pop_front();
+  }
+  return static_cast<int>(read_length);
+}
+
+int write(BusEnd& end, const void* source, unsigned length) {
+  auto start = end.bus.Transmit(length);
+  const auto* bytes = static_cast<const std::byte*>(source);
+  for (unsigned i = 0; i < length; i++) {
+    end.tx.emplace_back(bytes[i], start + (i + 1) * SimulatedBus::kByteTime);
+  }
+  return static_cast<int>(length);
+}
+
+using TestMaster =
+    hydrolib::bus::application::Master<BusEnd,
+                                       decltype(hydrolib::logger::mock_logger),
+                                       1>;
+
+struct Node {
+  explicit Node(SimulatedBus& bus)
+      : master_end{bus, downlink, uplink},
+        slave_end{bus, uplink, downlink},
+        master(master_end, hydrolib::logger::mock_logger),
+        slave(slave_end, memory, hydrolib::logger::mock_logger) {}
+
+  Wire uplink;
+  Wire downlink;
+  BusEnd master_end;
+  BusEnd slave_end;
+  TestPublicMemory memory{};
+  TestMaster master;
+  hydrolib::bus::application::Slave<
+      TestPublicMemory, decltype(hydrolib::logger::mock_logger), BusEnd>
+      slave;
+};
+
+template <std::size_t>
+using Session = TestMaster;
+
+constexpr int kSlavesCount = 12;
+constexpr int kPollLength = 8;
+constexpr auto kTick = 10us;
+
+template <std::size_t... kIndices>
+using TestScheduler =
+    hydrolib::bus::application::PollScheduler<TestClock, kSlavesCount,
+                                              Session<kIndices>...>;
+
+template <std::size_t... kIndices>
+TestScheduler<kIndices...> MakeScheduler(
+    hydrolib::bus::application::SchedulingPolicy policy,
+    std::vector<std::unique_ptr<Node>>& nodes,
+    [[maybe_unused]] std::index_sequence<kIndices...> indices) {
+  return TestScheduler<kIndices...>(policy, 1ms, nodes[kIndices]->master...);
+}
+
+class TestHydrolibBusApplicationScheduler : public ::testing::Test {
+ protected:
+  TestHydrolibBusApplicationScheduler() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+    TestClock::current_time = {};
+    for (int i = 0; i < kSlavesCount; i++) {
+      nodes.push_back(std::make_unique<Node>(bus));
+      for (int j = 0; j < TestPublicMemory::kPublicMemoryLength; j++) {
+        nodes[i]->memory.memory[j] = static_cast<std::byte>(i + j);
+      }
+    }
+  }
+
+  template <typename Scheduler>
+  void Run(Scheduler& scheduler, TestClock::duration duration,
+           int silent_slave = -1) {
+    auto end = TestClock::now() + duration;
+    while (TestClock::now() < end) {
+      scheduler.Process();
+      for (int i = 0; i < kSlavesCount; i++) {
+        if (i != silent_slave) {
+          nodes[i]->slave.Process();
+        }
+      }
+      TestClock::current_time += kTick;
+    }
+  }
+
+  template <typename Scheduler>
+  void Report(const char* name, const Scheduler& scheduler,
+              const std::array<TestClock::duration, kSlavesCount>& periods) {
+    std::cout << name << ": utilization " << scheduler.GetUtilization()
+              << ", wire " << GetWireUtilization() << ", collisions "
+              << bus.GetCollisions() << "\n";
+    for (int i = 0; i < kSlavesCount; i++) {
+      const auto& stats = scheduler.GetPollStats(i);
+      std::cout << "  slave " << i << " period "
+                << std::chrono::duration<double, std::micro>(periods[i]).count()
+                << " us: completed " << stats.completed << ", misses "
+                << stats.deadline_misses << ", jitter mean "
+                << std::chrono::duration<double, std::micro>(
+                       stats.GetMeanJitter())
+                       .count()
+                << " us, max "
+                << std::chrono::duration<double, std::micro>(stats.max_jitter)
+                       .count()
+                << " us\n";
+    }
+  }
+
+  double GetWireUtilization() const {
+    return std::chrono::duration<double>(bus.GetBusyTime()).count() /
+           std::chrono::duration<double>(TestClock::now() -
+                                         TestClock::time_point{})
+               .count();
+  }
+
+  template <typename Scheduler>
+  void AddPolls(Scheduler& scheduler,
+                const std::array<TestClock::duration, kSlavesCount>& periods) {
+    for (int i = 0; i < kSlavesCount; i++) {
+      EXPECT_EQ(static_cast<hydrolib::ReturnCode>(
+                    scheduler.AddPoll(i, buffers[i], i, periods[i])),
+                hydrolib::ReturnCode::OK);
+    }
+  }
+
+  SimulatedBus bus;
+  std::vector<std::unique_ptr<Node>> nodes;
+  std::array<std::array<std::byte, kPollLength>, kSlavesCount> buffers{};
+};
+
+// Thruster ESCs, sensors and housekeeping of the power board.
+constexpr std::array<TestClock::duration, kSlavesCount> kNominalPeriods{
+    2ms, 2ms, 2ms, 2ms, 5ms, 5ms, 5ms, 5ms, 20ms, 20ms, 20ms, 20ms};
+
+// Demands more than the bus can carry.
+constexpr std::array<TestClock::duration, kSlavesCount> kOverloadPeriods{
+    1ms, 1ms, 1ms, 1ms, 2ms, 2ms, 2ms, 2ms, 2ms, 2ms, 2ms, 2ms};
+}  // namespace
+
+TEST_F(TestHydrolibBusApplicationScheduler, MeetsDeadlinesOfFeasiblePlan) {
+  auto scheduler = MakeScheduler(
+      hydrolib::bus::application::SchedulingPolicy::kRateMonotonic, nodes,
+      std::make_index_sequence<kSlavesCount>{});
+  AddPolls(scheduler, kNominalPeriods);
+  Run(scheduler, 1s);
+  Report("Rate monotonic, nominal", scheduler, kNominalPeriods);
+
+  EXPECT_EQ(bus.GetCollisions(), 0);
+  for (int i = 0; i < kSlavesCount; i++) {
+    const auto& stats = scheduler.GetPollStats(i);
+    EXPECT_EQ(stats.deadline_misses, 0);
+    EXPECT_GE(stats.completed, 1s / kNominalPeriods[i] - 1);
+    EXPECT_LT(stats.max_latency, kNominalPeriods[i]);
+    EXPECT_EQ(buffers[i][kPollLength - 1], nodes[i]->memory.memory[i + 7]);
+  }
+}
+
+TEST_F(TestHydrolibBusApplicationScheduler, RateMonotonicProtectsFastPolls) {
+  auto scheduler = MakeScheduler(
+      hydrolib::bus::application::SchedulingPolicy::kRateMonotonic, nodes,
+      std::make_index_sequence<kSlavesCount>{});
+  AddPolls(scheduler, kOverloadPeriods);
+  Run(scheduler, 1s);
+  Report("Rate monotonic, overload", scheduler, kOverloadPeriods);
+
+  EXPECT_EQ(bus.GetCollisions(), 0);
+  EXPECT_GT(scheduler.GetUtilization(), 0.95);
+  int64_t slow_misses = 0;
+  for (int i = 0; i < kSlavesCount; i++) {
+    if (kOverloadPeriods[i] == 1ms) {
+      EXPECT_EQ(scheduler.GetPollStats(i).deadline_misses, 0);
+    } else {
+      slow_misses += scheduler.GetPollStats(i).deadline_misses;
+    }
+  }
+  EXPECT_GT(slow_misses, 0);
+}
+
+TEST_F(TestHydrolibBusApplicationScheduler, RoundRobinSharesOverload) {
+  auto scheduler = MakeScheduler(
+      hydrolib::bus::application::SchedulingPolicy::kRoundRobin, nodes,
+      std::make_index_sequence<kSlavesCount>{});
+  AddPolls(scheduler, kOverloadPeriods);
+  Run(scheduler, 1s);
+  Report("Round robin, overload", scheduler, kOverloadPeriods);
+
+  EXPECT_EQ(bus.GetCollisions(), 0);
+  EXPECT_GT(scheduler.GetUtilization(), 0.95);
+  EXPECT_GT(scheduler.GetPollStats(0).deadline_misses, 0);
+}
+
+TEST_F(TestHydrolibBusApplicationScheduler, SilentSlaveTimesOut) {
+  auto scheduler = MakeScheduler(
+      hydrolib::bus::application::SchedulingPolicy::kRateMonotonic, nodes,
+      std::make_index_sequence<kSlavesCount>{});
+  AddPolls(scheduler, kNominalPeriods);
+  Run(scheduler, 100ms, 4);
+
+  const auto& silent = scheduler.GetPollStats(4);
+  EXPECT_EQ(silent.completed, 0);
+  EXPECT_GT(silent.timeouts, 0);
+  EXPECT_GT(scheduler.GetPollStats(0).completed, 40);
+  EXPECT_EQ(nodes[4]->master.GetPendingCount(), 0);
+}
+
+TEST_F(TestHydrolibBusApplicationScheduler, RejectsWrongPolls) {
+  auto scheduler = MakeScheduler(
+      hydrolib::bus::application::SchedulingPolicy::kRoundRobin, nodes,
+      std::make_index_sequence<kSlavesCount>{});
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(
+                scheduler.AddPoll(kSlavesCount, buffers[0], 0, 1ms)),
+            hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(
+                scheduler.AddPoll(0, buffers[0], 0, 0ms)),
+            hydrolib::ReturnCode::FAIL);
+  AddPolls(scheduler, kNominalPeriods);
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(
+                scheduler.AddPoll(0, buffers[0], 0, 1ms)),
+            hydrolib::ReturnCode::OVERFLOW);
+}
+
+TEST_F(TestHydrolibBusApplicationScheduler, LateResponseIsNotPollError) {
+  auto scheduler = MakeScheduler(
+      hydrolib::bus::application::SchedulingPolicy::kRateMonotonic, nodes,
+      std::make_index_sequence<kSlavesCount>{});
+  AddPolls(scheduler, kNominalPeriods);
+  Run(scheduler, 12ms, 4);
+  EXPECT_GT(scheduler.GetPollStats(4).timeouts, 0);
+  Run(scheduler, 100ms);
+
+  const auto& stats = scheduler.GetPollStats(4);
+  EXPECT_GT(stats.completed, 10);
+  EXPECT_EQ(stats.errors, 0);
+}
@@ -0,0 +1,212 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+
+#include "hydrolib_bus_application_commands.hpp"
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_bus_application_slave.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "mock_stream.hpp"
+#include "test_hydrolib_bus_application.hpp"
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+using TestClock = hydrolib::streams::mock::TestClock;
+
+struct CountingStream {
+  hydrolib::streams::mock::MockByteStream stream;
+  int written_bytes = 0;
+};
+
+int read(CountingStream& counting, void* dest, unsigned length) {
+  return read(counting.stream, dest, length);
+}
+
+int write(CountingStream& counting, const void* source, unsigned length) {
+  counting.written_bytes += static_cast<int>(length);
+  return write(counting.stream, source, length);
+}
+}  // namespace
+
+TEST_F(TestHydrolibBusApplication, SubscribeDeliversInitialValue) {
+  std::ranges::copy(test_data, memory.memory.begin());
+  std::array<std::byte, 3> buffer{};
+  auto id = master.Subscribe(
+      buffer, 5, 0ms, hydrolib::bus::application::SubscriptionMode::kOnChange);
+  ASSERT_EQ(static_cast<hydrolib::ReturnCode>(id), hydrolib::ReturnCode::OK);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+
+  for (int i = 0; i < 3; i++) {
+    EXPECT_EQ(buffer[i], memory.memory[5 + i]);
+  }
+  EXPECT_EQ(master.GetUpdatesCount(id), 1);
+  EXPECT_EQ(master.GetPendingCount(), 0);
+}
+
+TEST_F(TestHydrolibBusApplication, OnChangeSubscriptionPushesChanges) {
+  std::array<std::byte, 2> buffer{};
+  auto id = master.Subscribe(
+      buffer, 10, 0ms, hydrolib::bus::application::SubscriptionMode::kOnChange);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+
+  for (int i = 0; i < 5; i++) {
+    slave.Process();
+  }
+  EXPECT_TRUE(stream.IsEmpty());
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::NO_DATA);
+
+  memory.memory[11] = std::byte(0x42);
+  slave.Process();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::NO_DATA);
+  EXPECT_EQ(buffer[1], std::byte(0x42));
+  EXPECT_EQ(master.GetUpdatesCount(id), 2);
+}
+
+TEST_F(TestHydrolibBusApplication, PeriodicSubscriptionPushesEveryPeriod) {
+  constexpr auto kPeriod = 20ms;
+  TestClock::current_time = {};
+  hydrolib::bus::application::Master<hydrolib::streams::mock::MockByteStream,
+                                     decltype(hydrolib::logger::mock_logger),
+                                     8, TestClock>
+      clocked_master(stream, hydrolib::logger::mock_logger);
+  hydrolib::bus::application::Slave<TestPublicMemory,
+                                    decltype(hydrolib::logger::mock_logger),
+                                    hydrolib::streams::mock::MockByteStream, 4,
+                                    TestClock>
+      clocked_slave(stream, memory, hydrolib::logger::mock_logger);
+
+  std::array<std::byte, 1> buffer{};
+  auto id = clocked_master.Subscribe(
+      buffer, 0, kPeriod,
+      hydrolib::bus::application::SubscriptionMode::kPeriodic);
+  stream.MakeAllbytesAvailable();
+  clocked_slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(clocked_master.Process(), hydrolib::ReturnCode::OK);
+
+  TestClock::current_time += kPeriod - 1ms;
+  clocked_slave.Process();
+  EXPECT_TRUE(stream.IsEmpty());
+
+  TestClock::current_time += 1ms;
+  clocked_slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(clocked_master.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(clocked_master.GetUpdatesCount(id), 2);
+}
+
+TEST_F(TestHydrolibBusApplication, ZeroPeriodSubscriptionIsRefused) {
+  std::array<std::byte, 1> buffer{};
+  auto id = master.Subscribe(
+      buffer, 0, 0ms, hydrolib::bus::application::SubscriptionMode::kPeriodic);
+  ASSERT_EQ(static_cast<hydrolib::ReturnCode>(id), hydrolib::ReturnCode::OK);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::ERROR);
+  EXPECT_EQ(master.GetPendingCount(), 0);
+
+  slave.Process();
+  EXPECT_TRUE(stream.IsEmpty());
+}
+
+TEST_F(TestHydrolibBusApplication, UnsubscribeStopsPushes) {
+  std::array<std::byte, 1> buffer{};
+  auto id = master.Subscribe(
+      buffer, 0, 0ms, hydrolib::bus::application::SubscriptionMode::kOnChange);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::OK);
+
+  EXPECT_EQ(master.Unsubscribe(id), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(master.Unsubscribe(id), hydrolib::ReturnCode::FAIL);
+  stream.MakeAllbytesAvailable();
+  slave.Process();
+  memory.memory[0] = std::byte(0x42);
+  slave.Process();
+  EXPECT_TRUE(stream.IsEmpty());
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::FAIL);
+}
+
+TEST_F(TestHydrolibBusApplication, UnknownPublishIsUnsubscribed) {
+  std::array<std::byte, 1> buffer{};
+  master.RequestRead(buffer, 0);
+  stream.Clear();
+
+  hydrolib::bus::application::MemoryAccessMessageBuffer publish{};
+  publish.header = {
+      .command = hydrolib::bus::application::Command::kPublish,
+      .transaction_id = 100,
+      .info = {.address = 0, .length = 1}};
+  write(stream, &publish, sizeof(publish.header) + 1);
+  stream.MakeAllbytesAvailable();
+  EXPECT_EQ(master.Process(), hydrolib::ReturnCode::ERROR);
+
+  hydrolib::bus::application::MemoryAccessHeader unsubscribe{};
+  stream.MakeAllbytesAvailable();
+  ASSERT_EQ(read(stream, &unsubscribe, sizeof(unsubscribe)),
+            sizeof(unsubscribe));
+  EXPECT_EQ(unsubscribe.command,
+            hydrolib::bus::application::Command::kUnsubscribe);
+  EXPECT_EQ(unsubscribe.transaction_id, 100);
+}
+
+TEST_F(TestHydrolibBusApplication, SubscriptionReducesLinkUsage) {
+  constexpr int kCycles = 100;
+  constexpr int kChangePeriod = 20;
+  constexpr int kLength = 8;
+
+  auto run = [this](bool is_polling) {
+    CountingStream link;
+    hydrolib::bus::application::Master<CountingStream,
+                                       decltype(hydrolib::logger::mock_logger)>
+        link_master(link, hydrolib::logger::mock_logger);
+    hydrolib::bus::application::Slave<TestPublicMemory,
+                                      decltype(hydrolib::logger::mock_logger),
+                                      CountingStream>
+        link_slave(link, memory, hydrolib::logger::mock_logger);
+    std::array<std::byte, kLength> buffer{};
+
+    if (!is_polling) {
+      link_master.Subscribe(
+          buffer, 0, 0ms,
+          hydrolib::bus::application::SubscriptionMode::kOnChange);
+    }
+    for (int cycle = 0; cycle < kCycles; cycle++) {
+      if (cycle % kChangePeriod == 0) {
+        memory.memory[0] = static_cast<std::byte>(cycle);
+      }
+      if (is_polling) {
+        link_master.RequestRead(buffer, 0);
+      }
+      link.stream.MakeAllbytesAvailable();
+      link_slave.Process();
+      link.stream.MakeAllbytesAvailable();
+      while (link_master.Process() == hydrolib::ReturnCode::OK) {
+      }
+      EXPECT_EQ(buffer[0], memory.memory[0]);
+    }
+    return link.written_bytes;
+  };
+
+  auto polling_bytes = run(true);
+  auto subscription_bytes = run(false);
+  std::cout << "Bytes on link: polling " << polling_bytes << ", subscription "
+            << subscription_bytes << "\n";
+  EXPECT_LT(subscription_bytes * 10, polling_bytes);
+}
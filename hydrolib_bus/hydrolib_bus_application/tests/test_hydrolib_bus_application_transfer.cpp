@@ -0,0 +1,396 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <iostream>
+#include <span>
+#include <utility>
+#include <vector>
+
+#include "hydrolib_bus_application_master.hpp"
+#include "hydrolib_bus_application_slave.hpp"
+#include "hydrolib_bus_datalink_stream.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "mock_stream.hpp"
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+// Registers for plain reads plus two blobs: an onboard log to download and a
+// calibration table to upload.
+class BlobMemory {
+ public:
+  static constexpr int kRegistersLength = 256;
+  static constexpr uint8_t kLogBlob = 0;
+  static constexpr uint8_t kCalibrationBlob = 1;
+
+  hydrolib::ReturnCode Read(std::span<std::byte> buffer, unsigned address) {
+    if (address + buffer.size() > kRegistersLength) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    std::copy_n(registers.begin() + address, buffer.size(), buffer.begin());
+    return hydrolib::ReturnCode::OK;
+  }
+
+  hydrolib::ReturnCode Write(std::span<const std::byte> buffer,
+                             unsigned address) {
+    if (address + buffer.size() > kRegistersLength) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    std::ranges::copy(buffer, registers.begin() + address);
+    return hydrolib::ReturnCode::OK;
+  }
+
+  hydrolib::Expected<uint32_t> GetBlobSize(uint8_t blob_id) {
+    if (blob_id >= blobs.size()) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    return static_cast<uint32_t>(blobs[blob_id].size());
+  }
+
+  hydrolib::ReturnCode ReadBlob(uint8_t blob_id, uint32_t offset,
+                                std::span<std::byte> buffer) {
+    if (blob_id >= blobs.size() ||
+        offset + buffer.size() > blobs[blob_id].size()) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    std::copy_n(blobs[blob_id].begin() + offset, buffer.size(),
+                buffer.begin());
+    return hydrolib::ReturnCode::OK;
+  }
+
+  hydrolib::ReturnCode WriteBlob(uint8_t blob_id, uint32_t offset,
+                                 std::span<const std::byte> buffer) {
+    if (blob_id >= blobs.size() ||
+        offset + buffer.size() > blobs[blob_id].size()) {
+      return hydrolib::ReturnCode::FAIL;
+    }
+    std::ranges::copy(buffer, blobs[blob_id].begin() + offset);
+    return hydrolib::ReturnCode::OK;
+  }
+
+  std::array<std::byte, kRegistersLength> registers{};
+  std::array<std::vector<std::byte>, 2> blobs;
+};
+
+static_assert(hydrolib::bus::application::BlobStorageConcept<BlobMemory>);
+
+using TestClock = hydrolib::streams::mock::TestClock;
+
+// The wire carries 100 kB/s, link time is counted in its byte times.
+constexpr auto kByteTime = 10us;
+constexpr int64_t kLatency = 2000;
+constexpr int64_t kStep = 16;
+constexpr uint32_t kBlobSize = 1 << 20;
+
+int64_t GetByteTime() {
+  return (TestClock::now() - TestClock::time_point{}) / kByteTime;
+}
+
+// One direction of a full-duplex serial link: a byte per byte time, each
+// delivered kLatency byte times after it was sent.
+struct Channel {
+  std::deque<std::pair<std::byte, int64_t>> bytes;
+  int64_t busy_until = 0;
+  int64_t sent = 0;
+};
+
+// Messages written while the link is down are lost as a whole.
+struct LinkEnd {
+  Channel& rx;
+  Channel& tx;
+  const bool& is_down;
+};
+
+int read(LinkEnd& end, void* dest, unsigned length) {
+  auto* bytes = static_cast<std::byte*>(dest);
+  unsigned read_length = 0;
+  while (read_length < length && !end.rx.bytes.empty() &&
+         end.rx.bytes.front().second <= GetByteTime()) {
+    bytes[read_length++] = end.rx.bytes.front().first;
+    end.rx.bytes.pop_front();
+  }
+  return static_cast<int>(read_length);
+}
+
+int write(LinkEnd& end, const void* source, unsigned length) {
+  if (end.is_down) {
+    return static_cast<int>(length);
+  }
+  auto start = std::max(GetByteTime(), end.tx.busy_until);
+  const auto* bytes = static_cast<const std::byte*>(source);
+  for (unsigned i = 0; i < length; i++) {
+    end.tx.bytes.emplace_back(bytes[i], start + i + 1 + kLatency);
+  }
+  end.tx.busy_until = start + length;
+  end.tx.sent += length;
+  return static_cast<int>(length);
+}
+
+std::vector<std::byte> MakeBlob(uint32_t size) {
+  std::vector<std::byte> blob(size);
+  for (uint32_t i = 0; i < size; i++) {
+    blob[i] = static_cast<std::byte>((i * 7) ^ (i >> 8));
+  }
+  return blob;
+}
+
+class TestHydrolibBusApplicationTransfer : public ::testing::Test {
+ protected:
+  TestHydrolibBusApplicationTransfer() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+    memory.blobs[BlobMemory::kLogBlob] = MakeBlob(kBlobSize);
+    memory.blobs[BlobMemory::kCalibrationBlob].resize(kBlobSize / 16);
+    TestClock::current_time = {};
+  }
+
+  void Step() {
+    slave.Process();
+    while (master.Process() == hydrolib::ReturnCode::OK) {
+    }
+    TestClock::current_time += kStep * kByteTime;
+  }
+
+  void RunTransfer() {
+    while (master.GetTransferStatus() == hydrolib::ReturnCode::NO_DATA) {
+      Step();
+    }
+  }
+
+  void Report(const char* name, uint32_t bytes, int64_t duration) const {
+    std::cout << name << ": " << bytes << " bytes in " << duration
+              << " byte times, " << 100.0 * bytes / duration
+              << "% of the wire\n";
+  }
+
+  bool is_down = false;
+  Channel uplink;
+  Channel downlink;
+  LinkEnd master_end{downlink, uplink, is_down};
+  LinkEnd slave_end{uplink, downlink, is_down};
+  BlobMemory memory;
+  hydrolib::bus::application::Master<
+      LinkEnd, decltype(hydrolib::logger::mock_logger), 8, TestClock>
+      master{master_end, hydrolib::logger::mock_logger};
+  hydrolib::bus::application::Slave<
+      BlobMemory, decltype(hydrolib::logger::mock_logger), LinkEnd>
+      slave{slave_end, memory, hydrolib::logger::mock_logger};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusApplicationTransfer, DownloadsBlobAtWireSpeed) {
+  std::vector<std::byte> log(kBlobSize);
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(
+                master.RequestDownload(BlobMemory::kLogBlob, log)),
+            hydrolib::ReturnCode::OK);
+  RunTransfer();
+  Report("Download", kBlobSize, GetByteTime());
+
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(master.GetTransferredBytes(), kBlobSize);
+  EXPECT_EQ(log, memory.blobs[BlobMemory::kLogBlob]);
+  EXPECT_GT(static_cast<double>(kBlobSize) / GetByteTime(), 0.9);
+}
+
+TEST_F(TestHydrolibBusApplicationTransfer, UploadsBlob) {
+  auto calibration = MakeBlob(kBlobSize / 16);
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(master.RequestUpload(
+                BlobMemory::kCalibrationBlob, calibration)),
+            hydrolib::ReturnCode::OK);
+  RunTransfer();
+  Report("Upload", calibration.size(), GetByteTime());
+
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(memory.blobs[BlobMemory::kCalibrationBlob], calibration);
+}
+
+TEST_F(TestHydrolibBusApplicationTransfer, ResumesAfterLinkDrop) {
+  std::vector<std::byte> log(kBlobSize);
+  master.RequestDownload(BlobMemory::kLogBlob, log);
+  while (master.GetTransferredBytes() < kBlobSize / 2) {
+    Step();
+  }
+  is_down = true;
+  for (int i = 0; i < 1000; i++) {
+    Step();
+  }
+  is_down = false;
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::NO_DATA);
+
+  EXPECT_EQ(static_cast<hydrolib::ReturnCode>(master.ResumeTransfer()),
+            hydrolib::ReturnCode::OK);
+  RunTransfer();
+
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(log, memory.blobs[BlobMemory::kLogBlob]);
+  EXPECT_LT(downlink.sent, kBlobSize * 1.2);
+}
+
+TEST_F(TestHydrolibBusApplicationTransfer, RecoversFromStallWithoutResume) {
+  std::vector<std::byte> log(kBlobSize / 8);
+  memory.blobs[BlobMemory::kLogBlob].resize(log.size());
+  master.RequestDownload(BlobMemory::kLogBlob, log);
+  while (master.GetTransferredBytes() < log.size() / 2) {
+    Step();
+  }
+  is_down = true;
+  for (int i = 0; i < 1000; i++) {
+    Step();
+  }
+  is_down = false;
+  RunTransfer();
+
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(log, memory.blobs[BlobMemory::kLogBlob]);
+}
+
+TEST_F(TestHydrolibBusApplicationTransfer, RefusesUnknownBlob) {
+  std::vector<std::byte> log(kBlobSize);
+  master.RequestDownload(7, log);
+  RunTransfer();
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::ERROR);
+}
+
+TEST_F(TestHydrolibBusApplicationTransfer, RefusesTooSmallDestination) {
+  std::vector<std::byte> log(kBlobSize / 2);
+  master.RequestDownload(BlobMemory::kLogBlob, log);
+  RunTransfer();
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::OVERFLOW);
+}
+
+TEST_F(TestHydrolibBusApplicationTransfer, OutperformsChunkedReads) {
+  constexpr uint32_t kLength = kBlobSize / 8;
+  constexpr unsigned kReadLength = hydrolib::bus::application::kMaxDataLength;
+  std::array<std::byte, kReadLength> chunk{};
+  uint32_t read_bytes = 0;
+  while (read_bytes < kLength) {
+    auto id = master.RequestRead(chunk, 0);
+    while (master.IsPending(id)) {
+      Step();
+    }
+    read_bytes += kReadLength;
+  }
+  auto read_duration = GetByteTime();
+  Report("Chunked reads", read_bytes, read_duration);
+
+  std::vector<std::byte> log(kLength);
+  memory.blobs[BlobMemory::kLogBlob].resize(kLength);
+  auto start = GetByteTime();
+  master.RequestDownload(BlobMemory::kLogBlob, log);
+  RunTransfer();
+  auto transfer_duration = GetByteTime() - start;
+  Report("Block transfer", kLength, transfer_duration);
+
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::OK);
+  double read_throughput = static_cast<double>(read_bytes) / read_duration;
+  double transfer_throughput =
+      static_cast<double>(kLength) / transfer_duration;
+  EXPECT_GT(transfer_throughput, 5 * read_throughput);
+}
+
+namespace {
+constexpr hydrolib::bus::datalink::AddressType kMasterAddress = std::byte(1);
+constexpr hydrolib::bus::datalink::AddressType kSlaveAddress = std::byte(2);
+
+struct SerialEnd {
+  hydrolib::streams::mock::MockByteStream& rx;
+  hydrolib::streams::mock::MockByteStream& tx;
+};
+
+int read(SerialEnd& end, void* dest, unsigned length) {
+  return read(end.rx, dest, length);
+}
+
+int write(SerialEnd& end, const void* source, unsigned length) {
+  int written = write(end.tx, source, length);
+  end.tx.MakeAllbytesAvailable();
+  return written;
+}
+
+using MasterLink = hydrolib::bus::datalink::SequencedStreamManager<
+    SerialEnd, decltype(hydrolib::logger::mock_logger), TestClock,
+    kSlaveAddress>;
+using SlaveLink = hydrolib::bus::datalink::SequencedStreamManager<
+    SerialEnd, decltype(hydrolib::logger::mock_logger), TestClock,
+    kMasterAddress>;
+
+static_assert(sizeof(hydrolib::bus::application::MemoryAccessHeader) +
+                  sizeof(hydrolib::bus::application::ChunkHeader) +
+                  hydrolib::bus::application::kChunkSize <=
+              hydrolib::bus::datalink::kMaxDataLength -
+                  sizeof(hydrolib::bus::datalink::SequenceHeader));
+
+class TestHydrolibBusApplicationTransferOverDatalink : public ::testing::Test {
+ protected:
+  TestHydrolibBusApplicationTransferOverDatalink() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+    memory.blobs[BlobMemory::kLogBlob] = MakeBlob(kBlobSize / 16);
+    memory.blobs[BlobMemory::kCalibrationBlob].resize(kBlobSize / 64);
+  }
+
+  // Every frame is handed to the application before the next one arrives, the
+  // datalink mailboxes hold a single frame.
+  void Step() {
+    while (slave_link.Process() == hydrolib::ReturnCode::OK) {
+      slave.Process();
+    }
+    slave.Process();
+    while (master_link.Process() == hydrolib::ReturnCode::OK) {
+      while (master.Process() == hydrolib::ReturnCode::OK) {
+      }
+    }
+  }
+
+  void RunTransfer() {
+    for (int i = 0;
+         i < 100000 &&
+         master.GetTransferStatus() == hydrolib::ReturnCode::NO_DATA;
+         i++) {
+      Step();
+    }
+  }
+
+  hydrolib::streams::mock::MockByteStream uplink;
+  hydrolib::streams::mock::MockByteStream downlink;
+  SerialEnd master_end{downlink, uplink};
+  SerialEnd slave_end{uplink, downlink};
+  MasterLink master_link{kMasterAddress, master_end,
+                         hydrolib::logger::mock_logger};
+  SlaveLink slave_link{kSlaveAddress, slave_end, hydrolib::logger::mock_logger};
+  MasterLink::Stream<kSlaveAddress> master_stream{master_link};
+  SlaveLink::Stream<kMasterAddress> slave_stream{slave_link};
+  BlobMemory memory;
+  hydrolib::bus::application::Master<MasterLink::Stream<kSlaveAddress>,
+                                     decltype(hydrolib::logger::mock_logger)>
+      master{master_stream, hydrolib::logger::mock_logger};
+  hydrolib::bus::application::Slave<BlobMemory,
+                                    decltype(hydrolib::logger::mock_logger),
+                                    SlaveLink::Stream<kMasterAddress>>
+      slave{slave_stream, memory, hydrolib::logger::mock_logger};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusApplicationTransferOverDatalink, DownloadsBlob) {
+  std::vector<std::byte> log(kBlobSize / 16);
+  master.RequestDownload(BlobMemory::kLogBlob, log);
+  RunTransfer();
+
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(log, memory.blobs[BlobMemory::kLogBlob]);
+}
+
+TEST_F(TestHydrolibBusApplicationTransferOverDatalink, UploadsBlob) {
+  auto calibration = MakeBlob(kBlobSize / 64);
+  master.RequestUpload(BlobMemory::kCalibrationBlob, calibration);
+  RunTransfer();
+
+  EXPECT_EQ(master.GetTransferStatus(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(memory.blobs[BlobMemory::kCalibrationBlob], calibration);
+}
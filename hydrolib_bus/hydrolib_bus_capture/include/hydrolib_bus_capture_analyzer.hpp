@@ -0,0 +1,209 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "hydrolib_bus_capture_format.hpp"
+#include "hydrolib_bus_capture_replay.hpp"
+#include "hydrolib_bus_datalink_frame_decoder.hpp"
+#include "hydrolib_bus_datalink_frame_reader.hpp"
+#include "hydrolib_bus_datalink_message.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::bus::capture {
+// Runs the datalink frame reader over a recorded byte stream and collects
+// per-source statistics, error classes and throughput over time. A frame whose
+// timestamp lies more than kMaxThroughputBins bins after the first frame is
+// counted as a bad timestamp and left out of the statistics.
+template <typename Logger>
+class Analyzer final {
+ public:
+  struct AddressStats {
+    int64_t frames = 0;
+    int64_t bytes = 0;
+    std::chrono::nanoseconds first_time{};
+    std::chrono::nanoseconds last_time{};
+    std::chrono::nanoseconds max_interval{};
+    double mean_interval_ns = 0;
+    double interval_m2 = 0;
+
+    [[nodiscard]] double GetFrameRate() const;
+    [[nodiscard]] double GetJitterNs() const;
+  };
+
+  struct ErrorStats {
+    int64_t rubbish_bytes = 0;
+    int64_t wrong_length = 0;
+    int64_t cobs_errors = 0;
+    int64_t crc_errors = 0;
+    int64_t bad_timestamps = 0;
+  };
+
+  static constexpr int64_t kMaxThroughputBins = 1 << 16;
+
+  Analyzer(std::span<const std::byte> capture, Logger& logger,
+           std::chrono::nanoseconds bin_width, Direction direction,
+           uint8_t channel = 0);
+  Analyzer(const Analyzer&) = delete;
+  Analyzer(Analyzer&&) = delete;
+  Analyzer& operator=(const Analyzer&) = delete;
+  Analyzer& operator=(Analyzer&&) = delete;
+  ~Analyzer() = default;
+
+  ReturnCode Run();
+
+  [[nodiscard]] const AddressStats& GetAddressStats(
+      datalink::AddressType address) const;
+  [[nodiscard]] const ErrorStats& GetErrorStats() const;
+  [[nodiscard]] int64_t GetFrames() const;
+  [[nodiscard]] std::span<const int64_t> GetThroughput() const;
+  [[nodiscard]] std::chrono::nanoseconds GetBinWidth() const;
+
+ private:
+  static constexpr int kAddressesCount = 256;
+
+  void Account(const datalink::MessageBuffer& frame,
+               std::chrono::nanoseconds time);
+
+  Logger& logger_;
+  ReplayStream replay_;
+  datalink::FrameReader<ReplayStream, Logger> reader_;
+
+  const std::chrono::nanoseconds bin_width_;
+  std::chrono::nanoseconds start_time_{};
+
+  int64_t frames_ = 0;
+  std::array<AddressStats, kAddressesCount> address_stats_{};
+  ErrorStats error_stats_;
+  std::vector<int64_t> throughput_;
+};
+
+template <typename Logger>
+double Analyzer<Logger>::AddressStats::GetFrameRate() const {
+  if (frames < 2 || last_time == first_time) {
+    return 0;
+  }
+  return static_cast<double>(frames - 1) /
+         std::chrono::duration<double>(last_time - first_time).count();
+}
+
+template <typename Logger>
+double Analyzer<Logger>::AddressStats::GetJitterNs() const {
+  if (frames < 3) {
+    return 0;
+  }
+  return std::sqrt(interval_m2 / static_cast<double>(frames - 2));
+}
+
+template <typename Logger>
+Analyzer<Logger>::Analyzer(std::span<const std::byte> capture, Logger& logger,
+                           std::chrono::nanoseconds bin_width,
+                           Direction direction, uint8_t channel)
+    : logger_(logger),
+      replay_(capture, direction, channel),
+      reader_(replay_, logger),
+      bin_width_(bin_width) {}
+
+template <typename Logger>
+ReturnCode Analyzer<Logger>::Run() {
+  if (!replay_.IsValid()) {
+    return ReturnCode::FAIL;
+  }
+  while (true) {
+    auto result = reader_.Process();
+    if (result == ReturnCode::OK) {
+      Account(reader_.GetFrame(), replay_.GetTimestamp());
+    } else if (result == ReturnCode::FAIL) {
+      error_stats_.wrong_length++;
+    } else if (result == ReturnCode::NO_DATA) {
+      break;
+    } else {
+      return result;
+    }
+  }
+  error_stats_.rubbish_bytes = reader_.GetRubbishBytes();
+  return ReturnCode::OK;
+}
+
+template <typename Logger>
+const typename Analyzer<Logger>::AddressStats&
+Analyzer<Logger>::GetAddressStats(datalink::AddressType address) const {
+  return address_stats_[static_cast<std::size_t>(address)];
+}
+
+template <typename Logger>
+const typename Analyzer<Logger>::ErrorStats& Analyzer<Logger>::GetErrorStats()
+    const {
+  return error_stats_;
+}
+
+template <typename Logger>
+int64_t Analyzer<Logger>::GetFrames() const {
+  return frames_;
+}
+
+template <typename Logger>
+std::span<const int64_t> Analyzer<Logger>::GetThroughput() const {
+  return throughput_;
+}
+
+template <typename Logger>
+std::chrono::nanoseconds Analyzer<Logger>::GetBinWidth() const {
+  return bin_width_;
+}
+
+template <typename Logger>
+void Analyzer<Logger>::Account(const datalink::MessageBuffer& frame,
+                               std::chrono::nanoseconds time) {
+  datalink::MessageInfo message;
+  auto error = datalink::DecodeFrame(frame, message, logger_);
+  if (error == datalink::FrameError::kCobs) {
+    error_stats_.cobs_errors++;
+    return;
+  }
+  if (error == datalink::FrameError::kCrc) {
+    error_stats_.crc_errors++;
+    return;
+  }
+
+  if (frames_ > 0 && time > start_time_ &&
+      (time - start_time_) / bin_width_ >= kMaxThroughputBins) {
+    error_stats_.bad_timestamps++;
+    return;
+  }
+  if (frames_ == 0) {
+    start_time_ = time;
+  }
+  frames_++;
+
+  auto& stats = address_stats_[static_cast<std::size_t>(message.src_address)];
+  if (stats.frames == 0) {
+    stats.first_time = time;
+  } else {
+    auto interval = time - stats.last_time;
+    if (interval > stats.max_interval) {
+      stats.max_interval = interval;
+    }
+    auto intervals_count = static_cast<double>(stats.frames);
+    auto interval_ns = static_cast<double>(interval.count());
+    auto delta = interval_ns - stats.mean_interval_ns;
+    stats.mean_interval_ns += delta / intervals_count;
+    stats.interval_m2 += delta * (interval_ns - stats.mean_interval_ns);
+  }
+  stats.last_time = time;
+  stats.frames++;
+  stats.bytes += frame.header.length;
+
+  auto bin = time > start_time_ ? (time - start_time_) / bin_width_ : 0;
+  if (static_cast<std::size_t>(bin) >= throughput_.size()) {
+    throughput_.resize(bin + 1, 0);
+  }
+  throughput_[bin] += frame.header.length;
+}
+
+}  // namespace hydrolib::bus::capture
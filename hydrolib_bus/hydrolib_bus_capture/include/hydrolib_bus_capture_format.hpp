@@ -0,0 +1,31 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hydrolib::bus::capture {
+
+// A capture file is a CaptureFileHeader followed by records appended one after
+// another: a CaptureRecordHeader and then `length` raw bytes. All fields are
+// little-endian and unaligned, so a file can be mapped and walked in place;
+// a truncated last record is ignored.
+enum class Direction : uint8_t { kRx, kTx };
+
+struct CaptureFileHeader {
+  char magic[4];  // NOLINT
+  uint16_t version;
+  uint16_t reserved;
+} __attribute__((__packed__));
+
+struct CaptureRecordHeader {
+  uint64_t timestamp_ns;
+  uint16_t length;
+  Direction direction;
+  uint8_t channel;
+} __attribute__((__packed__));
+
+constexpr CaptureFileHeader kCaptureFileHeader{
+    .magic = {'H', 'L', 'C', 'P'}, .version = 1, .reserved = 0};
+
+constexpr int kMaxRecordLength = UINT16_MAX;
+
+}  // namespace hydrolib::bus::capture
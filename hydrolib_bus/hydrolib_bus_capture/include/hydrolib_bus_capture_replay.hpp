@@ -0,0 +1,124 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+
+#include "hydrolib_bus_capture_format.hpp"
+
+namespace hydrolib::bus::capture {
+// Plays back the bytes of one direction and channel of a capture held in
+// memory (typically a mapped file). Reads return the recorded bytes as fast as
+// they are requested; writes are accepted and discarded.
+class ReplayStream final {
+ public:
+  explicit ReplayStream(std::span<const std::byte> capture,
+                        Direction direction = Direction::kRx,
+                        uint8_t channel = 0);
+  ReplayStream(const ReplayStream&) = delete;
+  ReplayStream(ReplayStream&&) = delete;
+  ReplayStream& operator=(const ReplayStream&) = delete;
+  ReplayStream& operator=(ReplayStream&&) = delete;
+  ~ReplayStream() = default;
+
+  [[nodiscard]] bool IsValid() const;
+  [[nodiscard]] bool IsFinished() const;
+  [[nodiscard]] std::chrono::nanoseconds GetTimestamp() const;
+
+  int Read(std::span<std::byte> buffer);
+  int Write(std::span<const std::byte> data);
+
+ private:
+  bool NextRecord();
+
+  std::span<const std::byte> capture_;
+  const Direction direction_;
+  const uint8_t channel_;
+
+  bool is_valid_ = false;
+  std::size_t position_ = sizeof(CaptureFileHeader);
+  std::span<const std::byte> current_record_;
+  std::chrono::nanoseconds timestamp_{};
+};
+
+int read(ReplayStream& stream, void* dest, unsigned length);
+int write(ReplayStream& stream, const void* source, unsigned length);
+
+inline ReplayStream::ReplayStream(std::span<const std::byte> capture,
+                                  Direction direction, uint8_t channel)
+    : capture_(capture), direction_(direction), channel_(channel) {
+  CaptureFileHeader header{};
+  if (capture_.size() < sizeof(header)) {
+    return;
+  }
+  std::memcpy(&header, capture_.data(), sizeof(header));
+  is_valid_ = std::equal(std::begin(header.magic), std::end(header.magic),
+                         std::begin(kCaptureFileHeader.magic)) &&
+              header.version == kCaptureFileHeader.version;
+}
+
+inline bool ReplayStream::IsValid() const { return is_valid_; }
+
+inline bool ReplayStream::IsFinished() const {
+  return current_record_.empty() &&
+         position_ + sizeof(CaptureRecordHeader) > capture_.size();
+}
+
+inline std::chrono::nanoseconds ReplayStream::GetTimestamp() const {
+  return timestamp_;
+}
+
+inline int ReplayStream::Read(std::span<std::byte> buffer) {
+  if (!is_valid_) {
+    return -1;
+  }
+  std::size_t read_length = 0;
+  while (read_length < buffer.size()) {
+    if (current_record_.empty() && !NextRecord()) {
+      break;
+    }
+    auto length =
+        std::min(buffer.size() - read_length, current_record_.size());
+    std::memcpy(buffer.data() + read_length, current_record_.data(), length);
+    current_record_ = current_record_.subspan(length);
+    read_length += length;
+  }
+  return static_cast<int>(read_length);
+}
+
+inline int ReplayStream::Write(std::span<const std::byte> data) {
+  return static_cast<int>(data.size());
+}
+
+inline bool ReplayStream::NextRecord() {
+  while (position_ + sizeof(CaptureRecordHeader) <= capture_.size()) {
+    CaptureRecordHeader header{};
+    std::memcpy(&header, capture_.data() + position_, sizeof(header));
+    auto payload_position = position_ + sizeof(header);
+    if (payload_position + header.length > capture_.size()) {
+      position_ = capture_.size();
+      return false;
+    }
+    position_ = payload_position + header.length;
+    if (header.direction == direction_ && header.channel == channel_ &&
+        header.length != 0) {
+      current_record_ = capture_.subspan(payload_position, header.length);
+      timestamp_ = std::chrono::nanoseconds(header.timestamp_ns);
+      return true;
+    }
+  }
+  return false;
+}
+
+inline int read(ReplayStream& stream, void* dest, unsigned length) {
+  return stream.Read(std::span(static_cast<std::byte*>(dest), length));
+}
+
+inline int write(ReplayStream& stream, const void* source, unsigned length) {
+  return stream.Write(std::span(static_cast<const std::byte*>(source), length));
+}
+
+}  // namespace hydrolib::bus::capture
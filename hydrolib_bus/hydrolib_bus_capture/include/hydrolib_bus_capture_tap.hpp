@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "hydrolib_bus_capture_format.hpp"
+#include "hydrolib_bus_capture_writer.hpp"
+#include "hydrolib_clock_concepts.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::bus::capture {
+// Transparent stream wrapper that records every chunk passing through it.
+// Several taps may share one writer; `channel` tells their records apart.
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+class CaptureTap final {
+ public:
+  constexpr CaptureTap(Stream& stream, CaptureWriter<Sink>& writer,
+                       uint8_t channel = 0);
+  CaptureTap(const CaptureTap&) = delete;
+  CaptureTap(CaptureTap&&) = delete;
+  CaptureTap& operator=(const CaptureTap&) = delete;
+  CaptureTap& operator=(CaptureTap&&) = delete;
+  ~CaptureTap() = default;
+
+  int Read(std::span<std::byte> buffer);
+  int Write(std::span<const std::byte> data);
+
+ private:
+  static std::chrono::nanoseconds GetTimestamp();
+
+  Stream& stream_;
+  CaptureWriter<Sink>& writer_;
+  const uint8_t channel_;
+};
+
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+int read(CaptureTap<Stream, Sink, Clock>& tap, void* dest, unsigned length);
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+int write(CaptureTap<Stream, Sink, Clock>& tap, const void* source,
+          unsigned length);
+
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+constexpr CaptureTap<Stream, Sink, Clock>::CaptureTap(
+    Stream& stream, CaptureWriter<Sink>& writer, uint8_t channel)
+    : stream_(stream), writer_(writer), channel_(channel) {}
+
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+int CaptureTap<Stream, Sink, Clock>::Read(std::span<std::byte> buffer) {
+  int res = read(stream_, buffer.data(), buffer.size());
+  if (res > 0) {
+    writer_.Record(Direction::kRx, channel_, GetTimestamp(),
+                   buffer.first(res));
+  }
+  return res;
+}
+
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+int CaptureTap<Stream, Sink, Clock>::Write(std::span<const std::byte> data) {
+  int res = write(stream_, data.data(), data.size());
+  if (res > 0) {
+    writer_.Record(Direction::kTx, channel_, GetTimestamp(), data.first(res));
+  }
+  return res;
+}
+
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+std::chrono::nanoseconds CaptureTap<Stream, Sink, Clock>::GetTimestamp() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+      Clock::now().time_since_epoch());
+}
+
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+int read(CaptureTap<Stream, Sink, Clock>& tap, void* dest, unsigned length) {
+  return tap.Read(std::span(static_cast<std::byte*>(dest), length));
+}
+
+template <concepts::stream::ByteFullStreamConcept Stream,
+          concepts::stream::ByteWritableStreamConcept Sink,
+          concepts::clock::ClockConcept Clock>
+int write(CaptureTap<Stream, Sink, Clock>& tap, const void* source,
+          unsigned length) {
+  return tap.Write(std::span(static_cast<const std::byte*>(source), length));
+}
+
+}  // namespace hydrolib::bus::capture
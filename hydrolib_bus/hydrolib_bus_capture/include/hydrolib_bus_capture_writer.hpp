@@ -0,0 +1,86 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <span>
+
+#include "hydrolib_bus_capture_format.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::bus::capture {
+template <concepts::stream::ByteWritableStreamConcept Sink>
+class CaptureWriter final {
+ public:
+  constexpr explicit CaptureWriter(Sink& sink);
+  CaptureWriter(const CaptureWriter&) = delete;
+  CaptureWriter(CaptureWriter&&) = delete;
+  CaptureWriter& operator=(const CaptureWriter&) = delete;
+  CaptureWriter& operator=(CaptureWriter&&) = delete;
+  ~CaptureWriter() = default;
+
+  ReturnCode Record(Direction direction, uint8_t channel,
+                    std::chrono::nanoseconds timestamp,
+                    std::span<const std::byte> data);
+
+  [[nodiscard]] int GetDroppedRecords() const;
+
+ private:
+  ReturnCode WriteAll(const void* data, unsigned length);
+
+  Sink& sink_;
+
+  bool is_started_ = false;
+  int dropped_records_ = 0;
+};
+
+template <concepts::stream::ByteWritableStreamConcept Sink>
+constexpr CaptureWriter<Sink>::CaptureWriter(Sink& sink) : sink_(sink) {}
+
+template <concepts::stream::ByteWritableStreamConcept Sink>
+ReturnCode CaptureWriter<Sink>::Record(Direction direction, uint8_t channel,
+                                       std::chrono::nanoseconds timestamp,
+                                       std::span<const std::byte> data) {
+  if (!is_started_) {
+    if (WriteAll(&kCaptureFileHeader, sizeof(kCaptureFileHeader)) !=
+        ReturnCode::OK) {
+      dropped_records_++;
+      return ReturnCode::ERROR;
+    }
+    is_started_ = true;
+  }
+
+  while (!data.empty()) {
+    auto chunk = data.first(
+        std::min(data.size(), static_cast<std::size_t>(kMaxRecordLength)));
+    CaptureRecordHeader header{
+        .timestamp_ns = static_cast<uint64_t>(timestamp.count()),
+        .length = static_cast<uint16_t>(chunk.size()),
+        .direction = direction,
+        .channel = channel};
+    if (WriteAll(&header, sizeof(header)) != ReturnCode::OK ||
+        WriteAll(chunk.data(), chunk.size()) != ReturnCode::OK) {
+      dropped_records_++;
+      return ReturnCode::ERROR;
+    }
+    data = data.subspan(chunk.size());
+  }
+  return ReturnCode::OK;
+}
+
+template <concepts::stream::ByteWritableStreamConcept Sink>
+int CaptureWriter<Sink>::GetDroppedRecords() const {
+  return dropped_records_;
+}
+
+template <concepts::stream::ByteWritableStreamConcept Sink>
+ReturnCode CaptureWriter<Sink>::WriteAll(const void* data, unsigned length) {
+  int res = write(sink_, data, length);
+  if (res != static_cast<int>(length)) {
+    return ReturnCode::ERROR;
+  }
+  return ReturnCode::OK;
+}
+
+}  // namespace hydrolib::bus::capture
@@ -0,0 +1,235 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "hydrolib_bus_capture_analyzer.hpp"
+#include "hydrolib_bus_capture_replay.hpp"
+#include "hydrolib_bus_capture_tap.hpp"
+#include "hydrolib_bus_capture_writer.hpp"
+#include "hydrolib_bus_datalink_serializer.hpp"
+#include "hydrolib_bus_datalink_stream.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "mock_stream.hpp"
+
+namespace {
+using namespace std::literals::chrono_literals;
+
+using TestClock = hydrolib::streams::mock::TestClock;
+
+struct VectorStream {
+  std::vector<std::byte> data;
+};
+
+int write(VectorStream& stream, const void* source, unsigned length) {
+  const auto* bytes = static_cast<const std::byte*>(source);
+  stream.data.insert(stream.data.end(), bytes, bytes + length);
+  return static_cast<int>(length);
+}
+
+class TestHydrolibBusCapture : public ::testing::Test {
+ public:
+  static constexpr hydrolib::bus::datalink::AddressType kFirstAddress =
+      std::byte(3);
+  static constexpr hydrolib::bus::datalink::AddressType kSecondAddress =
+      std::byte(5);
+  static constexpr hydrolib::bus::datalink::AddressType kTopsideAddress =
+      std::byte(1);
+
+ protected:
+  TestHydrolibBusCapture() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::CRITICAL);
+    TestClock::current_time = {};
+  }
+
+  void RecordFrame(hydrolib::bus::datalink::AddressType src,
+                   std::chrono::nanoseconds time, int length = 8) {
+    VectorStream frame;
+    hydrolib::bus::datalink::Serializer serializer(
+        src, frame, hydrolib::logger::mock_logger);
+    std::vector<std::byte> data(length, std::byte(0xAA));
+    serializer.Process(kTopsideAddress, data);
+    writer.Record(hydrolib::bus::capture::Direction::kRx, 0, time, frame.data);
+  }
+
+  VectorStream capture;
+  hydrolib::bus::capture::CaptureWriter<VectorStream> writer{capture};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusCapture, TapRecordsBothDirections) {
+  hydrolib::streams::mock::MockByteStream stream;
+  hydrolib::bus::capture::CaptureTap<hydrolib::streams::mock::MockByteStream,
+                                     VectorStream, TestClock>
+      tap(stream, writer, 2);
+
+  std::array<std::byte, 3> tx_data{std::byte(1), std::byte(2), std::byte(3)};
+  TestClock::current_time += 5ms;
+  EXPECT_EQ(write(tap, tx_data.data(), tx_data.size()), tx_data.size());
+
+  stream.MakeAllbytesAvailable();
+  std::array<std::byte, 2> rx_data{};
+  TestClock::current_time += 5ms;
+  EXPECT_EQ(read(tap, rx_data.data(), rx_data.size()), rx_data.size());
+
+  hydrolib::bus::capture::ReplayStream tx_replay(
+      capture.data, hydrolib::bus::capture::Direction::kTx, 2);
+  ASSERT_TRUE(tx_replay.IsValid());
+  std::array<std::byte, 8> replayed{};
+  EXPECT_EQ(read(tx_replay, replayed.data(), replayed.size()), 3);
+  EXPECT_EQ(replayed[2], std::byte(3));
+  EXPECT_EQ(tx_replay.GetTimestamp(), 5ms);
+
+  hydrolib::bus::capture::ReplayStream rx_replay(
+      capture.data, hydrolib::bus::capture::Direction::kRx, 2);
+  EXPECT_EQ(read(rx_replay, replayed.data(), replayed.size()), 2);
+  EXPECT_EQ(replayed[0], std::byte(1));
+  EXPECT_EQ(rx_replay.GetTimestamp(), 10ms);
+  EXPECT_TRUE(rx_replay.IsFinished());
+}
+
+TEST_F(TestHydrolibBusCapture, ReplayFeedsStreamManager) {
+  RecordFrame(kFirstAddress, 1ms, 4);
+  RecordFrame(kFirstAddress, 2ms, 4);
+
+  hydrolib::bus::capture::ReplayStream replay(capture.data);
+  hydrolib::bus::datalink::StreamManager<
+      hydrolib::bus::capture::ReplayStream,
+      decltype(hydrolib::logger::mock_logger), TestClock, kFirstAddress>
+      manager(kTopsideAddress, replay, hydrolib::logger::mock_logger);
+  decltype(manager)::Stream<kFirstAddress> stream(manager);
+
+  EXPECT_EQ(manager.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(manager.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(manager.Process(), hydrolib::ReturnCode::NO_DATA);
+  std::array<std::byte, 16> data{};
+  EXPECT_EQ(read(stream, data.data(), data.size()), 8);
+}
+
+TEST_F(TestHydrolibBusCapture, ReplayIgnoresTruncatedRecord) {
+  RecordFrame(kFirstAddress, 1ms, 4);
+  auto full_size = capture.data.size();
+  RecordFrame(kFirstAddress, 2ms, 4);
+  capture.data.resize(capture.data.size() - 3);
+
+  hydrolib::bus::capture::ReplayStream replay(capture.data);
+  std::vector<std::byte> replayed(64);
+  EXPECT_EQ(read(replay, replayed.data(), replayed.size()),
+            full_size - sizeof(hydrolib::bus::capture::CaptureFileHeader) -
+                sizeof(hydrolib::bus::capture::CaptureRecordHeader));
+  EXPECT_TRUE(replay.IsFinished());
+}
+
+TEST_F(TestHydrolibBusCapture, RejectsForeignFile) {
+  std::array<std::byte, 32> garbage{};
+  hydrolib::bus::capture::ReplayStream replay(garbage);
+  EXPECT_FALSE(replay.IsValid());
+  hydrolib::bus::capture::Analyzer analyzer(
+      garbage, hydrolib::logger::mock_logger, 1s,
+      hydrolib::bus::capture::Direction::kRx);
+  EXPECT_EQ(analyzer.Run(), hydrolib::ReturnCode::FAIL);
+}
+
+TEST_F(TestHydrolibBusCapture, AnalyzerReportsRatesAndJitter) {
+  for (int i = 0; i < 100; i++) {
+    RecordFrame(kFirstAddress, i * 10ms);
+    RecordFrame(kSecondAddress, i * 20ms + (i % 2 == 0 ? 0ms : 2ms));
+  }
+
+  hydrolib::bus::capture::Analyzer analyzer(
+      capture.data, hydrolib::logger::mock_logger, 1s,
+      hydrolib::bus::capture::Direction::kRx);
+  ASSERT_EQ(analyzer.Run(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(analyzer.GetFrames(), 200);
+
+  const auto& first = analyzer.GetAddressStats(kFirstAddress);
+  EXPECT_EQ(first.frames, 100);
+  EXPECT_NEAR(first.GetFrameRate(), 100.0, 0.01);
+  EXPECT_NEAR(first.GetJitterNs(), 0.0, 1.0);
+  EXPECT_EQ(first.max_interval, 10ms);
+
+  const auto& second = analyzer.GetAddressStats(kSecondAddress);
+  EXPECT_EQ(second.frames, 100);
+  EXPECT_NEAR(second.mean_interval_ns, 20e6, 0.1e6);
+  EXPECT_NEAR(second.GetJitterNs(), 2e6, 0.1e6);
+  EXPECT_EQ(second.max_interval, 22ms);
+
+  auto throughput = analyzer.GetThroughput();
+  ASSERT_EQ(throughput.size(), 2);
+  EXPECT_EQ(throughput[0], throughput[1] * 3);
+}
+
+TEST_F(TestHydrolibBusCapture, AnalyzerClassifiesErrors) {
+  RecordFrame(kFirstAddress, 1ms);
+
+  std::array<std::byte, 3> rubbish{std::byte(1), std::byte(2), std::byte(3)};
+  writer.Record(hydrolib::bus::capture::Direction::kRx, 0, 2ms, rubbish);
+
+  std::array<std::byte, 5> wrong_length{std::byte(0xAA), std::byte(1),
+                                        std::byte(3), std::byte(2),
+                                        std::byte(0)};
+  writer.Record(hydrolib::bus::capture::Direction::kRx, 0, 3ms, wrong_length);
+
+  VectorStream corrupted;
+  hydrolib::bus::datalink::Serializer serializer(
+      kFirstAddress, corrupted, hydrolib::logger::mock_logger);
+  std::array<std::byte, 4> data{};
+  serializer.Process(kTopsideAddress, data);
+  corrupted.data.back() ^= std::byte(0xFF);
+  writer.Record(hydrolib::bus::capture::Direction::kRx, 0, 4ms,
+                corrupted.data);
+
+  RecordFrame(kFirstAddress, 5ms);
+
+  hydrolib::bus::capture::Analyzer analyzer(
+      capture.data, hydrolib::logger::mock_logger, 1s,
+      hydrolib::bus::capture::Direction::kRx);
+  ASSERT_EQ(analyzer.Run(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(analyzer.GetFrames(), 2);
+  EXPECT_EQ(analyzer.GetErrorStats().rubbish_bytes, 3);
+  EXPECT_EQ(analyzer.GetErrorStats().wrong_length, 1);
+  EXPECT_EQ(analyzer.GetErrorStats().crc_errors, 1);
+}
+
+TEST_F(TestHydrolibBusCapture, AnalyzerRejectsFarFutureTimestamp) {
+  RecordFrame(kFirstAddress, 1ms);
+  RecordFrame(kFirstAddress, std::chrono::nanoseconds(INT64_MAX));
+  RecordFrame(kFirstAddress, 1500ms);
+
+  hydrolib::bus::capture::Analyzer analyzer(
+      capture.data, hydrolib::logger::mock_logger, 1s,
+      hydrolib::bus::capture::Direction::kRx);
+  ASSERT_EQ(analyzer.Run(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(analyzer.GetFrames(), 2);
+  EXPECT_EQ(analyzer.GetErrorStats().bad_timestamps, 1);
+  EXPECT_EQ(analyzer.GetThroughput().size(), 2);
+  EXPECT_EQ(analyzer.GetAddressStats(kFirstAddress).max_interval, 1499ms);
+}
+
+TEST_F(TestHydrolibBusCapture, AnalyzerIsFasterThanRealTime) {
+  constexpr int kFramesCount = 50000;
+  constexpr auto kPeriod = 1ms;
+  for (int i = 0; i < kFramesCount; i++) {
+    RecordFrame(kFirstAddress, i * kPeriod, 32);
+  }
+
+  hydrolib::bus::capture::Analyzer analyzer(
+      capture.data, hydrolib::logger::mock_logger, 1s,
+      hydrolib::bus::capture::Direction::kRx);
+  auto start = std::chrono::steady_clock::now();
+  ASSERT_EQ(analyzer.Run(), hydrolib::ReturnCode::OK);
+  auto elapsed = std::chrono::steady_clock::now() - start;
+
+  EXPECT_EQ(analyzer.GetFrames(), kFramesCount);
+  auto captured = kFramesCount * kPeriod;
+  auto speedup = std::chrono::duration<double>(captured) /
+                 std::chrono::duration<double>(elapsed);
+  RecordProperty("speedup", static_cast<int>(speedup));
+  std::cout << "Analyzer: " << speedup << "x real time\n";
+  EXPECT_GT(speedup, 1.0);
+}
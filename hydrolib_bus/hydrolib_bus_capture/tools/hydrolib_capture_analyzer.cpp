@@ -0,0 +1,141 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <span>
+
+#include "hydrolib_bus_capture_analyzer.hpp"
+#include "hydrolib_log_distributor.hpp"
+#include "hydrolib_logger.hpp"
+
+namespace {
+struct StderrStream {};
+
+int write([[maybe_unused]] StderrStream& stream, const void* source,
+          unsigned length) {
+  return static_cast<int>(fwrite(source, 1, length, stderr));
+}
+
+constexpr const char* kLogFormat = "[%s] [%l] %m\n";
+constinit StderrStream stderr_stream{};
+using Distributor = hydrolib::logger::LogDistributor<1, StderrStream>;
+constinit Distributor distributor{kLogFormat, stderr_stream};
+constinit hydrolib::logger::Logger<Distributor> logger{"Analyzer", 0,
+                                                       distributor};
+
+void PrintUsage(const char* name) {
+  printf("Usage: %s <capture> [--tx] [--channel N] [--bin-ms N] [--verbose]\n",
+         name);
+}
+}  // namespace
+
+int main(int argc, char** argv) {
+  if (argc < 2) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+
+  auto direction = hydrolib::bus::capture::Direction::kRx;
+  uint8_t channel = 0;
+  std::chrono::nanoseconds bin_width = std::chrono::seconds(1);
+  auto log_level = hydrolib::logger::LogLevel::CRITICAL;
+  for (int i = 2; i < argc; i++) {
+    if (strcmp(argv[i], "--tx") == 0) {
+      direction = hydrolib::bus::capture::Direction::kTx;
+    } else if (strcmp(argv[i], "--channel") == 0 && i + 1 < argc) {
+      channel = static_cast<uint8_t>(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--bin-ms") == 0 && i + 1 < argc) {
+      bin_width = std::chrono::milliseconds(atoi(argv[++i]));
+    } else if (strcmp(argv[i], "--verbose") == 0) {
+      log_level = hydrolib::logger::LogLevel::WARNING;
+    } else {
+      PrintUsage(argv[0]);
+      return EXIT_FAILURE;
+    }
+  }
+  if (bin_width.count() <= 0) {
+    PrintUsage(argv[0]);
+    return EXIT_FAILURE;
+  }
+  distributor.SetAllFilters(0, log_level);
+
+  int fd = open(argv[1], O_RDONLY);
+  if (fd < 0) {
+    perror("open");
+    return EXIT_FAILURE;
+  }
+  struct stat file_stat {};
+  if (fstat(fd, &file_stat) != 0) {
+    perror("fstat");
+    close(fd);
+    return EXIT_FAILURE;
+  }
+  auto size = static_cast<std::size_t>(file_stat.st_size);
+  void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+  close(fd);
+  if (mapped == MAP_FAILED) {
+    perror("mmap");
+    return EXIT_FAILURE;
+  }
+  madvise(mapped, size, MADV_SEQUENTIAL);
+
+  hydrolib::bus::capture::Analyzer analyzer(
+      std::span(static_cast<const std::byte*>(mapped), size), logger,
+      bin_width, direction, channel);
+
+  auto start = std::chrono::steady_clock::now();
+  auto result = analyzer.Run();
+  auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+  if (result != hydrolib::ReturnCode::OK) {
+    fprintf(stderr, "Not a valid capture: %s\n", argv[1]);
+    munmap(mapped, size);
+    return EXIT_FAILURE;
+  }
+
+  const auto& errors = analyzer.GetErrorStats();
+  printf("Frames: %lld\n", static_cast<long long>(analyzer.GetFrames()));
+  printf("Errors: rubbish bytes %lld, wrong length %lld, COBS %lld, CRC %lld, "
+         "bad timestamps %lld\n",
+         static_cast<long long>(errors.rubbish_bytes),
+         static_cast<long long>(errors.wrong_length),
+         static_cast<long long>(errors.cobs_errors),
+         static_cast<long long>(errors.crc_errors),
+         static_cast<long long>(errors.bad_timestamps));
+
+  printf("\n%-8s %12s %12s %12s %14s %14s\n", "Source", "Frames", "Bytes",
+         "Rate, 1/s", "Jitter, us", "Max gap, us");
+  for (int address = 0; address <= UINT8_MAX; address++) {
+    const auto& stats = analyzer.GetAddressStats(std::byte(address));
+    if (stats.frames == 0) {
+      continue;
+    }
+    printf("%-8d %12lld %12lld %12.2f %14.1f %14.1f\n", address,
+           static_cast<long long>(stats.frames),
+           static_cast<long long>(stats.bytes), stats.GetFrameRate(),
+           stats.GetJitterNs() / 1000.0,
+           static_cast<double>(stats.max_interval.count()) / 1000.0);
+  }
+
+  auto bin_seconds = std::chrono::duration<double>(bin_width).count();
+  printf("\n%-12s %14s\n", "Time, s", "Bytes/s");
+  auto throughput = analyzer.GetThroughput();
+  for (std::size_t bin = 0; bin < throughput.size(); bin++) {
+    printf("%-12.3f %14.1f\n", static_cast<double>(bin) * bin_seconds,
+           static_cast<double>(throughput[bin]) / bin_seconds);
+  }
+
+  printf("\nAnalyzed %.1f MB in %.3f s (%.1f MB/s)\n",
+         static_cast<double>(size) / 1e6, elapsed,
+         static_cast<double>(size) / 1e6 / elapsed);
+
+  munmap(mapped, size);
+  return EXIT_SUCCESS;
+}
@@ -0,0 +1,703 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <utility>
+
+#include "hydrolib_bus_datalink_deserializer.hpp"
+#include "hydrolib_bus_datalink_message.hpp"
+#include "hydrolib_bus_datalink_serializer.hpp"
+#include "hydrolib_bus_datalink_stream.hpp"
+#include "hydrolib_clock_concepts.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_ring_queue.hpp"
+
+namespace hydrolib::bus::datalink {
+using namespace std::literals::chrono_literals;
+
+enum class BondFrameType : uint8_t { kData, kKeepalive };
+
+struct BondHeader {
+  uint8_t sequence;
+  BondFrameType type;
+  uint8_t flags;
+} __attribute__((__packed__));
+
+// Set on the data frames of the first reorder window after a start, so the
+// mate resyncs to the new sequences at once, whichever of them comes first.
+constexpr uint8_t kBondRestartFlag = 0x01;
+
+constexpr int kMaxBondedDataLength =
+    kMaxDataLength - static_cast<int>(sizeof(BondHeader));
+
+// Stripes frames over several physical links to the same mates. Every data
+// frame carries a per-mate sequence number, so the receiving side restores the
+// original order and drops copies that came over more than one link. Both sides
+// count sequences from zero, and the first kReorderWindow frames after a start
+// are flagged, so the mate resyncs to zero on the first of them that does not
+// fit its current sequences. A restart that still goes unnoticed, e.g. right
+// after another one, is detected by a long run of stale sequences. A link is
+// considered down when nothing was received from it for kLinkTimeout;
+// keepalive frames are sent over idle links so that both sides notice
+// recovery. A frame that was only partially written tears its link: the
+// frame is given up rather than resent mid-stream over another link, and the
+// link stays down until a complete keepalive resynchronizes the mate.
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+class BondedStreamManager final {
+ public:
+  static constexpr auto kLinkTimeout = 500ms;
+  static constexpr auto kKeepalivePeriod = 100ms;
+  static constexpr auto kReorderTimeout = 50ms;
+  static constexpr int kReorderWindow = 8;
+
+  struct LinkStats {
+    bool is_up = true;
+    int tx_frames = 0;
+    int rx_frames = 0;
+    int tx_errors = 0;
+    int lost_packages = 0;
+  };
+
+  template <AddressType kMateAddress>
+  class Stream;
+
+  constexpr BondedStreamManager(AddressType self_address,
+                                std::array<RxTxStream*, kLinksCount> links,
+                                Logger& logger);
+  BondedStreamManager(const BondedStreamManager&) = delete;
+  BondedStreamManager(BondedStreamManager&&) = delete;
+  BondedStreamManager& operator=(const BondedStreamManager&) = delete;
+  BondedStreamManager& operator=(BondedStreamManager&&) = delete;
+  ~BondedStreamManager() = default;
+
+  ReturnCode Process();
+
+  [[nodiscard]] LinkStats GetLinkStats(std::size_t link) const;
+  [[nodiscard]] int GetLostPackages() const;
+  [[nodiscard]] int GetDuplicatedPackages() const;
+  [[nodiscard]] int GetReorderedPackages() const;
+
+ private:
+  using SerializerType = Serializer<RxTxStream, Logger>;
+  using DeserializerType = Deserializer<RxTxStream, Logger, Clock>;
+  using TimePoint = typename Clock::time_point;
+
+  struct Link {
+    constexpr Link(AddressType self_address, RxTxStream& stream,
+                   Logger& logger);
+
+    DeserializerType deserializer;
+    SerializerType serializer;
+
+    LinkStats stats{};
+    TimePoint last_rx_time{};
+    TimePoint last_tx_time{};
+    bool is_torn = false;
+  };
+
+  class RxManager;
+
+  template <std::size_t... kIndexes>
+  constexpr BondedStreamManager(AddressType self_address,
+                                std::array<RxTxStream*, kLinksCount> links,
+                                Logger& logger,
+                                std::index_sequence<kIndexes...> indexes);
+
+  static constexpr int GetMateIndex(AddressType address);
+
+  ReturnCode Transmit(AddressType dest_address, std::span<const std::byte> data);
+  ReturnCode SendOverLink(Link& link, AddressType dest_address,
+                          std::span<const std::byte> frame, TimePoint now);
+  void HandleMessage(MessageInfo message, TimePoint now);
+  void UpdateLinksHealth(TimePoint now);
+  void SendKeepalives(TimePoint now);
+
+  Logger& logger_;
+
+  std::array<Link, kLinksCount> links_;
+  RxManager rx_manager_;
+
+  std::array<uint8_t, sizeof...(kMateAddresses)> tx_sequences_{};
+  // Cleared until the first kReorderWindow frames to the mate are flagged.
+  std::array<bool, sizeof...(kMateAddresses)> is_mate_synced_{};
+  std::array<std::byte, kMaxDataLength> tx_buffer_{};
+  std::size_t next_link_ = 0;
+  bool is_started_ = false;
+
+  static_assert(kLinksCount > 0, "Bonded manager needs at least one link");
+};
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+class BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                          kMateAddresses...>::RxManager final {
+ public:
+  RxManager() = default;
+  RxManager(const RxManager&) = delete;
+  RxManager(RxManager&&) = delete;
+  RxManager& operator=(const RxManager&) = delete;
+  RxManager& operator=(RxManager&&) = delete;
+  ~RxManager() = default;
+
+  void Push(int mate_index, const BondHeader& header,
+            std::span<const std::byte> data, TimePoint now);
+  void Flush(TimePoint now);
+  std::span<std::byte> Pull(int mate_index, int length);
+
+  [[nodiscard]] int GetLostPackages() const;
+  [[nodiscard]] int GetDuplicatedPackages() const;
+  [[nodiscard]] int GetReorderedPackages() const;
+
+ private:
+  static constexpr int kStaleDistance = 128;
+
+  struct Slot {
+    bool is_used = false;
+    TimePoint arrival_time{};
+    int length = 0;
+    std::array<std::byte, kMaxBondedDataLength> data{};
+  };
+
+  struct RxMailbox {
+    uint8_t expected_sequence = 0;
+    int stale_in_row = 0;
+    std::array<Slot, kReorderWindow> slots{};
+    ring_queue::RingQueue<kMaxBondedDataLength * kReorderWindow> queue;
+  };
+
+  void Deliver(RxMailbox& mailbox, std::span<const std::byte> data);
+  void DeliverReady(RxMailbox& mailbox);
+  void SkipExpected(RxMailbox& mailbox);
+  void Resynchronize(RxMailbox& mailbox, uint8_t sequence);
+  static bool HasExpired(const RxMailbox& mailbox, TimePoint now);
+
+  std::array<RxMailbox, sizeof...(kMateAddresses)> mailboxes_{};
+  std::array<std::byte, kMaxDataLength> buffer_{};
+
+  int lost_packages_ = 0;
+  int duplicated_packages_ = 0;
+  int reordered_packages_ = 0;
+
+  static_assert((kReorderWindow & (kReorderWindow - 1)) == 0 &&
+                    kReorderWindow <= kStaleDistance,
+                "Reorder window must be a power of two not above 128");
+};
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+template <AddressType kMateAddress>
+class BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                          kMateAddresses...>::Stream final {
+ public:
+  constexpr explicit Stream(BondedStreamManager& manager);
+  Stream(const Stream&) = default;
+  Stream(Stream&&) = default;
+  Stream& operator=(const Stream&) = default;
+  Stream& operator=(Stream&&) = default;
+  ~Stream() = default;
+
+  static constexpr bool kHydrolibBusDatalinkStreamMarker = true;
+
+  int Read(std::span<std::byte> buffer);
+  int Write(std::span<const std::byte> data);
+
+ private:
+  static constexpr int kMateIndex = GetMateIndex(kMateAddress);
+
+  BondedStreamManager* manager_ = nullptr;
+
+  static_assert(kMateIndex >= 0, "Invalid mate address");
+};
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+constexpr BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                              kMateAddresses...>::
+    BondedStreamManager(AddressType self_address,
+                        std::array<RxTxStream*, kLinksCount> links,
+                        Logger& logger)
+    : BondedStreamManager(self_address, links, logger,
+                          std::make_index_sequence<kLinksCount>()) {}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+template <std::size_t... kIndexes>
+constexpr BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                              kMateAddresses...>::
+    BondedStreamManager(AddressType self_address,
+                        std::array<RxTxStream*, kLinksCount> links,
+                        Logger& logger,
+                        [[maybe_unused]] std::index_sequence<kIndexes...>
+                            indexes)
+    : logger_(logger),
+      links_{{Link(self_address, *links[kIndexes], logger)...}} {}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+constexpr BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                              kMateAddresses...>::Link::Link(AddressType
+                                                                 self_address,
+                                                             RxTxStream& stream,
+                                                             Logger& logger)
+    : deserializer(self_address, stream, logger),
+      serializer(self_address, stream, logger) {}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+ReturnCode BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                               kMateAddresses...>::Process() {
+  auto now = Clock::now();
+  if (!is_started_) {
+    for (auto& link : links_) {
+      link.last_rx_time = now;
+      link.last_tx_time = now;
+    }
+    is_started_ = true;
+  }
+
+  bool is_received = false;
+  for (auto& link : links_) {
+    auto result = link.deserializer.Process();
+    link.stats.lost_packages = link.deserializer.GetLostPackages();
+    if (result != ReturnCode::OK) {
+      continue;
+    }
+    link.last_rx_time = now;
+    link.stats.rx_frames++;
+    HandleMessage(result, now);
+    is_received = true;
+  }
+
+  UpdateLinksHealth(now);
+  rx_manager_.Flush(now);
+  SendKeepalives(now);
+
+  return is_received ? ReturnCode::OK : ReturnCode::NO_DATA;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+typename BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                             kMateAddresses...>::LinkStats
+BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                    kMateAddresses...>::GetLinkStats(std::size_t link) const {
+  return links_[link].stats;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                        kMateAddresses...>::GetLostPackages() const {
+  int lost_packages = rx_manager_.GetLostPackages();
+  for (const auto& link : links_) {
+    lost_packages += link.stats.lost_packages;
+  }
+  return lost_packages;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                        kMateAddresses...>::GetDuplicatedPackages() const {
+  return rx_manager_.GetDuplicatedPackages();
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                        kMateAddresses...>::GetReorderedPackages() const {
+  return rx_manager_.GetReorderedPackages();
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+constexpr int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                                  kMateAddresses...>::GetMateIndex(AddressType
+                                                                       address) {
+  std::array addresses = {kMateAddresses...};
+  for (int i = 0; i < static_cast<int>(addresses.size()); i++) {
+    if (addresses[i] == address) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+ReturnCode BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                               kMateAddresses...>::
+    Transmit(AddressType dest_address, std::span<const std::byte> data) {
+  if (static_cast<int>(data.size()) > kMaxBondedDataLength) {
+    return ReturnCode::OVERFLOW;
+  }
+  int mate_index = GetMateIndex(dest_address);
+  BondHeader header{
+      .sequence = tx_sequences_[mate_index],
+      .type = BondFrameType::kData,
+      .flags = is_mate_synced_[mate_index] ? uint8_t{0} : kBondRestartFlag};
+  if (tx_sequences_[mate_index] == kReorderWindow - 1) {
+    is_mate_synced_[mate_index] = true;
+  }
+  std::memcpy(tx_buffer_.data(), &header, sizeof(header));
+  std::ranges::copy(data, tx_buffer_.begin() + sizeof(header));
+  auto frame = std::span<const std::byte>(tx_buffer_).first(sizeof(header) +
+                                                            data.size());
+
+  bool is_any_link_up = false;
+  for (const auto& link : links_) {
+    is_any_link_up = is_any_link_up || link.stats.is_up;
+  }
+
+  auto now = Clock::now();
+  for (std::size_t attempt = 0; attempt < kLinksCount; attempt++) {
+    auto& link = links_[next_link_];
+    next_link_ = (next_link_ + 1) % kLinksCount;
+    if (is_any_link_up && !link.stats.is_up) {
+      continue;
+    }
+    auto result = SendOverLink(link, dest_address, frame, now);
+    if (result == ReturnCode::OK) {
+      tx_sequences_[mate_index]++;
+      return ReturnCode::OK;
+    }
+    if (result == ReturnCode::OVERFLOW) {
+      // The mate may already hold the frame head, so the sequence number is
+      // spent and the frame is reported as lost instead of being resent.
+      tx_sequences_[mate_index]++;
+      return ReturnCode::ERROR;
+    }
+  }
+  return ReturnCode::ERROR;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+ReturnCode BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                               kMateAddresses...>::
+    SendOverLink(Link& link, AddressType dest_address,
+                 std::span<const std::byte> frame, TimePoint now) {
+  auto result = link.serializer.Process(dest_address, frame);
+  if (result == ReturnCode::OVERFLOW) {
+    link.stats.tx_errors++;
+    if (!link.is_torn) {
+      LOG_WARNING(logger_, "Link {} is torn by a partial write",
+                  static_cast<int>(&link - links_.data()));
+    }
+    link.is_torn = true;
+    link.stats.is_up = false;
+    return result;
+  }
+  if (result != ReturnCode::OK) {
+    link.stats.tx_errors++;
+    return result;
+  }
+  link.is_torn = false;
+  link.stats.tx_frames++;
+  link.last_tx_time = now;
+  return ReturnCode::OK;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::HandleMessage(MessageInfo message,
+                                                           TimePoint now) {
+  auto data = static_cast<std::span<const std::byte>>(message.data);
+  if (data.size() < sizeof(BondHeader)) {
+    LOG_WARNING(logger_, "Too short bonded frame: {}",
+                static_cast<int>(data.size()));
+    return;
+  }
+  int mate_index = GetMateIndex(message.src_address);
+  if (mate_index < 0) {
+    return;
+  }
+  BondHeader header{};
+  std::memcpy(&header, data.data(), sizeof(header));
+  if (header.type == BondFrameType::kData) {
+    rx_manager_.Push(mate_index, header, data.subspan(sizeof(header)), now);
+  }
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::UpdateLinksHealth(TimePoint now) {
+  for (int i = 0; i < static_cast<int>(kLinksCount); i++) {
+    auto& link = links_[i];
+    bool is_up = !link.is_torn && now - link.last_rx_time <= kLinkTimeout;
+    if (is_up == link.stats.is_up) {
+      continue;
+    }
+    link.stats.is_up = is_up;
+    if (is_up) {
+      LOG_INFO(logger_, "Link {} is up", i);
+    } else {
+      LOG_WARNING(logger_, "Link {} is down", i);
+    }
+  }
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::SendKeepalives(TimePoint now) {
+  constexpr BondHeader kKeepalive{
+      .sequence = 0, .type = BondFrameType::kKeepalive, .flags = 0};
+  for (auto& link : links_) {
+    if (!link.is_torn && now - link.last_tx_time < kKeepalivePeriod) {
+      continue;
+    }
+    for (auto mate_address : {kMateAddresses...}) {
+      SendOverLink(link, mate_address,
+                   std::as_bytes(std::span(&kKeepalive, 1)), now);
+    }
+  }
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::RxManager::
+    Push(int mate_index, const BondHeader& header,
+         std::span<const std::byte> data, TimePoint now) {
+  auto& mailbox = mailboxes_[mate_index];
+  uint8_t sequence = header.sequence;
+  // A flagged frame that is neither a late nor a near frame of the current
+  // sequences starts the sequences of a restarted mate.
+  auto offset =
+      static_cast<int8_t>(static_cast<uint8_t>(sequence -
+                                                mailbox.expected_sequence));
+  if ((header.flags & kBondRestartFlag) != 0 &&
+      (offset <= -kReorderWindow || offset >= kReorderWindow)) {
+    Resynchronize(mailbox, 0);
+  }
+
+  int distance = static_cast<uint8_t>(sequence - mailbox.expected_sequence);
+  if (distance >= kStaleDistance) {
+    duplicated_packages_++;
+    mailbox.stale_in_row++;
+    if (mailbox.stale_in_row < kReorderWindow) {
+      return;
+    }
+    // So many old sequences in a row can only mean that the mate restarted
+    Resynchronize(mailbox, sequence);
+    distance = 0;
+  }
+  mailbox.stale_in_row = 0;
+
+  while (distance >= kReorderWindow) {
+    SkipExpected(mailbox);
+    DeliverReady(mailbox);
+    distance = static_cast<uint8_t>(sequence - mailbox.expected_sequence);
+  }
+
+  if (distance == 0) {
+    Deliver(mailbox, data);
+    mailbox.expected_sequence++;
+    DeliverReady(mailbox);
+    return;
+  }
+
+  auto& slot = mailbox.slots[sequence % kReorderWindow];
+  if (slot.is_used) {
+    duplicated_packages_++;
+    return;
+  }
+  slot.is_used = true;
+  slot.arrival_time = now;
+  slot.length = static_cast<int>(data.size());
+  std::ranges::copy(data, slot.data.begin());
+  reordered_packages_++;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::RxManager::Flush(TimePoint now) {
+  for (auto& mailbox : mailboxes_) {
+    while (HasExpired(mailbox, now)) {
+      SkipExpected(mailbox);
+      DeliverReady(mailbox);
+    }
+  }
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+std::span<std::byte>
+BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                    kMateAddresses...>::RxManager::Pull(int mate_index,
+                                                        int length) {
+  auto& queue = mailboxes_[mate_index].queue;
+  length = std::min(length, queue.GetLength());
+  queue.Pull(buffer_.data(), length);
+  return std::span(buffer_).subspan(0, length);
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                        kMateAddresses...>::RxManager::GetLostPackages() const {
+  return lost_packages_;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                        kMateAddresses...>::RxManager::GetDuplicatedPackages()
+    const {
+  return duplicated_packages_;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                        kMateAddresses...>::RxManager::GetReorderedPackages()
+    const {
+  return reordered_packages_;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::RxManager::
+    Deliver(RxMailbox& mailbox, std::span<const std::byte> data) {
+  if (mailbox.queue.Push(data.data(), static_cast<int>(data.size())) !=
+      ReturnCode::OK) {
+    lost_packages_++;
+  }
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::RxManager::
+    DeliverReady(RxMailbox& mailbox) {
+  while (true) {
+    auto& slot = mailbox.slots[mailbox.expected_sequence % kReorderWindow];
+    if (!slot.is_used) {
+      return;
+    }
+    Deliver(mailbox, std::span(slot.data).first(slot.length));
+    slot.is_used = false;
+    mailbox.expected_sequence++;
+  }
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::RxManager::
+    SkipExpected(RxMailbox& mailbox) {
+  auto& slot = mailbox.slots[mailbox.expected_sequence % kReorderWindow];
+  if (slot.is_used) {
+    Deliver(mailbox, std::span(slot.data).first(slot.length));
+    slot.is_used = false;
+  } else {
+    lost_packages_++;
+  }
+  mailbox.expected_sequence++;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+void BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::RxManager::
+    Resynchronize(RxMailbox& mailbox, uint8_t sequence) {
+  for (int i = 0; i < kReorderWindow; i++) {
+    auto& slot = mailbox.slots[mailbox.expected_sequence % kReorderWindow];
+    if (slot.is_used) {
+      Deliver(mailbox, std::span(slot.data).first(slot.length));
+      slot.is_used = false;
+    }
+    mailbox.expected_sequence++;
+  }
+  mailbox.expected_sequence = sequence;
+  mailbox.stale_in_row = 0;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+bool BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                         kMateAddresses...>::RxManager::
+    HasExpired(const RxMailbox& mailbox, TimePoint now) {
+  for (const auto& slot : mailbox.slots) {
+    if (slot.is_used && now - slot.arrival_time >= kReorderTimeout) {
+      return true;
+    }
+  }
+  return false;
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+template <AddressType kMateAddress>
+constexpr BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                              kMateAddresses...>::Stream<kMateAddress>::
+    Stream(BondedStreamManager& manager)
+    : manager_(&manager) {}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+template <AddressType kMateAddress>
+int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                        kMateAddresses...>::Stream<kMateAddress>::
+    Read(std::span<std::byte> buffer) {
+  auto data = manager_->rx_manager_.Pull(kMateIndex,
+                                         static_cast<int>(buffer.size()));
+  std::ranges::copy(data, buffer.begin());
+  return static_cast<int>(data.size());
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, std::size_t kLinksCount,
+          AddressType... kMateAddresses>
+template <AddressType kMateAddress>
+int BondedStreamManager<RxTxStream, Logger, Clock, kLinksCount,
+                        kMateAddresses...>::Stream<kMateAddress>::
+    Write(std::span<const std::byte> data) {
+  auto result = manager_->Transmit(kMateAddress, data);
+  if (result == ReturnCode::OK) {
+    return static_cast<int>(data.size());
+  }
+  return -1;
+}
+
+}  // namespace hydrolib::bus::datalink
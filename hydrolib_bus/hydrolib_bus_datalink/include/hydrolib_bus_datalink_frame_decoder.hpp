@@ -0,0 +1,52 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <span>
+
+#include "hydrolib_bus_datalink_message.hpp"
+#include "hydrolib_bus_datalink_rx_info.hpp"
+#include "hydrolib_cobs.hpp"
+#include "hydrolib_crc.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::bus::datalink {
+
+enum class FrameError { kNone, kCobs, kCrc };
+
+template <typename Logger>
+FrameError DecodeFrame(const MessageBuffer& frame, MessageInfo& message,
+                       Logger& logger) {
+  auto header = frame.header;
+  auto data_length =
+      header.length - offsetof(MessageBuffer, data_and_crc) - kCRCLength;
+  MessageData data(static_cast<int>(data_length));
+  std::span<std::byte> data_span = data;
+  std::copy_n(static_cast<const std::byte*>(frame.data_and_crc), data_length,
+              data_span.begin());
+  auto crc = frame.data_and_crc[data_length];
+
+  ReturnCode res = cobs::Decode<kMagicByte>(header.cobs_length, data_span);
+  header.cobs_length = 0;
+  if (res != ReturnCode::OK) {
+    LOG_WARNING(logger, "COBS error");
+    return FrameError::kCobs;
+  }
+
+  crc::CRC8 crc_counter;
+  crc_counter.Next(kMagicByte);
+  crc_counter.Next(std::as_writable_bytes(std::span(&header, 1)));
+  crc_counter.Next(data_span);
+  auto target_crc = crc_counter.Get();
+
+  if (target_crc != crc) {
+    LOG_WARNING(logger, "Wrong CRC: expected {}, got {}",
+                static_cast<int>(target_crc), static_cast<int>(crc));
+    return FrameError::kCrc;
+  }
+  message = MessageInfo{header.src_address, data};
+  return FrameError::kNone;
+}
+
+}  // namespace hydrolib::bus::datalink
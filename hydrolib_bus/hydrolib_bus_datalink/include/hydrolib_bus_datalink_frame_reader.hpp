@@ -0,0 +1,292 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <span>
+
+#include "hydrolib_bus_datalink_message.hpp"
+#include "hydrolib_clock_concepts.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::bus::datalink {
+// Extracts frames from the byte stream exactly as they were transmitted: the
+// payload stays COBS-encoded and the checksum is not verified, so the frame
+// can be decoded or forwarded as is. The Clock paces the rubbish byte
+// warnings.
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock = std::chrono::steady_clock>
+class FrameReader final {
+ public:
+  constexpr FrameReader(RxStream& rx_stream, Logger& logger);
+
+  FrameReader(const FrameReader&) = delete;
+  FrameReader(FrameReader&&) = delete;
+  FrameReader& operator=(const FrameReader&) = delete;
+  FrameReader& operator=(FrameReader&&) = delete;
+  ~FrameReader() = default;
+
+  ReturnCode Process();
+
+  [[nodiscard]] const MessageBuffer& GetFrame() const;
+  [[nodiscard]] int GetRubbishBytes() const;
+
+ private:
+  class RxReader;
+  class Synchronizer;
+  class MessageReader;
+
+  enum class State { kSynchronizing, kReadingMessage };
+
+  Synchronizer synchronizer_;
+  MessageReader message_reader_;
+
+  State current_state_ = State::kSynchronizing;
+};
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+class FrameReader<RxStream, Logger, Clock>::RxReader final {
+ public:
+  explicit RxReader(RxStream& stream);
+  RxReader(const RxReader&) = delete;
+  RxReader(RxReader&&) = delete;
+  RxReader& operator=(const RxReader&) = delete;
+  RxReader& operator=(RxReader&&) = delete;
+  ~RxReader() = default;
+
+  void Start(std::span<std::byte> buffer);
+  hydrolib::ReturnCode operator()();
+
+ private:
+  RxStream& stream_;
+  std::span<std::byte> data_;
+  int current_length_ = 0;
+};
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+class FrameReader<RxStream, Logger, Clock>::Synchronizer final {
+ public:
+  explicit Synchronizer(RxStream& stream, Logger& logger);
+  Synchronizer(const Synchronizer&) = delete;
+  Synchronizer(Synchronizer&&) = delete;
+  Synchronizer& operator=(const Synchronizer&) = delete;
+  Synchronizer& operator=(Synchronizer&&) = delete;
+  ~Synchronizer() = default;
+
+  hydrolib::ReturnCode operator()();
+
+  [[nodiscard]] int GetRubbishBytes() const;
+
+ private:
+  static constexpr unsigned kMaxRubbishLogsPerSecond = 10;
+
+  Logger& logger_;
+  RxStream& stream_;
+
+  int rubbish_bytes_ = 0;
+};
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+class FrameReader<RxStream, Logger, Clock>::MessageReader final {
+ public:
+  explicit MessageReader(RxStream& stream, Logger& logger);
+  MessageReader(const MessageReader&) = delete;
+  MessageReader(MessageReader&&) = delete;
+  MessageReader& operator=(const MessageReader&) = delete;
+  MessageReader& operator=(MessageReader&&) = delete;
+  ~MessageReader() = default;
+
+  hydrolib::ReturnCode operator()();
+
+  [[nodiscard]] const MessageBuffer& GetFrame() const;
+
+ private:
+  enum class State {
+    kStartReadingHeader,
+    kReadingHeader,
+    kStartReadingPayload,
+    kReadingPayload
+  };
+
+  Logger& logger_;
+  RxReader reader_;
+
+  State current_state_ = State::kStartReadingHeader;
+  MessageBuffer current_frame_{};
+};
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+constexpr FrameReader<RxStream, Logger, Clock>::FrameReader(RxStream& rx_stream,
+                                                            Logger& logger)
+    : synchronizer_(rx_stream, logger), message_reader_(rx_stream, logger) {}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+ReturnCode FrameReader<RxStream, Logger, Clock>::Process() {
+  while (true) {
+    switch (current_state_) {
+      case State::kSynchronizing: {
+        auto result = synchronizer_();
+        if (result != ReturnCode::OK) {
+          return result;
+        }
+        current_state_ = State::kReadingMessage;
+        break;
+      }
+      case State::kReadingMessage: {
+        auto result = message_reader_();
+        if (result == ReturnCode::NO_DATA || result == ReturnCode::ERROR) {
+          return result;
+        }
+        current_state_ = State::kSynchronizing;
+        return result;
+      }
+    }
+  }
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+const MessageBuffer& FrameReader<RxStream, Logger, Clock>::GetFrame() const {
+  return message_reader_.GetFrame();
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+int FrameReader<RxStream, Logger, Clock>::GetRubbishBytes() const {
+  return synchronizer_.GetRubbishBytes();
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+FrameReader<RxStream, Logger, Clock>::RxReader::RxReader(RxStream& stream)
+    : stream_(stream) {}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+void FrameReader<RxStream, Logger, Clock>::RxReader::Start(
+    std::span<std::byte> buffer) {
+  data_ = buffer;
+  current_length_ = 0;
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+FrameReader<RxStream, Logger, Clock>::RxReader::operator()() {
+  auto remaining_length =
+      static_cast<int>(data_.size_bytes()) - current_length_;
+  if (remaining_length <= 0) {
+    return ReturnCode::OK;
+  }
+  auto read_length =
+      read(stream_, data_.subspan(current_length_).data(), remaining_length);
+  if (read_length < 0) {
+    return ReturnCode::ERROR;
+  }
+  current_length_ += read_length;
+  if (read_length == remaining_length) {
+    return ReturnCode::OK;
+  }
+  return ReturnCode::NO_DATA;
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+FrameReader<RxStream, Logger, Clock>::Synchronizer::Synchronizer(
+    RxStream& stream, Logger& logger)
+    : logger_(logger), stream_(stream) {}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+FrameReader<RxStream, Logger, Clock>::Synchronizer::operator()() {
+  while (true) {
+    std::byte byte_buffer{};
+    auto read_length = read(stream_, &byte_buffer, 1);
+    if (read_length < 0) {
+      return ReturnCode::ERROR;
+    }
+    if (read_length == 0) {
+      return ReturnCode::NO_DATA;
+    }
+    if (byte_buffer == kMagicByte) {
+      return ReturnCode::OK;
+    }
+    rubbish_bytes_++;
+    LOG_RATE_LIMITED(logger_, hydrolib::logger::LogLevel::WARNING,
+                     Clock, kMaxRubbishLogsPerSecond, std::chrono::seconds(1),
+                     "Rubbish byte");
+  }
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+int FrameReader<RxStream, Logger, Clock>::Synchronizer::GetRubbishBytes()
+    const {
+  return rubbish_bytes_;
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+FrameReader<RxStream, Logger, Clock>::MessageReader::MessageReader(
+    RxStream& stream, Logger& logger)
+    : logger_(logger), reader_(stream) {
+  current_frame_.magic_byte = kMagicByte;
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+hydrolib::ReturnCode
+FrameReader<RxStream, Logger, Clock>::MessageReader::operator()() {
+  while (true) {
+    auto result = reader_();
+    if (result != ReturnCode::OK) {
+      return result;
+    }
+    switch (current_state_) {
+      case State::kStartReadingHeader: {
+        reader_.Start(
+            std::as_writable_bytes(std::span(&current_frame_.header, 1)));
+        current_state_ = State::kReadingHeader;
+        break;
+      }
+      case State::kReadingHeader: {
+        if (current_frame_.header.length < kMinMessageLength ||
+            current_frame_.header.length > kMaxMessageLength) {
+          LOG_WARNING(logger_, "Wrong length: {}",
+                      current_frame_.header.length);
+          current_state_ = State::kStartReadingHeader;
+          return ReturnCode::FAIL;
+        }
+        current_state_ = State::kStartReadingPayload;
+        break;
+      }
+      case State::kStartReadingPayload: {
+        reader_.Start(std::span(current_frame_.data_and_crc)
+                          .first(current_frame_.header.length -
+                                 offsetof(MessageBuffer, data_and_crc)));
+        current_state_ = State::kReadingPayload;
+        break;
+      }
+      case State::kReadingPayload: {
+        current_state_ = State::kStartReadingHeader;
+        return ReturnCode::OK;
+      }
+    }
+  }
+}
+
+template <concepts::stream::ByteReadableStreamConcept RxStream, typename Logger,
+          concepts::clock::ClockConcept Clock>
+const MessageBuffer&
+FrameReader<RxStream, Logger, Clock>::MessageReader::GetFrame() const {
+  return current_frame_;
+}
+
+}  // namespace hydrolib::bus::datalink
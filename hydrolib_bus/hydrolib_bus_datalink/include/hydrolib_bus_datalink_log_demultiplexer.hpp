@@ -0,0 +1,152 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+
+#include "hydrolib_bus_datalink_log_sink.hpp"
+#include "hydrolib_bus_datalink_message.hpp"
+#include "hydrolib_log_decoder.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::bus::datalink {
+// Topside end of the log frames: renders the records of every node with the
+// decoder of its string table and writes the lines to the output of the node.
+template <concepts::stream::ByteWritableStreamConcept Output,
+          int kMaxNodesCount>
+class LogFrameDemultiplexer final {
+ public:
+  struct NodeStats {
+    int frames = 0;
+    int lost_frames = 0;
+    int records = 0;
+    int malformed_frames = 0;
+  };
+
+  explicit LogFrameDemultiplexer(std::string_view format);
+  LogFrameDemultiplexer(const LogFrameDemultiplexer&) = delete;
+  LogFrameDemultiplexer(LogFrameDemultiplexer&&) = delete;
+  LogFrameDemultiplexer& operator=(const LogFrameDemultiplexer&) = delete;
+  LogFrameDemultiplexer& operator=(LogFrameDemultiplexer&&) = delete;
+  ~LogFrameDemultiplexer() = default;
+
+  ReturnCode AddNode(AddressType address, const logger::LogDecoder& decoder,
+                     Output& output);
+
+  // Takes the payload of a frame received from src_address. Returns FAIL for
+  // frames that are not log frames or come from an unknown node.
+  ReturnCode Push(AddressType src_address, std::span<const std::byte> frame);
+
+  [[nodiscard]] NodeStats GetNodeStats(AddressType address) const;
+
+ private:
+  struct Node_ {
+    AddressType address{};
+    const logger::LogDecoder* decoder = nullptr;
+    Output* output = nullptr;
+    bool is_started = false;
+    uint8_t next_sequence = 0;
+    NodeStats stats;
+  };
+
+  Node_* FindNode_(AddressType address);
+
+  const std::string format_;
+  std::array<Node_, kMaxNodesCount> nodes_{};
+  int nodes_count_ = 0;
+};
+
+template <concepts::stream::ByteWritableStreamConcept Output,
+          int kMaxNodesCount>
+LogFrameDemultiplexer<Output, kMaxNodesCount>::LogFrameDemultiplexer(
+    std::string_view format)
+    : format_(format) {}
+
+template <concepts::stream::ByteWritableStreamConcept Output,
+          int kMaxNodesCount>
+ReturnCode LogFrameDemultiplexer<Output, kMaxNodesCount>::AddNode(
+    AddressType address, const logger::LogDecoder& decoder, Output& output) {
+  if (nodes_count_ == kMaxNodesCount || FindNode_(address) != nullptr) {
+    return ReturnCode::FAIL;
+  }
+  nodes_[nodes_count_] = {.address = address,
+                          .decoder = &decoder,
+                          .output = &output,
+                          .is_started = false,
+                          .next_sequence = 0,
+                          .stats = {}};
+  nodes_count_++;
+  return ReturnCode::OK;
+}
+
+template <concepts::stream::ByteWritableStreamConcept Output,
+          int kMaxNodesCount>
+ReturnCode LogFrameDemultiplexer<Output, kMaxNodesCount>::Push(
+    AddressType src_address, std::span<const std::byte> frame) {
+  Node_* node = FindNode_(src_address);
+  LogFrameHeader header{};
+  if (node == nullptr || frame.size() < sizeof(header)) {
+    return ReturnCode::FAIL;
+  }
+  std::memcpy(&header, frame.data(), sizeof(header));
+  if (header.tag != kLogFrameTag) {
+    return ReturnCode::FAIL;
+  }
+
+  if (node->is_started) {
+    node->stats.lost_frames +=
+        static_cast<uint8_t>(header.sequence - node->next_sequence);
+  }
+  node->is_started = true;
+  node->next_sequence = header.sequence + 1;
+  node->stats.frames++;
+
+  auto records = std::span(
+      reinterpret_cast<const uint8_t*>(frame.data()) + sizeof(header),
+      frame.size() - sizeof(header));
+  logger::LogDecoder::Record record;
+  while (!records.empty()) {
+    int length = node->decoder->Decode(records, record);
+    if (length <= 0) {
+      node->stats.malformed_frames++;
+      return ReturnCode::ERROR;
+    }
+    std::string line = node->decoder->Render(record, format_);
+    write(*node->output, line.data(), line.size());
+    node->stats.records++;
+    records = records.subspan(length);
+  }
+  return ReturnCode::OK;
+}
+
+template <concepts::stream::ByteWritableStreamConcept Output,
+          int kMaxNodesCount>
+typename LogFrameDemultiplexer<Output, kMaxNodesCount>::NodeStats
+LogFrameDemultiplexer<Output, kMaxNodesCount>::GetNodeStats(
+    AddressType address) const {
+  for (int i = 0; i < nodes_count_; i++) {
+    if (nodes_[i].address == address) {
+      return nodes_[i].stats;
+    }
+  }
+  return {};
+}
+
+template <concepts::stream::ByteWritableStreamConcept Output,
+          int kMaxNodesCount>
+typename LogFrameDemultiplexer<Output, kMaxNodesCount>::Node_*
+LogFrameDemultiplexer<Output, kMaxNodesCount>::FindNode_(AddressType address) {
+  for (int i = 0; i < nodes_count_; i++) {
+    if (nodes_[i].address == address) {
+      return &nodes_[i];
+    }
+  }
+  return nullptr;
+}
+
+}  // namespace hydrolib::bus::datalink
@@ -0,0 +1,185 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+
+#include "hydrolib_binary_log_format.hpp"
+#include "hydrolib_bus_datalink_message.hpp"
+#include "hydrolib_bus_datalink_sequence.hpp"
+#include "hydrolib_clock_concepts.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_ring_queue.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::bus::datalink {
+
+// A log frame is a LogFrameHeader and then whole binary log records, so every
+// frame decodes on its own. The sequence is counted per sending node and lets
+// the receiver count lost log frames.
+struct LogFrameHeader {
+  std::byte tag;
+  uint8_t sequence;
+} __attribute__((__packed__));
+
+constexpr std::byte kLogFrameTag = std::byte('L');
+// Leaves room for the header of a sequenced stream.
+constexpr int kMaxLogFrameLength =
+    kMaxDataLength - static_cast<int>(sizeof(SequenceHeader));
+
+static_assert(kMaxLogFrameLength >=
+                  sizeof(LogFrameHeader) + logger::kMaxBinaryLogRecordLength,
+              "A log frame must hold at least one record");
+
+// Byte stream for the binary log records of a distributor, e.g. the Drain()
+// of a BinaryLogDistributor, that sends them as log frames to a datalink
+// stream of the mate. Writes only queue the bytes; Process() sends at most one
+// frame per call, once the next record would not fit or the oldest queued
+// bytes have waited max_delay, so calling it after the control traffic of a
+// cycle keeps logs from delaying it. Write() accepts a chunk as a whole or
+// returns 0, leaving the bytes to the distributor.
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+class LogFrameSink final {
+ public:
+  static_assert(kQueueCapacity >= kMaxLogFrameLength,
+                "Queue must hold at least one frame");
+
+  LogFrameSink(TxStream& stream, typename Clock::duration max_delay);
+  LogFrameSink(const LogFrameSink&) = delete;
+  LogFrameSink(LogFrameSink&&) = delete;
+  LogFrameSink& operator=(const LogFrameSink&) = delete;
+  LogFrameSink& operator=(LogFrameSink&&) = delete;
+  ~LogFrameSink() = default;
+
+  int Write(const void* source, unsigned length);
+
+  // Returns NO_DATA while the queued records wait for more to batch with.
+  ReturnCode Process();
+  // Sends a frame of the queued records without waiting for a full batch.
+  ReturnCode Flush();
+
+  [[nodiscard]] int GetQueuedBytes() const;
+  [[nodiscard]] int GetSentFrames() const;
+
+ private:
+  ReturnCode Send_(bool is_forced);
+
+  TxStream& stream_;
+  const typename Clock::duration max_delay_;
+
+  ring_queue::RingQueue<kQueueCapacity> queue_;
+  typename Clock::time_point first_queued_time_{};
+  uint8_t sequence_ = 0;
+  int sent_frames_ = 0;
+};
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int write(LogFrameSink<TxStream, Clock, kQueueCapacity>& sink,
+          const void* source, unsigned length);
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+LogFrameSink<TxStream, Clock, kQueueCapacity>::LogFrameSink(
+    TxStream& stream, typename Clock::duration max_delay)
+    : stream_(stream), max_delay_(max_delay) {}
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int LogFrameSink<TxStream, Clock, kQueueCapacity>::Write(const void* source,
+                                                         unsigned length) {
+  bool was_empty = queue_.IsEmpty();
+  if (queue_.Push(source, static_cast<int>(length)) != ReturnCode::OK) {
+    return 0;
+  }
+  if (was_empty) {
+    first_queued_time_ = Clock::now();
+  }
+  return static_cast<int>(length);
+}
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+ReturnCode LogFrameSink<TxStream, Clock, kQueueCapacity>::Process() {
+  return Send_(false);
+}
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+ReturnCode LogFrameSink<TxStream, Clock, kQueueCapacity>::Flush() {
+  return Send_(true);
+}
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int LogFrameSink<TxStream, Clock, kQueueCapacity>::GetQueuedBytes() const {
+  return queue_.GetLength();
+}
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int LogFrameSink<TxStream, Clock, kQueueCapacity>::GetSentFrames() const {
+  return sent_frames_;
+}
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+ReturnCode LogFrameSink<TxStream, Clock, kQueueCapacity>::Send_(
+    bool is_forced) {
+  if (queue_.IsEmpty()) {
+    return ReturnCode::OK;
+  }
+
+  constexpr int kMaxRecordsLength =
+      kMaxLogFrameLength - static_cast<int>(sizeof(LogFrameHeader));
+  int records_length = 0;
+  bool is_full = false;
+  logger::BinaryLogRecordHeader header{};
+  while (queue_.Read(&header, sizeof(header), records_length) ==
+         ReturnCode::OK) {
+    int record_length =
+        static_cast<int>(sizeof(header)) + header.payload_length;
+    if (records_length + record_length > kMaxRecordsLength) {
+      is_full = true;
+      break;
+    }
+    if (records_length + record_length > queue_.GetLength()) {
+      break;
+    }
+    records_length += record_length;
+  }
+  if (records_length == 0 && is_full) {
+    // Not a record; the stream is out of sync.
+    queue_.Clear();
+    return ReturnCode::ERROR;
+  }
+  bool is_due = Clock::now() - first_queued_time_ >= max_delay_;
+  if (records_length == 0 || !(is_full || is_due || is_forced)) {
+    return ReturnCode::NO_DATA;
+  }
+
+  std::array<std::byte, kMaxLogFrameLength> frame;
+  LogFrameHeader frame_header{.tag = kLogFrameTag, .sequence = sequence_};
+  std::memcpy(frame.data(), &frame_header, sizeof(frame_header));
+  queue_.Read(frame.data() + sizeof(frame_header), records_length, 0);
+  int frame_length = static_cast<int>(sizeof(frame_header)) + records_length;
+  if (write(stream_, frame.data(), frame_length) != frame_length) {
+    return ReturnCode::ERROR;
+  }
+  queue_.Pull(frame.data() + sizeof(frame_header), records_length);
+  first_queued_time_ = Clock::now();
+  sequence_++;
+  sent_frames_++;
+  return ReturnCode::OK;
+}
+
+template <concepts::stream::ByteWritableStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int write(LogFrameSink<TxStream, Clock, kQueueCapacity>& sink,
+          const void* source, unsigned length) {
+  return sink.Write(source, length);
+}
+
+}  // namespace hydrolib::bus::datalink
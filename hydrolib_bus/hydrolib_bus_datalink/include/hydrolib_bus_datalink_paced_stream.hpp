@@ -0,0 +1,167 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+#include "hydrolib_bus_datalink_stream.hpp"
+#include "hydrolib_clock_concepts.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_ring_queue.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::bus::datalink {
+// Limits the byte rate written to the underlying stream with a token bucket:
+// the bucket holds at most burst_size bytes and refills at bytes_per_second.
+// Frames are queued as a whole or rejected, so the serializer sees an
+// overflow instead of a truncated frame. Queued bytes are sent from Process(),
+// which returns NO_DATA while some of them are still waiting for tokens.
+// Both the rate and the burst size have to be positive.
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+class PacedStream final {
+ public:
+  PacedStream(TxStream& stream, int bytes_per_second, int burst_size);
+  PacedStream(const PacedStream&) = delete;
+  PacedStream(PacedStream&&) = delete;
+  PacedStream& operator=(const PacedStream&) = delete;
+  PacedStream& operator=(PacedStream&&) = delete;
+  ~PacedStream() = default;
+
+  static constexpr bool kHydrolibBusDatalinkStreamMarker = true;
+
+  int Read(std::span<std::byte> buffer);
+  int Write(std::span<const std::byte> data);
+
+  ReturnCode Process();
+
+  [[nodiscard]] int GetQueuedBytes() const;
+  [[nodiscard]] int GetRejectedFrames() const;
+
+ private:
+  static constexpr int64_t kNanosecondsPerSecond = 1'000'000'000;
+  static constexpr int kChunkSize = 32;
+
+  static int64_t GetMaxRefillTime(int bytes_per_second, int burst_size);
+
+  void Refill();
+
+  TxStream& stream_;
+
+  const int64_t bytes_per_second_;
+  const int64_t burst_size_;
+  const int64_t max_refill_time_;
+
+  int64_t tokens_;
+  int64_t credit_ = 0;
+  typename Clock::time_point last_refill_time_;
+
+  ring_queue::RingQueue<kQueueCapacity> queue_;
+  int rejected_frames_ = 0;
+};
+
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+PacedStream<TxStream, Clock, kQueueCapacity>::PacedStream(TxStream& stream,
+                                                          int bytes_per_second,
+                                                          int burst_size)
+    : stream_(stream),
+      bytes_per_second_(bytes_per_second),
+      burst_size_(burst_size),
+      max_refill_time_(GetMaxRefillTime(bytes_per_second, burst_size)),
+      tokens_(burst_size),
+      last_refill_time_(Clock::now()) {}
+
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int64_t PacedStream<TxStream, Clock, kQueueCapacity>::GetMaxRefillTime(
+    int bytes_per_second, int burst_size) {
+  assert(bytes_per_second > 0 && "pacing rate must be positive");
+  assert(burst_size > 0 && "burst size must be positive");
+  return (burst_size * kNanosecondsPerSecond + bytes_per_second - 1) /
+         bytes_per_second;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int PacedStream<TxStream, Clock, kQueueCapacity>::Read(
+    std::span<std::byte> buffer) {
+  return read(stream_, buffer.data(), buffer.size());
+}
+
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int PacedStream<TxStream, Clock, kQueueCapacity>::Write(
+    std::span<const std::byte> data) {
+  if (queue_.Push(data.data(), static_cast<int>(data.size())) !=
+      ReturnCode::OK) {
+    rejected_frames_++;
+    return 0;
+  }
+  if (Process() == ReturnCode::ERROR) {
+    return -1;
+  }
+  return static_cast<int>(data.size());
+}
+
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+ReturnCode PacedStream<TxStream, Clock, kQueueCapacity>::Process() {
+  if (queue_.IsEmpty()) {
+    return ReturnCode::OK;
+  }
+  Refill();
+
+  std::array<std::byte, kChunkSize> chunk{};
+  while (!queue_.IsEmpty() && tokens_ > 0) {
+    auto length = static_cast<int>(std::min<int64_t>(
+        {tokens_, queue_.GetLength(), static_cast<int64_t>(kChunkSize)}));
+    queue_.Read(chunk.data(), length, 0);
+    int written = write(stream_, chunk.data(), length);
+    if (written < 0) {
+      return ReturnCode::ERROR;
+    }
+    queue_.Pull(chunk.data(), written);
+    tokens_ -= written;
+    if (written < length) {
+      break;
+    }
+  }
+  return queue_.IsEmpty() ? ReturnCode::OK : ReturnCode::NO_DATA;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int PacedStream<TxStream, Clock, kQueueCapacity>::GetQueuedBytes() const {
+  return queue_.GetLength();
+}
+
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+int PacedStream<TxStream, Clock, kQueueCapacity>::GetRejectedFrames() const {
+  return rejected_frames_;
+}
+
+template <concepts::stream::ByteFullStreamConcept TxStream,
+          concepts::clock::ClockConcept Clock, int kQueueCapacity>
+void PacedStream<TxStream, Clock, kQueueCapacity>::Refill() {
+  auto now = Clock::now();
+  auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                     now - last_refill_time_)
+                     .count();
+  last_refill_time_ = now;
+
+  credit_ += std::min<int64_t>(elapsed, max_refill_time_) * bytes_per_second_;
+  tokens_ += credit_ / kNanosecondsPerSecond;
+  credit_ %= kNanosecondsPerSecond;
+  if (tokens_ >= burst_size_) {
+    tokens_ = burst_size_;
+    credit_ = 0;
+  }
+}
+
+}  // namespace hydrolib::bus::datalink
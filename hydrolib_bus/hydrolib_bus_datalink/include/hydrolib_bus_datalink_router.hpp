@@ -0,0 +1,227 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <span>
+#include <tuple>
+#include <utility>
+
+#include "hydrolib_bus_datalink_frame_reader.hpp"
+#include "hydrolib_bus_datalink_message.hpp"
+#include "hydrolib_clock_concepts.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::bus::datalink {
+// Connects several bus segments and forwards frames by destination address.
+// Frames are relayed byte for byte: the payload is never COBS-decoded and the
+// CRC is left for the final receiver to check. The Clock paces the rubbish
+// byte warnings of the ports.
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+class Router final {
+ public:
+  static constexpr int kPortsCount = sizeof...(Ports);
+  static constexpr int kNoRoute = -1;
+
+  struct Route {
+    AddressType address;
+    int port;
+  };
+
+  struct PortStats {
+    int rx_frames = 0;
+    int tx_frames = 0;
+    int rx_errors = 0;
+    int tx_errors = 0;
+    int dropped_frames = 0;
+  };
+
+  constexpr explicit Router(Logger& logger, Ports&... ports);
+  constexpr Router(std::span<const Route> routes, Logger& logger,
+                   Ports&... ports);
+  Router(const Router&) = delete;
+  Router(Router&&) = delete;
+  Router& operator=(const Router&) = delete;
+  Router& operator=(Router&&) = delete;
+  ~Router() = default;
+
+  constexpr ReturnCode SetRoute(AddressType address, int port);
+  [[nodiscard]] int GetRoute(AddressType address) const;
+
+  ReturnCode Process();
+
+  [[nodiscard]] PortStats GetPortStats(int port) const;
+
+ private:
+  template <typename Stream>
+  struct PortBinding {
+    Stream& stream;
+    Logger& logger;
+  };
+
+  template <typename Stream>
+  struct Port {
+    explicit Port(PortBinding<Stream> binding);
+
+    Stream& stream;
+    FrameReader<Stream, Logger, Clock> reader;
+  };
+
+  static constexpr int kAddressesCount = 256;
+
+  template <std::size_t... kIndexes>
+  ReturnCode ProcessPorts(std::index_sequence<kIndexes...> /*indexes*/);
+  template <std::size_t kIndex>
+  ReturnCode ProcessPort();
+
+  template <std::size_t... kIndexes>
+  void Transmit(int port, const MessageBuffer& frame,
+                std::index_sequence<kIndexes...> /*indexes*/);
+  template <std::size_t kIndex>
+  void TransmitOverPort(const MessageBuffer& frame);
+
+  Logger& logger_;
+
+  std::tuple<Port<Ports>...> ports_;
+  std::array<int, kAddressesCount> routes_{};
+  std::array<PortStats, kPortsCount> stats_{};
+};
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+constexpr Router<Logger, Clock, Ports...>::Router(Logger& logger,
+                                                  Ports&... ports)
+    : logger_(logger), ports_(PortBinding<Ports>{ports, logger}...) {
+  routes_.fill(kNoRoute);
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+constexpr Router<Logger, Clock, Ports...>::Router(
+    std::span<const Route> routes, Logger& logger, Ports&... ports)
+    : Router(logger, ports...) {
+  for (const auto& route : routes) {
+    SetRoute(route.address, route.port);
+  }
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+constexpr ReturnCode Router<Logger, Clock, Ports...>::SetRoute(
+    AddressType address, int port) {
+  if (port != kNoRoute && (port < 0 || port >= kPortsCount)) {
+    return ReturnCode::FAIL;
+  }
+  routes_[static_cast<std::size_t>(address)] = port;
+  return ReturnCode::OK;
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+int Router<Logger, Clock, Ports...>::GetRoute(AddressType address) const {
+  return routes_[static_cast<std::size_t>(address)];
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+ReturnCode Router<Logger, Clock, Ports...>::Process() {
+  return ProcessPorts(std::index_sequence_for<Ports...>{});
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+typename Router<Logger, Clock, Ports...>::PortStats
+Router<Logger, Clock, Ports...>::GetPortStats(int port) const {
+  return stats_[port];
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+template <std::size_t... kIndexes>
+ReturnCode Router<Logger, Clock, Ports...>::ProcessPorts(
+    std::index_sequence<kIndexes...> /*indexes*/) {
+  bool is_forwarded = false;
+  bool is_failed = false;
+  (
+      [&] {
+        auto result = ProcessPort<kIndexes>();
+        if (result == ReturnCode::OK) {
+          is_forwarded = true;
+        } else if (result == ReturnCode::ERROR) {
+          is_failed = true;
+        }
+      }(),
+      ...);
+  if (is_failed) {
+    return ReturnCode::ERROR;
+  }
+  return is_forwarded ? ReturnCode::OK : ReturnCode::NO_DATA;
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+template <std::size_t kIndex>
+ReturnCode Router<Logger, Clock, Ports...>::ProcessPort() {
+  auto& port = std::get<kIndex>(ports_);
+  auto& stats = stats_[kIndex];
+
+  auto result = port.reader.Process();
+  if (result == ReturnCode::FAIL) {
+    stats.rx_errors++;
+    return result;
+  }
+  if (result != ReturnCode::OK) {
+    return result;
+  }
+  stats.rx_frames++;
+
+  const auto& frame = port.reader.GetFrame();
+  auto route = GetRoute(frame.header.dest_address);
+  if (route == kNoRoute || route == static_cast<int>(kIndex)) {
+    if (route == kNoRoute) {
+      LOG_WARNING(logger_, "No route to {}",
+                  static_cast<int>(frame.header.dest_address));
+    }
+    stats.dropped_frames++;
+    return ReturnCode::OK;
+  }
+  Transmit(route, frame, std::index_sequence_for<Ports...>{});
+  return ReturnCode::OK;
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+template <std::size_t... kIndexes>
+void Router<Logger, Clock, Ports...>::Transmit(
+    int port, const MessageBuffer& frame,
+    std::index_sequence<kIndexes...> /*indexes*/) {
+  ((static_cast<int>(kIndexes) == port
+        ? (TransmitOverPort<kIndexes>(frame), true)
+        : false) ||
+   ...);
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+template <std::size_t kIndex>
+void Router<Logger, Clock, Ports...>::TransmitOverPort(
+    const MessageBuffer& frame) {
+  auto& stats = stats_[kIndex];
+  int res = write(std::get<kIndex>(ports_).stream, &frame, frame.header.length);
+  if (res != frame.header.length) {
+    stats.tx_errors++;
+    return;
+  }
+  stats.tx_frames++;
+}
+
+template <typename Logger, concepts::clock::ClockConcept Clock,
+          concepts::stream::ByteFullStreamConcept... Ports>
+template <typename Stream>
+Router<Logger, Clock, Ports...>::Port<Stream>::Port(
+    PortBinding<Stream> binding)
+    : stream(binding.stream), reader(binding.stream, binding.logger) {}
+
+}  // namespace hydrolib::bus::datalink
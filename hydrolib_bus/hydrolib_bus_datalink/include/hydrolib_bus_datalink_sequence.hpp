@@ -0,0 +1,115 @@
+#pragma once
+
+#include <cstdint>
+
+namespace hydrolib::bus::datalink {
+
+using SequenceType = uint8_t;
+
+struct SequenceHeader {
+  SequenceType sequence;
+  uint8_t flags;
+} __attribute__((__packed__));
+
+// Set on the first frame a manager sends to a mate, so the mate resyncs even
+// when the restart happened within the duplicate window.
+constexpr uint8_t kSequenceRestartFlag = 0x01;
+
+struct SequenceStats {
+  int received_packages = 0;
+  int lost_packages = 0;
+  int duplicated_packages = 0;
+  int reordered_packages = 0;
+  int mate_restarts = 0;
+};
+
+// Tracks the sequence numbers received from a single mate. The last
+// kWindowSize sequences are kept in a bitmap, so late frames are told apart
+// from duplicates. The first frame and every frame flagged as a restart
+// resync the tracker, except for a copy of the flagged frame that just arrived;
+// a frame older than the window is treated the same way, in case the flagged
+// frame was lost. Sequences before a resync point count
+// as seen, so a late frame only cancels a loss that was really counted.
+class SequenceTracker final {
+ public:
+  static constexpr int kWindowSize = 32;
+
+  SequenceTracker() = default;
+  SequenceTracker(const SequenceTracker&) = default;
+  SequenceTracker(SequenceTracker&&) = default;
+  SequenceTracker& operator=(const SequenceTracker&) = default;
+  SequenceTracker& operator=(SequenceTracker&&) = default;
+  ~SequenceTracker() = default;
+
+  bool Accept(SequenceType sequence, bool is_restart = false);
+
+  [[nodiscard]] const SequenceStats& GetStats() const;
+
+ private:
+  void Resync(SequenceType sequence);
+
+  bool is_synced_ = false;
+  bool is_at_restart_ = false;
+  SequenceType last_sequence_ = 0;
+  uint32_t window_ = 0;
+
+  SequenceStats stats_;
+};
+
+inline bool SequenceTracker::Accept(SequenceType sequence, bool is_restart) {
+  if (is_restart && is_at_restart_ && sequence == last_sequence_) {
+    stats_.duplicated_packages++;
+    return false;
+  }
+  if (!is_synced_ || is_restart) {
+    if (is_synced_) {
+      stats_.mate_restarts++;
+    }
+    Resync(sequence);
+    is_at_restart_ = is_restart;
+    return true;
+  }
+  is_at_restart_ = false;
+
+  auto distance =
+      static_cast<int8_t>(static_cast<SequenceType>(sequence - last_sequence_));
+  if (distance > 0) {
+    stats_.lost_packages += distance - 1;
+    window_ = distance >= kWindowSize ? 0 : window_ << distance;
+    window_ |= 1;
+    last_sequence_ = sequence;
+    stats_.received_packages++;
+    return true;
+  }
+
+  int age = -distance;
+  if (age >= kWindowSize) {
+    stats_.mate_restarts++;
+    Resync(sequence);
+    return true;
+  }
+
+  uint32_t mask = 1U << age;
+  if ((window_ & mask) != 0) {
+    stats_.duplicated_packages++;
+    return false;
+  }
+  window_ |= mask;
+  stats_.lost_packages--;
+  stats_.reordered_packages++;
+  stats_.received_packages++;
+  return true;
+}
+
+inline void SequenceTracker::Resync(SequenceType sequence) {
+  is_synced_ = true;
+  last_sequence_ = sequence;
+  window_ = UINT32_MAX;
+  stats_.received_packages++;
+}
+
+inline const SequenceStats& SequenceTracker::GetStats() const {
+  return stats_;
+}
+
+}  // namespace hydrolib::bus::datalink
@@ -23,6 +23,9 @@ class Serializer final {
   ~Serializer() = default;
 
   ReturnCode Process(AddressType dest_address, std::span<const std::byte> data);
+  ReturnCode Process(AddressType dest_address,
+                     std::span<const std::byte> prefix,
+                     std::span<const std::byte> data);
 
  private:
   const AddressType address_;
@@ -44,17 +47,25 @@ constexpr Serializer<TxStream, Logger>::Serializer(AddressType address,
 template <concepts::stream::ByteWritableStreamConcept TxStream, typename Logger>
 ReturnCode Serializer<TxStream, Logger>::Process(
     AddressType dest_address, std::span<const std::byte> data) {
+  return Process(dest_address, {}, data);
+}
+
+template <concepts::stream::ByteWritableStreamConcept TxStream, typename Logger>
+ReturnCode Serializer<TxStream, Logger>::Process(
+    AddressType dest_address, std::span<const std::byte> prefix,
+    std::span<const std::byte> data) {
+  auto data_length = prefix.size() + data.size();
   current_message_.header.dest_address = dest_address;
   current_message_.header.src_address = address_;
   current_message_.header.cobs_length = 0;
   current_message_.header.length = static_cast<uint8_t>(
-      sizeof(kMagicByte) + sizeof(MessageHeader) + data.size() + kCRCLength);
-  std::ranges::copy(data,
-                    static_cast<std::byte*>(current_message_.data_and_crc));
+      sizeof(kMagicByte) + sizeof(MessageHeader) + data_length + kCRCLength);
+  auto* data_begin = static_cast<std::byte*>(current_message_.data_and_crc);
+  std::ranges::copy(data, std::ranges::copy(prefix, data_begin).out);
   crc::CRC8 crc8;
   crc8.Next(std::as_bytes(std::span(&current_message_, 1))
                 .subspan(0, current_message_.header.length - kCRCLength));
-  current_message_.data_and_crc[data.size()] = crc8.Get();
+  current_message_.data_and_crc[data_length] = crc8.Get();
 
   current_message_.header.cobs_length = cobs::Encode<kMagicByte>(
       std::as_writable_bytes(std::span(&current_message_, 1))
@@ -7,42 +7,73 @@
 
 #include "hydrolib_bus_datalink_deserializer.hpp"
 #include "hydrolib_bus_datalink_message.hpp"
+#include "hydrolib_bus_datalink_sequence.hpp"
 #include "hydrolib_bus_datalink_serializer.hpp"
+#include "hydrolib_clock_concepts.hpp"
 #include "hydrolib_ring_queue.hpp"
 
 namespace hydrolib::bus::datalink {
+// With kIsSequenced every frame starts with a per-mate sequence header, so the
+// receiver can count lost, duplicated and reordered frames and notices a
+// restarted mate. Both sides of a link have to agree on it. The Clock paces
+// the rubbish byte warnings of the receiver.
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
-class StreamManager final {
+class BasicStreamManager final {
  public:
   template <AddressType kMateAddress>
   class Stream;
 
-  constexpr StreamManager(AddressType self_address, RxTxStream& stream,
-                          Logger& logger);
-  StreamManager(const StreamManager&) = delete;
-  StreamManager(StreamManager&&) = delete;
-  StreamManager& operator=(const StreamManager&) = delete;
-  StreamManager& operator=(StreamManager&&) = delete;
-  ~StreamManager() = default;
+  constexpr BasicStreamManager(AddressType self_address, RxTxStream& stream,
+                               Logger& logger);
+  BasicStreamManager(const BasicStreamManager&) = delete;
+  BasicStreamManager(BasicStreamManager&&) = delete;
+  BasicStreamManager& operator=(const BasicStreamManager&) = delete;
+  BasicStreamManager& operator=(BasicStreamManager&&) = delete;
+  ~BasicStreamManager() = default;
 
   ReturnCode Process();
   [[nodiscard]] int GetLostPackages() const;
+  [[nodiscard]] SequenceStats GetSequenceStats(AddressType mate_address) const
+    requires kIsSequenced;
 
  private:
   using SerializerType = Serializer<RxTxStream, Logger>;
-  using DeserializerType = Deserializer<RxTxStream, Logger>;
+  using DeserializerType = Deserializer<RxTxStream, Logger, Clock>;
   class RxManager;
 
+  static constexpr int kMatesCount = sizeof...(kMateAddresses);
+
+  static constexpr int GetMateIndex(AddressType mate_address);
+
+  ReturnCode Transmit(AddressType dest_address,
+                      std::span<const std::byte> data);
+
   DeserializerType deserializer_;
   SerializerType serializer_;
 
   RxManager rx_manager_;
+
+  std::array<SequenceType, kMatesCount> tx_sequences_{};
+  std::array<bool, kMatesCount> is_restart_sent_{};
 };
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, AddressType... kMateAddresses>
+using StreamManager =
+    BasicStreamManager<RxTxStream, Logger, Clock, false, kMateAddresses...>;
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, AddressType... kMateAddresses>
+using SequencedStreamManager =
+    BasicStreamManager<RxTxStream, Logger, Clock, true, kMateAddresses...>;
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
-class StreamManager<RxTxStream, Logger, kMateAddresses...>::RxManager final {
+class BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                         kMateAddresses...>::RxManager final {
  public:
   RxManager() = default;
   RxManager(const RxManager&) = delete;
@@ -54,26 +85,31 @@ class StreamManager<RxTxStream, Logger, kMateAddresses...>::RxManager final {
   void Push(MessageInfo info);
   std::span<std::byte> Pull(AddressType address, int length);
 
+  [[nodiscard]] SequenceStats GetSequenceStats(AddressType address) const;
+
  private:
   struct RxMailbox {
     AddressType address{};
     ring_queue::RingQueue<kMaxDataLength>
         queue;  // TODO(sea_jackal): make normal queue with MessageData
+    SequenceTracker sequence_tracker;
   };
 
   std::array<RxMailbox, sizeof...(kMateAddresses)> mailboxes_{
-      {kMateAddresses, ring_queue::RingQueue<kMaxDataLength>()}...};
+      {kMateAddresses, ring_queue::RingQueue<kMaxDataLength>(),
+       SequenceTracker{}}...};
   std::array<std::byte, kMaxDataLength>
       buffer_{};  // TODO(sea_jackal): remove after queue adding
 };
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
 template <AddressType kMateAddress>
-class StreamManager<RxTxStream, Logger, kMateAddresses...>::Stream final {
+class BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                         kMateAddresses...>::Stream final {
  public:
-  constexpr explicit Stream(
-      StreamManager<RxTxStream, Logger, kMateAddresses...>& stream_manager);
+  constexpr explicit Stream(BasicStreamManager& stream_manager);
   Stream(const Stream&) = default;
   Stream(Stream&&) = default;
   Stream& operator=(const Stream&) = default;
@@ -88,21 +124,26 @@ class StreamManager<RxTxStream, Logger, kMateAddresses...>::Stream final {
  private:
   static constexpr bool IsAddressValid();
 
-  StreamManager<RxTxStream, Logger, kMateAddresses...>* manager_ = nullptr;
+  BasicStreamManager* manager_ = nullptr;
 
   static_assert(IsAddressValid(), "Invalid mate address");
 };
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
-constexpr StreamManager<RxTxStream, Logger, kMateAddresses...>::StreamManager(
-    AddressType self_address, RxTxStream& stream, Logger& logger)
+constexpr BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                             kMateAddresses...>::
+    BasicStreamManager(AddressType self_address, RxTxStream& stream,
+                       Logger& logger)
     : deserializer_(self_address, stream, logger),
       serializer_(self_address, stream, logger) {}
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
-ReturnCode StreamManager<RxTxStream, Logger, kMateAddresses...>::Process() {
+ReturnCode BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                              kMateAddresses...>::Process() {
   auto result = deserializer_.Process();
   if (result == ReturnCode::OK) {
     auto message = static_cast<MessageInfo>(result);
@@ -113,19 +154,81 @@ ReturnCode StreamManager<RxTxStream, Logger, kMateAddresses...>::Process() {
 }
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
-int StreamManager<RxTxStream, Logger, kMateAddresses...>::GetLostPackages()
-    const {
+int BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                       kMateAddresses...>::GetLostPackages() const {
   return deserializer_.GetLostPackages();
 }
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
+          AddressType... kMateAddresses>
+SequenceStats
+BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced, kMateAddresses...>::
+    GetSequenceStats(AddressType mate_address) const
+  requires kIsSequenced
+{
+  return rx_manager_.GetSequenceStats(mate_address);
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
+          AddressType... kMateAddresses>
+constexpr int BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                                 kMateAddresses...>::
+    GetMateIndex(AddressType mate_address) {
+  std::array addresses = {kMateAddresses...};
+  return static_cast<int>(std::ranges::find(addresses, mate_address) -
+                          addresses.begin());
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
-void StreamManager<RxTxStream, Logger, kMateAddresses...>::RxManager::Push(
-    MessageInfo info) {
+ReturnCode
+BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced, kMateAddresses...>::
+    Transmit(AddressType dest_address, std::span<const std::byte> data) {
+  if constexpr (!kIsSequenced) {
+    return serializer_.Process(dest_address, data);
+  } else {
+    if (data.size() + sizeof(SequenceHeader) > kMaxDataLength) {
+      return ReturnCode::OVERFLOW;
+    }
+    int mate_index = GetMateIndex(dest_address);
+    SequenceHeader header{
+        .sequence = tx_sequences_[mate_index],
+        .flags = is_restart_sent_[mate_index] ? uint8_t{0}
+                                              : kSequenceRestartFlag};
+    auto result = serializer_.Process(
+        dest_address, std::as_bytes(std::span(&header, 1)), data);
+    tx_sequences_[mate_index]++;
+    is_restart_sent_[mate_index] = true;
+    return result;
+  }
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
+          AddressType... kMateAddresses>
+void BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                        kMateAddresses...>::RxManager::Push(MessageInfo info) {
   for (int i = 0; i < sizeof...(kMateAddresses); i++) {
     if (mailboxes_[i].address == info.src_address) {
       auto data = static_cast<std::span<const std::byte>>(info.data);
+      if constexpr (kIsSequenced) {
+        if (data.size() < sizeof(SequenceHeader)) {
+          return;
+        }
+        SequenceHeader header{};
+        std::memcpy(&header, data.data(), sizeof(header));
+        bool is_restart = (header.flags & kSequenceRestartFlag) != 0;
+        if (!mailboxes_[i].sequence_tracker.Accept(header.sequence,
+                                                   is_restart)) {
+          return;
+        }
+        data = data.subspan(sizeof(SequenceHeader));
+      }
       mailboxes_[i].queue.Push(data.data(), data.size());
       return;
     }
@@ -133,10 +236,12 @@ void StreamManager<RxTxStream, Logger, kMateAddresses...>::RxManager::Push(
 }
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
 std::span<std::byte>
-StreamManager<RxTxStream, Logger, kMateAddresses...>::RxManager::Pull(
-    AddressType address, int length) {
+BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                   kMateAddresses...>::RxManager::Pull(AddressType address,
+                                                       int length) {
   for (int i = 0; i < sizeof...(kMateAddresses); i++) {
     if (mailboxes_[i].address == address) {
       length = std::min(length, mailboxes_[i].queue.GetLength());
@@ -148,29 +253,48 @@ StreamManager<RxTxStream, Logger, kMateAddresses...>::RxManager::Pull(
 }
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
+          AddressType... kMateAddresses>
+SequenceStats
+BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced, kMateAddresses...>::
+    RxManager::GetSequenceStats(AddressType address) const {
+  for (const auto& mailbox : mailboxes_) {
+    if (mailbox.address == address) {
+      return mailbox.sequence_tracker.GetStats();
+    }
+  }
+  return {};
+}
+
+template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
 template <AddressType kMateAddress>
-constexpr StreamManager<RxTxStream, Logger, kMateAddresses...>::Stream<
-    kMateAddress>::Stream(StreamManager<RxTxStream, Logger, kMateAddresses...>&
-                              stream_manager)
+constexpr BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                             kMateAddresses...>::Stream<kMateAddress>::
+    Stream(BasicStreamManager& stream_manager)
     : manager_(&stream_manager) {}
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
 template <AddressType kMateAddress>
-int StreamManager<RxTxStream, Logger, kMateAddresses...>::Stream<
-    kMateAddress>::Read(std::span<std::byte> buffer) {
+int BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                       kMateAddresses...>::Stream<kMateAddress>::
+    Read(std::span<std::byte> buffer) {
   auto data = manager_->rx_manager_.Pull(kMateAddress, buffer.size());
   std::ranges::copy(data, buffer.begin());
   return data.size();
 }
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
 template <AddressType kMateAddress>
-int StreamManager<RxTxStream, Logger, kMateAddresses...>::Stream<
-    kMateAddress>::Write(std::span<const std::byte> data) {
-  auto result = manager_->serializer_.Process(kMateAddress, data);
+int BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced,
+                       kMateAddresses...>::Stream<kMateAddress>::
+    Write(std::span<const std::byte> data) {
+  auto result = manager_->Transmit(kMateAddress, data);
   if (result == ReturnCode::OK) {
     return static_cast<int>(data.size());
   }
@@ -178,10 +302,12 @@ int StreamManager<RxTxStream, Logger, kMateAddresses...>::Stream<
 }
 
 template <concepts::stream::ByteFullStreamConcept RxTxStream, typename Logger,
+          concepts::clock::ClockConcept Clock, bool kIsSequenced,
           AddressType... kMateAddresses>
 template <AddressType kMateAddress>
-constexpr bool StreamManager<RxTxStream, Logger, kMateAddresses...>::Stream<
-    kMateAddress>::IsAddressValid() {
+constexpr bool
+BasicStreamManager<RxTxStream, Logger, Clock, kIsSequenced, kMateAddresses...>::
+    Stream<kMateAddress>::IsAddressValid() {
   std::array addresses = {kMateAddresses...};
   return std::ranges::find(addresses, kMateAddress) != addresses.end();
 }
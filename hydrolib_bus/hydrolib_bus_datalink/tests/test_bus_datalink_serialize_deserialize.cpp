@@ -6,6 +6,7 @@
 #include "hydrolib_bus_datalink_deserializer.hpp"
 #include "hydrolib_bus_datalink_serializer.hpp"
 #include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
 #include "mock_stream.hpp"
 
 namespace {
@@ -23,7 +24,8 @@ class SerializeDeserialize : public ::testing::Test {
                                       decltype(hydrolib::logger::mock_logger)>
       serializer{kSerializerAddress, stream, hydrolib::logger::mock_logger};
   hydrolib::bus::datalink::Deserializer<hydrolib::streams::mock::MockByteStream,
-                                        decltype(hydrolib::logger::mock_logger)>
+                                        decltype(hydrolib::logger::mock_logger),
+                                        hydrolib::streams::mock::TestClock>
       deserializer{kDeserializerAddress, stream, hydrolib::logger::mock_logger};
 
   void SimpleExchange(const std::vector<std::byte>& data);
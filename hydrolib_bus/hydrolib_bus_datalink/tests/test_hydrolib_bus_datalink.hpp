@@ -5,6 +5,7 @@
 #include "hydrolib_bus_datalink_message.hpp"
 #include "hydrolib_bus_datalink_stream.hpp"
 #include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
 #include "mock_stream.hpp"
 
 class TestHydrolibBusDatalink : public ::testing::Test {
@@ -26,11 +27,13 @@ class TestHydrolibBusDatalink : public ::testing::Test {
 
   hydrolib::bus::datalink::StreamManager<
       hydrolib::streams::mock::MockByteStream,
-      decltype(hydrolib::logger::mock_logger), kDeserializerAddress>
+      decltype(hydrolib::logger::mock_logger),
+      hydrolib::streams::mock::TestClock, kDeserializerAddress>
       sender_manager{kSerializerAddress, stream, hydrolib::logger::mock_logger};
   hydrolib::bus::datalink::StreamManager<
       hydrolib::streams::mock::MockByteStream,
-      decltype(hydrolib::logger::mock_logger), kSerializerAddress>
+      decltype(hydrolib::logger::mock_logger),
+      hydrolib::streams::mock::TestClock, kSerializerAddress>
       receiver_manager{kDeserializerAddress, stream,
                        hydrolib::logger::mock_logger};
 
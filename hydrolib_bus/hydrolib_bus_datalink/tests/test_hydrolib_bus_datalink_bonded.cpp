@@ -0,0 +1,283 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <vector>
+
+#include "hydrolib_bus_datalink_bonded_stream.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "mock_stream.hpp"
+
+namespace {
+using TestClock = hydrolib::streams::mock::TestClock;
+
+class DuplexEnd {
+  friend int read(DuplexEnd& end, void* dest, unsigned length);
+  friend int write(DuplexEnd& end, const void* source, unsigned length);
+
+ public:
+  DuplexEnd(hydrolib::streams::mock::MockByteStream& rx,
+            hydrolib::streams::mock::MockByteStream& tx)
+      : rx_(rx), tx_(tx) {}
+
+  bool is_cut = false;
+  int write_limit = -1;
+
+ private:
+  hydrolib::streams::mock::MockByteStream& rx_;
+  hydrolib::streams::mock::MockByteStream& tx_;
+};
+
+int read(DuplexEnd& end, void* dest, unsigned length) {
+  end.rx_.MakeAllbytesAvailable();
+  return read(end.rx_, dest, length);
+}
+
+int write(DuplexEnd& end, const void* source, unsigned length) {
+  if (end.is_cut) {
+    return static_cast<int>(length);
+  }
+  if (end.write_limit >= 0 && static_cast<int>(length) > end.write_limit) {
+    length = end.write_limit;
+  }
+  return write(end.tx_, source, length);
+}
+
+class TestHydrolibBusDatalinkBonded : public ::testing::Test {
+ public:
+  static constexpr hydrolib::bus::datalink::AddressType kFirstAddress =
+      std::byte(3);
+  static constexpr hydrolib::bus::datalink::AddressType kSecondAddress =
+      std::byte(4);
+  static constexpr std::size_t kLinksCount = 2;
+
+  using Manager = hydrolib::bus::datalink::BondedStreamManager<
+      DuplexEnd, decltype(hydrolib::logger::mock_logger), TestClock,
+      kLinksCount, kSecondAddress>;
+  using MateManager = hydrolib::bus::datalink::BondedStreamManager<
+      DuplexEnd, decltype(hydrolib::logger::mock_logger), TestClock,
+      kLinksCount, kFirstAddress>;
+
+ protected:
+  TestHydrolibBusDatalinkBonded() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::WARNING);
+    TestClock::current_time = {};
+  }
+
+  void ProcessBoth() {
+    sender.Process();
+    receiver.Process();
+  }
+
+  void Send(int value) {
+    std::array<std::byte, 4> data{};
+    data.fill(static_cast<std::byte>(value));
+    ASSERT_EQ(write(tx_stream, data.data(), data.size()), data.size());
+  }
+
+  std::vector<int> ReceiveAll() {
+    std::vector<int> result;
+    std::array<std::byte, 4> data{};
+    while (read(rx_stream, data.data(), data.size()) == data.size()) {
+      result.push_back(static_cast<int>(data[0]));
+    }
+    return result;
+  }
+
+  std::array<hydrolib::streams::mock::MockByteStream, kLinksCount> forward{};
+  std::array<hydrolib::streams::mock::MockByteStream, kLinksCount> backward{};
+
+  std::array<DuplexEnd, kLinksCount> sender_ends{
+      DuplexEnd(backward[0], forward[0]), DuplexEnd(backward[1], forward[1])};
+  std::array<DuplexEnd, kLinksCount> receiver_ends{
+      DuplexEnd(forward[0], backward[0]), DuplexEnd(forward[1], backward[1])};
+
+  Manager sender{kFirstAddress,
+                 {&sender_ends[0], &sender_ends[1]},
+                 hydrolib::logger::mock_logger};
+  MateManager receiver{kSecondAddress,
+                       {&receiver_ends[0], &receiver_ends[1]},
+                       hydrolib::logger::mock_logger};
+
+  Manager::Stream<kSecondAddress> tx_stream{sender};
+  MateManager::Stream<kFirstAddress> rx_stream{receiver};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusDatalinkBonded, StripesOverAllLinks) {
+  for (int i = 0; i < 6; i++) {
+    Send(i);
+  }
+  EXPECT_EQ(sender.GetLinkStats(0).tx_frames, 3);
+  EXPECT_EQ(sender.GetLinkStats(1).tx_frames, 3);
+
+  for (int i = 0; i < 6; i++) {
+    receiver.Process();
+  }
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0, 1, 2, 3, 4, 5}));
+  EXPECT_EQ(receiver.GetLostPackages(), 0);
+  EXPECT_EQ(receiver.GetDuplicatedPackages(), 0);
+}
+
+TEST_F(TestHydrolibBusDatalinkBonded, ReordersSlowLink) {
+  Send(0);
+  Send(1);
+  Send(2);
+  Send(3);
+
+  auto slow_link_bytes = forward[0].GetSize();
+  std::vector<uint8_t> delayed;
+  for (std::size_t i = 0; i < slow_link_bytes; i++) {
+    delayed.push_back(forward[0][i]);
+  }
+  forward[0].Clear();
+
+  receiver.Process();
+  receiver.Process();
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{}));
+
+  write(forward[0], delayed.data(), delayed.size());
+  receiver.Process();
+  receiver.Process();
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(receiver.GetReorderedPackages(), 2);
+  EXPECT_EQ(receiver.GetLostPackages(), 0);
+}
+
+TEST_F(TestHydrolibBusDatalinkBonded, SuppressesDuplicates) {
+  Send(0);
+  auto frame_length = forward[0].GetSize();
+  std::vector<uint8_t> frame;
+  for (std::size_t i = 0; i < frame_length; i++) {
+    frame.push_back(forward[0][i]);
+  }
+  write(forward[1], frame.data(), frame.size());
+  Send(1);
+
+  for (int i = 0; i < 3; i++) {
+    receiver.Process();
+  }
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0, 1}));
+  EXPECT_EQ(receiver.GetDuplicatedPackages(), 1);
+}
+
+TEST_F(TestHydrolibBusDatalinkBonded, SkipsLostFrameAfterTimeout) {
+  Send(0);
+  Send(1);
+  forward[1].Clear();
+  Send(2);
+  Send(3);
+  Send(4);
+
+  for (int i = 0; i < 3; i++) {
+    receiver.Process();
+  }
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0}));
+
+  TestClock::current_time += MateManager::kReorderTimeout;
+  receiver.Process();
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{2, 3, 4}));
+  EXPECT_EQ(receiver.GetLostPackages(), 1);
+}
+
+TEST_F(TestHydrolibBusDatalinkBonded, FailsOverSilentLink) {
+  ProcessBoth();
+  sender_ends[1].is_cut = true;
+  receiver_ends[1].is_cut = true;
+
+  for (int step = 0; step < 10; step++) {
+    TestClock::current_time += Manager::kKeepalivePeriod;
+    ProcessBoth();
+  }
+  EXPECT_TRUE(sender.GetLinkStats(0).is_up);
+  EXPECT_FALSE(sender.GetLinkStats(1).is_up);
+  EXPECT_FALSE(receiver.GetLinkStats(1).is_up);
+  ReceiveAll();
+
+  auto silent_link_frames = sender.GetLinkStats(1).tx_frames;
+  for (int i = 0; i < 6; i++) {
+    Send(i);
+  }
+  EXPECT_EQ(sender.GetLinkStats(1).tx_frames, silent_link_frames);
+  for (int i = 0; i < 8; i++) {
+    receiver.Process();
+  }
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0, 1, 2, 3, 4, 5}));
+
+  sender_ends[1].is_cut = false;
+  receiver_ends[1].is_cut = false;
+  for (int step = 0; step < 3; step++) {
+    TestClock::current_time += Manager::kKeepalivePeriod;
+    ProcessBoth();
+  }
+  EXPECT_TRUE(sender.GetLinkStats(1).is_up);
+  EXPECT_TRUE(receiver.GetLinkStats(1).is_up);
+}
+
+TEST_F(TestHydrolibBusDatalinkBonded, DropsPartiallyWrittenFrame) {
+  ProcessBoth();
+  Send(0);
+  sender_ends[1].write_limit = 3;
+  std::array<std::byte, 4> data{};
+  data.fill(std::byte{1});
+  EXPECT_EQ(write(tx_stream, data.data(), data.size()), -1);
+  EXPECT_FALSE(sender.GetLinkStats(1).is_up);
+  EXPECT_EQ(sender.GetLinkStats(1).tx_errors, 1);
+  EXPECT_EQ(sender.GetLinkStats(0).tx_frames, 1);
+
+  sender_ends[1].write_limit = -1;
+  Send(2);
+  EXPECT_EQ(sender.GetLinkStats(0).tx_frames, 2);
+  ProcessBoth();
+  ProcessBoth();
+  EXPECT_TRUE(sender.GetLinkStats(1).is_up);
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0}));
+
+  TestClock::current_time += MateManager::kReorderTimeout;
+  receiver.Process();
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{2}));
+  EXPECT_EQ(receiver.GetLostPackages(), 1);
+}
+
+TEST_F(TestHydrolibBusDatalinkBonded, ResyncsToRestartedMate) {
+  constexpr int kFramesCount = 130;
+  std::vector<int> received;
+  for (int i = 0; i < kFramesCount; i++) {
+    Send(i);
+    receiver.Process();
+    receiver.Process();
+    auto frames = ReceiveAll();
+    received.insert(received.end(), frames.begin(), frames.end());
+  }
+  EXPECT_EQ(received.size(), kFramesCount);
+
+  Manager restarted_sender{kFirstAddress,
+                           {&sender_ends[0], &sender_ends[1]},
+                           hydrolib::logger::mock_logger};
+  Manager::Stream<kSecondAddress> restarted_stream{restarted_sender};
+  std::array<std::byte, 4> data{};
+  for (int i = 0; i < 4; i++) {
+    data.fill(static_cast<std::byte>(i));
+    ASSERT_EQ(write(restarted_stream, data.data(), data.size()), data.size());
+  }
+
+  // The first frame after the restart comes over the slow link.
+  std::vector<uint8_t> delayed;
+  for (std::size_t i = 0; i < forward[0].GetSize(); i++) {
+    delayed.push_back(forward[0][i]);
+  }
+  forward[0].Clear();
+  receiver.Process();
+  receiver.Process();
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{}));
+
+  write(forward[0], delayed.data(), delayed.size());
+  receiver.Process();
+  receiver.Process();
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0, 1, 2, 3}));
+  EXPECT_EQ(receiver.GetLostPackages(), 0);
+  EXPECT_EQ(receiver.GetDuplicatedPackages(), 0);
+}
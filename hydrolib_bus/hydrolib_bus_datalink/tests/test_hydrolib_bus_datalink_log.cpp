@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include "hydrolib_binary_log_distributor.hpp"
+#include "hydrolib_bus_datalink_deserializer.hpp"
+#include "hydrolib_bus_datalink_log_demultiplexer.hpp"
+#include "hydrolib_bus_datalink_log_sink.hpp"
+#include "hydrolib_bus_datalink_stream.hpp"
+#include "hydrolib_log_decoder.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_log_site.hpp"
+#include "hydrolib_logger.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "mock_sink_stream.hpp"
+#include "mock_stream.hpp"
+
+namespace {
+using namespace std::literals::chrono_literals;
+using hydrolib::ReturnCode;
+using hydrolib::bus::datalink::AddressType;
+using hydrolib::streams::mock::MockByteStream;
+using hydrolib::streams::mock::TextStream;
+using TestClock = hydrolib::streams::mock::TestClock;
+
+constexpr AddressType kTopsideAddress = std::byte(1);
+constexpr AddressType kPumpAddress = std::byte(2);
+constexpr AddressType kSonarAddress = std::byte(3);
+
+using LoggerType = decltype(hydrolib::logger::mock_logger);
+using Manager =
+    hydrolib::bus::datalink::StreamManager<MockByteStream, LoggerType,
+                                           TestClock, kTopsideAddress>;
+using TopsideStream = Manager::Stream<kTopsideAddress>;
+using Sink = hydrolib::bus::datalink::LogFrameSink<
+    TopsideStream, TestClock, 2 * hydrolib::bus::datalink::kMaxLogFrameLength>;
+using Distributor = hydrolib::logger::BinaryLogDistributor<1024, TestClock>;
+
+// A vehicle node that logs in binary and sends the records over the wire.
+struct Node {
+  Node(AddressType address, const char* name, MockByteStream& wire)
+      : manager(address, wire, hydrolib::logger::mock_logger),
+        logger(name, 0, distributor) {
+    distributor.SetFilter(0, hydrolib::logger::LogLevel::DEBUG);
+  }
+
+  Manager manager;
+  TopsideStream stream{manager};
+  Sink sink{stream, 100ms};
+  Distributor distributor;
+  hydrolib::logger::Logger<Distributor> logger;
+};
+
+class TestHydrolibBusDatalinkLog : public ::testing::Test {
+ protected:
+  TestHydrolibBusDatalinkLog() {
+    TestClock::current_time = {};
+    pump_decoder.SetLoggerName(0, "Pump");
+    sonar_decoder.SetLoggerName(0, "Sonar");
+    EXPECT_EQ(demultiplexer.AddNode(kPumpAddress, pump_decoder, pump_log),
+              ReturnCode::OK);
+    EXPECT_EQ(demultiplexer.AddNode(kSonarAddress, sonar_decoder, sonar_log),
+              ReturnCode::OK);
+  }
+
+  // Hands every frame on the wire to the demultiplexer, with the string table
+  // of the sites logged so far.
+  int Receive() {
+    TextStream table;
+    EXPECT_EQ(hydrolib::logger::WriteLogStringTable(table), ReturnCode::OK);
+    EXPECT_EQ(pump_decoder.LoadStringTable(table.text), ReturnCode::OK);
+    EXPECT_EQ(sonar_decoder.LoadStringTable(table.text), ReturnCode::OK);
+
+    wire.MakeAllbytesAvailable();
+    int frames_count = 0;
+    auto result = deserializer.Process();
+    while (result == ReturnCode::OK) {
+      auto message = static_cast<hydrolib::bus::datalink::MessageInfo>(result);
+      EXPECT_EQ(demultiplexer.Push(
+                    message.src_address,
+                    static_cast<std::span<std::byte>>(message.data)),
+                ReturnCode::OK);
+      frames_count++;
+      result = deserializer.Process();
+    }
+    return frames_count;
+  }
+
+  MockByteStream wire;
+  Node pump{kPumpAddress, "Pump", wire};
+  Node sonar{kSonarAddress, "Sonar", wire};
+
+  hydrolib::bus::datalink::Deserializer<MockByteStream, LoggerType, TestClock>
+      deserializer{kTopsideAddress, wire, hydrolib::logger::mock_logger};
+  hydrolib::logger::LogDecoder pump_decoder;
+  hydrolib::logger::LogDecoder sonar_decoder;
+  TextStream pump_log;
+  TextStream sonar_log;
+  hydrolib::bus::datalink::LogFrameDemultiplexer<TextStream, 4> demultiplexer{
+      "[%s] [%l] %m\n"};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusDatalinkLog, BatchesRecordsUntilDelay) {
+  LOG_INFO(pump.logger, "Speed {}", 1200);
+  LOG_WARNING(pump.logger, "Current {}", 7);
+  pump.distributor.Drain(pump.sink);
+  EXPECT_EQ(pump.sink.Process(), ReturnCode::NO_DATA);
+  EXPECT_EQ(Receive(), 0);
+
+  TestClock::current_time += 100ms;
+  EXPECT_EQ(pump.sink.Process(), ReturnCode::OK);
+  EXPECT_EQ(pump.sink.GetQueuedBytes(), 0);
+  EXPECT_EQ(Receive(), 1);
+  EXPECT_EQ(pump_log.text,
+            "[Pump] [INFO] Speed 1200\n[Pump] [WARNING] Current 7\n");
+}
+
+TEST_F(TestHydrolibBusDatalinkLog, SendsFullFramesAtOnce) {
+  constexpr int kRecordsCount = 30;
+  for (int i = 0; i < kRecordsCount; i++) {
+    LOG_DEBUG(sonar.logger, "Ping {}", i);
+  }
+  while (sonar.distributor.GetBufferedLength() != 0) {
+    sonar.distributor.Drain(sonar.sink);
+    EXPECT_EQ(sonar.sink.Process(), ReturnCode::OK);
+  }
+  EXPECT_EQ(sonar.sink.Flush(), ReturnCode::OK);
+  EXPECT_EQ(sonar.sink.Process(), ReturnCode::OK);
+
+  int frames_count = Receive();
+  EXPECT_EQ(frames_count, sonar.sink.GetSentFrames());
+  EXPECT_LT(frames_count, kRecordsCount / 4);
+  auto stats = demultiplexer.GetNodeStats(kSonarAddress);
+  EXPECT_EQ(stats.records, kRecordsCount);
+  EXPECT_EQ(stats.lost_frames, 0);
+  EXPECT_TRUE(sonar_log.text.starts_with("[Sonar] [DEBUG] Ping 0\n"));
+  EXPECT_TRUE(sonar_log.text.ends_with("[Sonar] [DEBUG] Ping 29\n"));
+}
+
+TEST_F(TestHydrolibBusDatalinkLog, SeparatesNodes) {
+  LOG_ERROR(pump.logger, "Stalled");
+  LOG_INFO(sonar.logger, "Range {}", 35);
+  pump.distributor.Drain(pump.sink);
+  sonar.distributor.Drain(sonar.sink);
+  EXPECT_EQ(sonar.sink.Flush(), ReturnCode::OK);
+  EXPECT_EQ(pump.sink.Flush(), ReturnCode::OK);
+
+  EXPECT_EQ(Receive(), 2);
+  EXPECT_EQ(pump_log.text, "[Pump] [ERROR] Stalled\n");
+  EXPECT_EQ(sonar_log.text, "[Sonar] [INFO] Range 35\n");
+}
+
+TEST_F(TestHydrolibBusDatalinkLog, CountsLostAndForeignFrames) {
+  for (int i = 0; i < 3; i++) {
+    LOG_INFO(pump.logger, "Tick {}", i);
+    pump.distributor.Drain(pump.sink);
+    EXPECT_EQ(pump.sink.Flush(), ReturnCode::OK);
+    if (i == 1) {
+      wire.Clear();
+    } else {
+      EXPECT_EQ(Receive(), 1);
+    }
+  }
+  EXPECT_EQ(pump_log.text, "[Pump] [INFO] Tick 0\n[Pump] [INFO] Tick 2\n");
+  EXPECT_EQ(demultiplexer.GetNodeStats(kPumpAddress).lost_frames, 1);
+
+  std::array<std::byte, 3> other_frame = {std::byte('C'), std::byte(0),
+                                          std::byte(0)};
+  EXPECT_EQ(demultiplexer.Push(kPumpAddress, other_frame), ReturnCode::FAIL);
+  std::array<std::byte, 3> broken_frame = {
+      hydrolib::bus::datalink::kLogFrameTag, std::byte(3), std::byte(0)};
+  EXPECT_EQ(demultiplexer.Push(kPumpAddress, broken_frame), ReturnCode::ERROR);
+  EXPECT_EQ(demultiplexer.Push(std::byte(9), broken_frame), ReturnCode::FAIL);
+  EXPECT_EQ(demultiplexer.GetNodeStats(kPumpAddress).malformed_frames, 1);
+}
@@ -0,0 +1,150 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <array>
+#include <chrono>
+#include <cstddef>
+
+#include "hydrolib_bus_datalink_paced_stream.hpp"
+#include "hydrolib_bus_datalink_serializer.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+
+namespace {
+using namespace std::literals::chrono_literals;
+
+using TestClock = hydrolib::streams::mock::TestClock;
+
+// Transceiver with a small hardware FIFO that is shifted out on the line at a
+// fixed byte rate. Bytes written into a full FIFO are lost.
+class SimulatedUart {
+  friend int read(SimulatedUart& uart, void* dest, unsigned length);
+  friend int write(SimulatedUart& uart, const void* source, unsigned length);
+
+ public:
+  SimulatedUart(int bytes_per_second, int fifo_size)
+      : bytes_per_second_(bytes_per_second), fifo_size_(fifo_size) {}
+
+  void Update() {
+    auto elapsed = TestClock::now() - last_update_;
+    last_update_ = TestClock::now();
+    credit_ += elapsed.count() * bytes_per_second_;
+    auto shifted = credit_ / 1'000'000'000;
+    credit_ %= 1'000'000'000;
+    if (shifted >= fifo_length_) {
+      transmitted_bytes += fifo_length_;
+      fifo_length_ = 0;
+      credit_ = 0;
+    } else {
+      transmitted_bytes += shifted;
+      fifo_length_ -= shifted;
+    }
+  }
+
+  int64_t transmitted_bytes = 0;
+  int64_t overrun_bytes = 0;
+
+ private:
+  int64_t bytes_per_second_;
+  int64_t fifo_size_;
+  int64_t fifo_length_ = 0;
+  int64_t credit_ = 0;
+  TestClock::time_point last_update_{};
+};
+
+int read(SimulatedUart& /*uart*/, void* /*dest*/, unsigned /*length*/) {
+  return 0;
+}
+
+int write(SimulatedUart& uart, const void* /*source*/, unsigned length) {
+  uart.Update();
+  auto accepted =
+      std::min<int64_t>(length, uart.fifo_size_ - uart.fifo_length_);
+  uart.fifo_length_ += accepted;
+  uart.overrun_bytes += length - accepted;
+  return static_cast<int>(length);
+}
+
+class TestHydrolibBusDatalinkPaced : public ::testing::Test {
+ public:
+  static constexpr int kBytesPerSecond = 11520;
+  static constexpr int kFifoSize = 16;
+  static constexpr auto kStep = 100us;
+  static constexpr auto kDuration = 1s;
+  static constexpr int kFrameDataLength = 32;
+
+ protected:
+  TestHydrolibBusDatalinkPaced() { TestClock::current_time = {}; }
+
+  template <typename Stream>
+  void RunSaturated(Stream& stream, auto process) {
+    hydrolib::bus::datalink::Serializer serializer(
+        std::byte(3), stream, hydrolib::logger::mock_logger);
+    std::array<std::byte, kFrameDataLength> data{};
+    for (auto time = 0us; time < kDuration; time += kStep) {
+      TestClock::current_time += kStep;
+      uart.Update();
+      process();
+      serializer.Process(std::byte(4), data);
+    }
+  }
+
+  SimulatedUart uart{kBytesPerSecond, kFifoSize};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusDatalinkPaced, UnpacedBurstsOverrunFifo) {
+  RunSaturated(uart, [] {});
+  EXPECT_GT(uart.overrun_bytes, 0);
+}
+
+TEST_F(TestHydrolibBusDatalinkPaced, NoOverrunsAtConfiguredRate) {
+  hydrolib::bus::datalink::PacedStream<SimulatedUart, TestClock, 512> paced(
+      uart, kBytesPerSecond, kFifoSize);
+  RunSaturated(paced, [&paced] { paced.Process(); });
+
+  EXPECT_EQ(uart.overrun_bytes, 0);
+  EXPECT_GT(paced.GetRejectedFrames(), 0);
+  auto line_capacity = static_cast<int64_t>(kBytesPerSecond) *
+                       std::chrono::duration_cast<std::chrono::seconds>(
+                           kDuration)
+                           .count();
+  EXPECT_GE(uart.transmitted_bytes, line_capacity - kFifoSize);
+}
+
+TEST_F(TestHydrolibBusDatalinkPaced, QueuesFramesUntilTokensArrive) {
+  hydrolib::bus::datalink::PacedStream<SimulatedUart, TestClock, 512> paced(
+      uart, kBytesPerSecond, kFifoSize);
+  std::array<std::byte, 40> frame{};
+  EXPECT_EQ(write(paced, frame.data(), frame.size()), frame.size());
+  EXPECT_EQ(paced.GetQueuedBytes(), frame.size() - kFifoSize);
+  EXPECT_EQ(paced.Process(), hydrolib::ReturnCode::NO_DATA);
+
+  TestClock::current_time += 10ms;
+  uart.Update();
+  EXPECT_EQ(paced.Process(), hydrolib::ReturnCode::NO_DATA);
+  EXPECT_EQ(paced.GetQueuedBytes(), frame.size() - 2 * kFifoSize);
+
+  TestClock::current_time += 10ms;
+  uart.Update();
+  EXPECT_EQ(paced.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(paced.GetQueuedBytes(), 0);
+  EXPECT_EQ(uart.overrun_bytes, 0);
+}
+
+TEST_F(TestHydrolibBusDatalinkPaced, RejectsFrameThatDoesNotFit) {
+  hydrolib::bus::datalink::PacedStream<SimulatedUart, TestClock, 64> paced(
+      uart, kBytesPerSecond, kFifoSize);
+  std::array<std::byte, 60> frame{};
+  EXPECT_EQ(write(paced, frame.data(), frame.size()), frame.size());
+  EXPECT_EQ(write(paced, frame.data(), frame.size()), 0);
+  EXPECT_EQ(paced.GetRejectedFrames(), 1);
+}
+
+TEST_F(TestHydrolibBusDatalinkPaced, RejectsNonPositiveRateAndBurst) {
+  using Paced =
+      hydrolib::bus::datalink::PacedStream<SimulatedUart, TestClock, 64>;
+  EXPECT_DEATH(Paced(uart, 0, kFifoSize), "rate");
+  EXPECT_DEATH(Paced(uart, -kBytesPerSecond, kFifoSize), "rate");
+  EXPECT_DEATH(Paced(uart, kBytesPerSecond, 0), "burst");
+}
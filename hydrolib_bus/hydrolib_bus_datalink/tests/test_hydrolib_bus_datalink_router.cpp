@@ -0,0 +1,192 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <iostream>
+#include <vector>
+
+#include "hydrolib_bus_datalink_router.hpp"
+#include "hydrolib_bus_datalink_stream.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "mock_stream.hpp"
+
+using TestClock = hydrolib::streams::mock::TestClock;
+
+namespace {
+class DuplexEnd {
+  friend int read(DuplexEnd& end, void* dest, unsigned length);
+  friend int write(DuplexEnd& end, const void* source, unsigned length);
+
+ public:
+  DuplexEnd(hydrolib::streams::mock::MockByteStream& rx,
+            hydrolib::streams::mock::MockByteStream& tx)
+      : rx_(rx), tx_(tx) {}
+
+ private:
+  hydrolib::streams::mock::MockByteStream& rx_;
+  hydrolib::streams::mock::MockByteStream& tx_;
+};
+
+int read(DuplexEnd& end, void* dest, unsigned length) {
+  end.rx_.MakeAllbytesAvailable();
+  return read(end.rx_, dest, length);
+}
+
+int write(DuplexEnd& end, const void* source, unsigned length) {
+  return write(end.tx_, source, length);
+}
+
+class TestHydrolibBusDatalinkRouter : public ::testing::Test {
+ public:
+  static constexpr hydrolib::bus::datalink::AddressType kVehicleAddress =
+      std::byte(3);
+  static constexpr hydrolib::bus::datalink::AddressType kToolAddress =
+      std::byte(4);
+  static constexpr int kVehiclePort = 0;
+  static constexpr int kToolPort = 1;
+
+  using RouterType =
+      hydrolib::bus::datalink::Router<decltype(hydrolib::logger::mock_logger),
+                                      TestClock, DuplexEnd, DuplexEnd>;
+  using VehicleManager = hydrolib::bus::datalink::StreamManager<
+      DuplexEnd, decltype(hydrolib::logger::mock_logger), TestClock,
+      kToolAddress>;
+  using ToolManager = hydrolib::bus::datalink::StreamManager<
+      DuplexEnd, decltype(hydrolib::logger::mock_logger), TestClock,
+      kVehicleAddress>;
+
+  static constexpr std::array<RouterType::Route, 2> kRoutes{
+      {{kVehicleAddress, kVehiclePort}, {kToolAddress, kToolPort}}};
+
+ protected:
+  TestHydrolibBusDatalinkRouter() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::WARNING);
+  }
+
+  void Send(int value) {
+    std::array<std::byte, 4> data{};
+    data.fill(static_cast<std::byte>(value));
+    ASSERT_EQ(write(tx_stream, data.data(), data.size()), data.size());
+  }
+
+  std::vector<int> ReceiveAll() {
+    while (tool.Process() == hydrolib::ReturnCode::OK) {
+    }
+    std::vector<int> result;
+    std::array<std::byte, 4> data{};
+    while (read(rx_stream, data.data(), data.size()) == data.size()) {
+      result.push_back(static_cast<int>(data[0]));
+    }
+    return result;
+  }
+
+  hydrolib::streams::mock::MockByteStream vehicle_uplink;
+  hydrolib::streams::mock::MockByteStream vehicle_downlink;
+  hydrolib::streams::mock::MockByteStream tool_uplink;
+  hydrolib::streams::mock::MockByteStream tool_downlink;
+
+  DuplexEnd vehicle_end{vehicle_downlink, vehicle_uplink};
+  DuplexEnd tool_end{tool_downlink, tool_uplink};
+  DuplexEnd router_vehicle_end{vehicle_uplink, vehicle_downlink};
+  DuplexEnd router_tool_end{tool_uplink, tool_downlink};
+
+  RouterType router{kRoutes, hydrolib::logger::mock_logger, router_vehicle_end,
+                    router_tool_end};
+
+  VehicleManager vehicle{kVehicleAddress, vehicle_end,
+                         hydrolib::logger::mock_logger};
+  ToolManager tool{kToolAddress, tool_end, hydrolib::logger::mock_logger};
+
+  VehicleManager::Stream<kToolAddress> tx_stream{vehicle};
+  ToolManager::Stream<kVehicleAddress> rx_stream{tool};
+};
+}  // namespace
+
+TEST_F(TestHydrolibBusDatalinkRouter, ForwardsByDestination) {
+  Send(1);
+  Send(2);
+  EXPECT_EQ(router.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(router.Process(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(router.Process(), hydrolib::ReturnCode::NO_DATA);
+
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{1, 2}));
+  EXPECT_EQ(router.GetPortStats(kVehiclePort).rx_frames, 2);
+  EXPECT_EQ(router.GetPortStats(kToolPort).tx_frames, 2);
+  EXPECT_EQ(router.GetPortStats(kVehiclePort).dropped_frames, 0);
+  EXPECT_TRUE(vehicle_downlink.IsEmpty());
+}
+
+TEST_F(TestHydrolibBusDatalinkRouter, RelaysFrameUnchanged) {
+  Send(7);
+  std::vector<uint8_t> sent;
+  for (std::size_t i = 0; i < vehicle_uplink.GetSize(); i++) {
+    sent.push_back(vehicle_uplink[i]);
+  }
+  router.Process();
+
+  std::vector<uint8_t> relayed;
+  for (std::size_t i = 0; i < tool_downlink.GetSize(); i++) {
+    relayed.push_back(tool_downlink[i]);
+  }
+  EXPECT_EQ(relayed, sent);
+}
+
+TEST_F(TestHydrolibBusDatalinkRouter, DropsUnroutedFrames) {
+  router.SetRoute(kToolAddress, RouterType::kNoRoute);
+  Send(1);
+  router.Process();
+
+  EXPECT_TRUE(tool_downlink.IsEmpty());
+  EXPECT_EQ(router.GetPortStats(kVehiclePort).rx_frames, 1);
+  EXPECT_EQ(router.GetPortStats(kVehiclePort).dropped_frames, 1);
+  EXPECT_EQ(router.GetPortStats(kToolPort).tx_frames, 0);
+}
+
+TEST_F(TestHydrolibBusDatalinkRouter, DropsFramesForIngressSegment) {
+  router.SetRoute(kToolAddress, kVehiclePort);
+  Send(1);
+  router.Process();
+
+  EXPECT_TRUE(vehicle_downlink.IsEmpty());
+  EXPECT_TRUE(tool_downlink.IsEmpty());
+  EXPECT_EQ(router.GetPortStats(kVehiclePort).dropped_frames, 1);
+}
+
+TEST_F(TestHydrolibBusDatalinkRouter, RejectsUnknownPort) {
+  EXPECT_EQ(router.SetRoute(kToolAddress, RouterType::kPortsCount),
+            hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(router.GetRoute(kToolAddress), kToolPort);
+}
+
+TEST_F(TestHydrolibBusDatalinkRouter, CountsBrokenFrames) {
+  std::array<uint8_t, 5> broken{0xAA, 4, 3, 0, 0};
+  write(vehicle_uplink, broken.data(), broken.size());
+  router.Process();
+  EXPECT_EQ(router.GetPortStats(kVehiclePort).rx_errors, 1);
+}
+
+TEST_F(TestHydrolibBusDatalinkRouter, Throughput) {
+  constexpr int kFramesCount = 10000;
+  hydrolib::logger::mock_distributor.SetAllFilters(
+      0, hydrolib::logger::LogLevel::CRITICAL);
+
+  std::array<std::byte, hydrolib::bus::datalink::kMaxDataLength> data{};
+  for (int i = 0; i < kFramesCount; i++) {
+    write(tx_stream, data.data(), data.size());
+  }
+
+  auto start = std::chrono::steady_clock::now();
+  while (router.Process() == hydrolib::ReturnCode::OK) {
+  }
+  auto elapsed = std::chrono::duration<double>(
+                     std::chrono::steady_clock::now() - start)
+                     .count();
+
+  EXPECT_EQ(router.GetPortStats(kToolPort).tx_frames, kFramesCount);
+  auto frames_per_second = static_cast<int>(kFramesCount / elapsed);
+  RecordProperty("frames_per_second", frames_per_second);
+  std::cout << "Router throughput: " << frames_per_second << " frames/s\n";
+}
@@ -0,0 +1,210 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <cstddef>
+#include <vector>
+
+#include "hydrolib_bus_datalink_sequence.hpp"
+#include "hydrolib_bus_datalink_stream.hpp"
+#include "hydrolib_logger_mock.hpp"
+#include "mock_clock.hpp"
+#include "mock_stream.hpp"
+
+namespace {
+class TestHydrolibBusDatalinkSequence : public ::testing::Test {
+ public:
+  static constexpr hydrolib::bus::datalink::AddressType kSenderAddress =
+      std::byte(3);
+  static constexpr hydrolib::bus::datalink::AddressType kReceiverAddress =
+      std::byte(4);
+
+  using SenderManager = hydrolib::bus::datalink::SequencedStreamManager<
+      hydrolib::streams::mock::MockByteStream,
+      decltype(hydrolib::logger::mock_logger),
+      hydrolib::streams::mock::TestClock, kReceiverAddress>;
+  using ReceiverManager = hydrolib::bus::datalink::SequencedStreamManager<
+      hydrolib::streams::mock::MockByteStream,
+      decltype(hydrolib::logger::mock_logger),
+      hydrolib::streams::mock::TestClock, kSenderAddress>;
+
+ protected:
+  TestHydrolibBusDatalinkSequence() {
+    hydrolib::logger::mock_distributor.SetAllFilters(
+        0, hydrolib::logger::LogLevel::WARNING);
+  }
+
+  std::vector<uint8_t> Send(int value) {
+    std::size_t begin = stream.GetSize();
+    std::array<std::byte, 4> data{};
+    data.fill(static_cast<std::byte>(value));
+    EXPECT_EQ(write(tx_stream, data.data(), data.size()), data.size());
+    std::vector<uint8_t> frame;
+    for (std::size_t i = begin; i < stream.GetSize(); i++) {
+      frame.push_back(stream[i]);
+    }
+    return frame;
+  }
+
+  std::vector<int> ReceiveAll() {
+    stream.MakeAllbytesAvailable();
+    while (receiver.Process() == hydrolib::ReturnCode::OK) {
+    }
+    std::vector<int> result;
+    std::array<std::byte, 4> data{};
+    while (read(rx_stream, data.data(), data.size()) == data.size()) {
+      result.push_back(static_cast<int>(data[0]));
+    }
+    return result;
+  }
+
+  hydrolib::streams::mock::MockByteStream stream;
+
+  SenderManager sender{kSenderAddress, stream, hydrolib::logger::mock_logger};
+  ReceiverManager receiver{kReceiverAddress, stream,
+                           hydrolib::logger::mock_logger};
+
+  SenderManager::Stream<kReceiverAddress> tx_stream{sender};
+  ReceiverManager::Stream<kSenderAddress> rx_stream{receiver};
+};
+}  // namespace
+
+TEST(TestHydrolibBusDatalinkSequenceTracker, CountsGaps) {
+  hydrolib::bus::datalink::SequenceTracker tracker;
+  EXPECT_TRUE(tracker.Accept(0));
+  EXPECT_TRUE(tracker.Accept(3));
+  EXPECT_EQ(tracker.GetStats().received_packages, 2);
+  EXPECT_EQ(tracker.GetStats().lost_packages, 2);
+}
+
+TEST(TestHydrolibBusDatalinkSequenceTracker, CountsLateFrameAsReordered) {
+  hydrolib::bus::datalink::SequenceTracker tracker;
+  EXPECT_TRUE(tracker.Accept(0));
+  EXPECT_TRUE(tracker.Accept(2));
+  EXPECT_TRUE(tracker.Accept(1));
+  EXPECT_EQ(tracker.GetStats().lost_packages, 0);
+  EXPECT_EQ(tracker.GetStats().reordered_packages, 1);
+}
+
+TEST(TestHydrolibBusDatalinkSequenceTracker, RejectsDuplicates) {
+  hydrolib::bus::datalink::SequenceTracker tracker;
+  EXPECT_TRUE(tracker.Accept(0));
+  EXPECT_TRUE(tracker.Accept(1));
+  EXPECT_FALSE(tracker.Accept(1));
+  EXPECT_FALSE(tracker.Accept(0));
+  EXPECT_EQ(tracker.GetStats().duplicated_packages, 2);
+  EXPECT_EQ(tracker.GetStats().received_packages, 2);
+}
+
+TEST(TestHydrolibBusDatalinkSequenceTracker, WrapsAround) {
+  hydrolib::bus::datalink::SequenceTracker tracker;
+  for (int i = 0; i < 600; i++) {
+    EXPECT_TRUE(tracker.Accept(static_cast<uint8_t>(i)));
+  }
+  EXPECT_EQ(tracker.GetStats().lost_packages, 0);
+  EXPECT_EQ(tracker.GetStats().duplicated_packages, 0);
+}
+
+TEST(TestHydrolibBusDatalinkSequenceTracker, FollowsRestartedMate) {
+  hydrolib::bus::datalink::SequenceTracker tracker;
+  for (int i = 0; i < 100; i++) {
+    tracker.Accept(static_cast<uint8_t>(i));
+  }
+  EXPECT_TRUE(tracker.Accept(0));
+  EXPECT_TRUE(tracker.Accept(1));
+  EXPECT_EQ(tracker.GetStats().lost_packages, 0);
+}
+
+TEST(TestHydrolibBusDatalinkSequenceTracker, SyncsOnFirstFrame) {
+  hydrolib::bus::datalink::SequenceTracker tracker;
+  EXPECT_TRUE(tracker.Accept(100));
+  EXPECT_TRUE(tracker.Accept(101));
+  EXPECT_EQ(tracker.GetStats().lost_packages, 0);
+  EXPECT_EQ(tracker.GetStats().received_packages, 2);
+}
+
+TEST(TestHydrolibBusDatalinkSequenceTracker, FollowsEarlyRestartWithFlag) {
+  hydrolib::bus::datalink::SequenceTracker tracker;
+  for (int i = 0; i < 5; i++) {
+    tracker.Accept(static_cast<uint8_t>(i));
+  }
+  EXPECT_TRUE(tracker.Accept(0, true));
+  EXPECT_TRUE(tracker.Accept(1));
+  EXPECT_TRUE(tracker.Accept(2));
+  EXPECT_EQ(tracker.GetStats().mate_restarts, 1);
+  EXPECT_EQ(tracker.GetStats().duplicated_packages, 0);
+  EXPECT_EQ(tracker.GetStats().lost_packages, 0);
+}
+
+TEST(TestHydrolibBusDatalinkSequenceTracker, NeverCountsNegativeLosses) {
+  hydrolib::bus::datalink::SequenceTracker tracker;
+  EXPECT_TRUE(tracker.Accept(5));
+  EXPECT_FALSE(tracker.Accept(3));
+  EXPECT_TRUE(tracker.Accept(7));
+  EXPECT_TRUE(tracker.Accept(6));
+  EXPECT_FALSE(tracker.Accept(4));
+  EXPECT_EQ(tracker.GetStats().lost_packages, 0);
+  EXPECT_EQ(tracker.GetStats().reordered_packages, 1);
+}
+
+TEST_F(TestHydrolibBusDatalinkSequence, DeliversInOrder) {
+  Send(1);
+  Send(2);
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{1, 2}));
+  auto stats = receiver.GetSequenceStats(kSenderAddress);
+  EXPECT_EQ(stats.received_packages, 2);
+  EXPECT_EQ(stats.lost_packages, 0);
+}
+
+TEST_F(TestHydrolibBusDatalinkSequence, DetectsLostFrame) {
+  Send(0);
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0}));
+  Send(1);
+  Send(2);
+  stream.Clear();
+  Send(3);
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{3}));
+  EXPECT_EQ(receiver.GetSequenceStats(kSenderAddress).lost_packages, 2);
+  EXPECT_EQ(receiver.GetLostPackages(), 0);
+}
+
+TEST_F(TestHydrolibBusDatalinkSequence, SuppressesDuplicatedFrame) {
+  auto frame = Send(1);
+  write(stream, frame.data(), frame.size());
+  Send(2);
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{1, 2}));
+  EXPECT_EQ(receiver.GetSequenceStats(kSenderAddress).duplicated_packages, 1);
+}
+
+TEST_F(TestHydrolibBusDatalinkSequence, DetectsReorderedFrame) {
+  Send(0);
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0}));
+  auto first = Send(1);
+  stream.Clear();
+  Send(2);
+  write(stream, first.data(), first.size());
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{2, 1}));
+  auto stats = receiver.GetSequenceStats(kSenderAddress);
+  EXPECT_EQ(stats.reordered_packages, 1);
+  EXPECT_EQ(stats.lost_packages, 0);
+}
+
+TEST_F(TestHydrolibBusDatalinkSequence, FollowsRestartedSender) {
+  for (int i = 0; i < 4; i++) {
+    Send(i);
+  }
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{0, 1, 2, 3}));
+
+  SenderManager restarted{kSenderAddress, stream,
+                          hydrolib::logger::mock_logger};
+  SenderManager::Stream<kReceiverAddress> restarted_stream{restarted};
+  for (int i = 10; i < 13; i++) {
+    std::array<std::byte, 4> data{};
+    data.fill(static_cast<std::byte>(i));
+    EXPECT_EQ(write(restarted_stream, data.data(), data.size()), data.size());
+  }
+  EXPECT_EQ(ReceiveAll(), (std::vector<int>{10, 11, 12}));
+  auto stats = receiver.GetSequenceStats(kSenderAddress);
+  EXPECT_EQ(stats.mate_restarts, 1);
+  EXPECT_EQ(stats.duplicated_packages, 0);
+  EXPECT_EQ(stats.lost_packages, 0);
+}
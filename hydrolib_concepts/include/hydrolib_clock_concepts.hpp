@@ -0,0 +1,13 @@
+#pragma once
+
+#include <chrono>
+#include <concepts>
+
+namespace hydrolib::concepts::clock {
+template <typename T>
+concept ClockConcept = requires {
+  typename T::duration;
+  typename T::time_point;
+  { T::now() } -> std::same_as<typename T::time_point>;
+};
+}  // namespace hydrolib::concepts::clock
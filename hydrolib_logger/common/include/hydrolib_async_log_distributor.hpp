@@ -0,0 +1,207 @@
+#ifndef HYDROLIB_ASYNC_LOG_DISTRIBUTOR_H_
+#define HYDROLIB_ASYNC_LOG_DISTRIBUTOR_H_
+
+#include <atomic>
+#include <cstdint>
+#include <tuple>
+#include <utility>
+
+#include "hydrolib_cstring.hpp"
+#include "hydrolib_log.hpp"
+#include "hydrolib_log_filter_table.hpp"
+#include "hydrolib_log_record_queue.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::logger {
+
+enum class LogOverflowPolicy { kDropNewest, kDropOldest };
+
+// Distributor that never writes to a stream from Notify(): the log is encoded
+// by a TextLogEncoder or a BinaryLogEncoder into a lock-free queue together
+// with the mask of the streams that accept it, and Drain() writes the queued
+// records out. Drain() belongs in the idle loop on MCU and in a LogDrainThread
+// on Linux; it must not run in several contexts at once. Notify() may be
+// called from any thread or interrupt. When the queue is full the newest or
+// the oldest record is dropped, by the overflow policy, and counted. Logger
+// IDs must be less than kMaxLoggersCount.
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+class AsyncLogDistributor {
+ public:
+  static constexpr unsigned MAX_LOGGERS_COUNT = kMaxLoggersCount;
+
+  constexpr AsyncLogDistributor(Encoder encoder, Streams &...streams);
+  AsyncLogDistributor(const AsyncLogDistributor &) = delete;
+  AsyncLogDistributor(AsyncLogDistributor &&) = delete;
+  AsyncLogDistributor &operator=(const AsyncLogDistributor &) = delete;
+  AsyncLogDistributor &operator=(AsyncLogDistributor &&) = delete;
+  ~AsyncLogDistributor() = default;
+
+ public:
+  template <typename... Ts>
+  void Notify(unsigned source_id, Log<Ts...> &log, Ts... params) const;
+
+  ReturnCode SetFilter(unsigned stream_number, unsigned logger_id,
+                       LogLevel level);
+  ReturnCode SetAllFilters(unsigned logger_id, LogLevel level);
+  void SetOverflowPolicy(LogOverflowPolicy policy);
+
+  // Writes up to max_records queued records. Returns the number of written
+  // records.
+  int Drain(int max_records = kQueueLength);
+
+  [[nodiscard]] int GetQueuedCount() const;
+  [[nodiscard]] uint32_t GetDroppedCount() const;
+  [[nodiscard]] uint32_t GetFailedWriteCount() const;
+
+ private:
+  struct Record_ {
+    strings::CString<Encoder::kMaxRecordLength> bytes;
+    uint32_t stream_mask;
+  };
+
+  template <std::size_t... kIndices>
+  void Write_(const Record_ &record, std::index_sequence<kIndices...>);
+  template <concepts::stream::ByteWritableStreamConcept Stream>
+  void WriteTo_(Stream &stream, const Record_ &record);
+
+  const Encoder encoder_;
+  std::tuple<Streams &...> streams_;
+  LogFilterTable<sizeof...(Streams), kMaxLoggersCount> filters_;
+  std::atomic<LogOverflowPolicy> overflow_policy_ =
+      LogOverflowPolicy::kDropNewest;
+
+  // Loggers refer to their distributor as const.
+  mutable LogRecordQueue<Record_, kQueueLength> queue_;
+  mutable std::atomic<uint32_t> sequence_ = 0;
+  mutable std::atomic<uint32_t> dropped_count_ = 0;
+  std::atomic<uint32_t> failed_write_count_ = 0;
+};
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+constexpr AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                              Streams...>::
+    AsyncLogDistributor(Encoder encoder, Streams &...streams)
+    : encoder_(encoder), streams_(streams...) {}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+template <typename... Ts>
+void AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                         Streams...>::
+    Notify(unsigned source_id, Log<Ts...> &log, Ts... params) const {
+  auto stream_mask = filters_.GetStreamMask(source_id, log.level);
+  if (stream_mask == 0) {
+    return;
+  }
+  // Taken before queueing, so dropped records leave gaps in the sequence.
+  auto sequence = sequence_.fetch_add(1, std::memory_order_relaxed);
+  auto fill = [&](Record_ &record) {
+    record.bytes.Pop(record.bytes.GetLength());
+    encoder_.Encode(record.bytes, source_id, sequence, log, params...);
+    record.stream_mask = stream_mask;
+  };
+  if (queue_.Push(fill)) {
+    return;
+  }
+  if (overflow_policy_.load(std::memory_order_relaxed) ==
+      LogOverflowPolicy::kDropOldest) {
+    if (queue_.Pop([](Record_ &) {})) {
+      dropped_count_.fetch_add(1, std::memory_order_relaxed);
+    }
+    if (queue_.Push(fill)) {
+      return;
+    }
+  }
+  dropped_count_.fetch_add(1, std::memory_order_relaxed);
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+ReturnCode AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                               Streams...>::
+    SetFilter(unsigned stream_number, unsigned logger_id, LogLevel level) {
+  return filters_.Set(stream_number, logger_id, level);
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+ReturnCode AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                               Streams...>::
+    SetAllFilters(unsigned logger_id, LogLevel level) {
+  return filters_.SetAll(logger_id, level);
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+void AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                         Streams...>::
+    SetOverflowPolicy(LogOverflowPolicy policy) {
+  overflow_policy_.store(policy, std::memory_order_relaxed);
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+int AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                        Streams...>::
+    Drain(int max_records) {
+  int drained = 0;
+  while (drained < max_records && queue_.Pop([this](Record_ &record) {
+    Write_(record, std::index_sequence_for<Streams...>{});
+  })) {
+    drained++;
+  }
+  return drained;
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+int AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                        Streams...>::GetQueuedCount() const {
+  return queue_.GetLength();
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+uint32_t AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                             Streams...>::GetDroppedCount() const {
+  return dropped_count_.load(std::memory_order_relaxed);
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+uint32_t AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                             Streams...>::GetFailedWriteCount() const {
+  return failed_write_count_.load(std::memory_order_relaxed);
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+template <std::size_t... kIndices>
+void AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                         Streams...>::
+    Write_(const Record_ &record, std::index_sequence<kIndices...>) {
+  ((record.stream_mask & (uint32_t{1} << kIndices)
+        ? WriteTo_(std::get<kIndices>(streams_), record)
+        : void()),
+   ...);
+}
+
+template <typename Encoder, int kQueueLength, unsigned kMaxLoggersCount,
+          concepts::stream::ByteWritableStreamConcept... Streams>
+template <concepts::stream::ByteWritableStreamConcept Stream>
+void AsyncLogDistributor<Encoder, kQueueLength, kMaxLoggersCount,
+                         Streams...>::
+    WriteTo_(Stream &stream, const Record_ &record) {
+  int length = record.bytes.GetLength();
+  if (write(stream, static_cast<const char *>(record.bytes), length) !=
+      length) {
+    failed_write_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+}  // namespace hydrolib::logger
+
+#endif
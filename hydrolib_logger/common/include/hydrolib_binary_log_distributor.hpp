@@ -0,0 +1,137 @@
+#ifndef HYDROLIB_BINARY_LOG_DISTRIBUTOR_H_
+#define HYDROLIB_BINARY_LOG_DISTRIBUTOR_H_
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+
+#include "hydrolib_binary_log_record.hpp"
+#include "hydrolib_log.hpp"
+#include "hydrolib_log_encoder.hpp"
+#include "hydrolib_log_timestamp.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_ring_queue.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::logger {
+
+// Distributor for the deferred binary mode: Notify() only encodes the message
+// ID, the raw arguments, a sequence number and a timestamp into a ring buffer,
+// which Drain() later copies to a stream. The text is rebuilt offline by a
+// LogDecoder from the string table written by WriteLogStringTable(). Records
+// that do not fit into the buffer are dropped and counted; logs of logger IDs
+// from kMaxLoggersCount on are ignored. Notify() and Drain() must not run
+// concurrently; AsyncLogDistributor with a BinaryLogEncoder is the lock-free
+// alternative.
+template <int kCapacity, LogTimestampConcept Timestamp,
+          unsigned kMaxLoggersCount = 50>
+class BinaryLogDistributor {
+ public:
+  static_assert(kCapacity >= kMaxBinaryLogRecordLength,
+                "Buffer must hold at least one record");
+  static_assert(kMaxLoggersCount <= UINT8_MAX + 1,
+                "Logger IDs must fit into the record header");
+
+  constexpr BinaryLogDistributor() = default;
+  BinaryLogDistributor(const BinaryLogDistributor &) = delete;
+  BinaryLogDistributor(BinaryLogDistributor &&) = delete;
+  BinaryLogDistributor &operator=(const BinaryLogDistributor &) = delete;
+  BinaryLogDistributor &operator=(BinaryLogDistributor &&) = delete;
+  ~BinaryLogDistributor() = default;
+
+ public:
+  template <typename... Ts>
+  void Notify(unsigned source_id, Log<Ts...> &log, Ts... params) const;
+
+  ReturnCode SetFilter(unsigned logger_id, LogLevel level);
+
+  // Writes the buffered records to the stream. Returns the number of written
+  // bytes.
+  template <concepts::stream::ByteWritableStreamConcept Stream>
+  int Drain(Stream &stream);
+
+  [[nodiscard]] int GetBufferedLength() const;
+  [[nodiscard]] int GetDroppedCount() const;
+
+ private:
+  // Loggers refer to their distributor as const.
+  mutable ring_queue::RingQueue<kCapacity> queue_;
+  mutable int dropped_count_ = 0;
+  mutable uint32_t sequence_ = 0;
+
+  std::array<LogLevel, kMaxLoggersCount> level_filter_{};
+};
+
+template <int kCapacity, LogTimestampConcept Timestamp,
+          unsigned kMaxLoggersCount>
+template <typename... Ts>
+void BinaryLogDistributor<kCapacity, Timestamp, kMaxLoggersCount>::Notify(
+    unsigned source_id, Log<Ts...> &log, Ts... params) const {
+  if (source_id >= kMaxLoggersCount) {
+    return;
+  }
+  auto filter = level_filter_[source_id];
+  if (filter == LogLevel::NO_LEVEL || log.level < filter) {
+    return;
+  }
+  // Taken before queueing, so dropped records leave gaps in the sequence.
+  auto record = BinaryLogEncoder<Timestamp>::MakeRecord(source_id, sequence_++,
+                                                        log, params...);
+  if (queue_.Push(record.GetData(), record.GetLength()) != ReturnCode::OK) {
+    dropped_count_++;
+  }
+}
+
+template <int kCapacity, LogTimestampConcept Timestamp,
+          unsigned kMaxLoggersCount>
+ReturnCode
+BinaryLogDistributor<kCapacity, Timestamp, kMaxLoggersCount>::SetFilter(
+    unsigned logger_id, LogLevel level) {
+  if (logger_id >= kMaxLoggersCount) {
+    return ReturnCode::FAIL;
+  }
+  level_filter_[logger_id] = level;
+  return ReturnCode::OK;
+}
+
+template <int kCapacity, LogTimestampConcept Timestamp,
+          unsigned kMaxLoggersCount>
+template <concepts::stream::ByteWritableStreamConcept Stream>
+int BinaryLogDistributor<kCapacity, Timestamp, kMaxLoggersCount>::Drain(
+    Stream &stream) {
+  std::array<uint8_t, kMaxBinaryLogRecordLength> chunk;
+  int drained = 0;
+  while (!queue_.IsEmpty()) {
+    int length =
+        std::min(queue_.GetLength(), static_cast<int>(chunk.size()));
+    queue_.Read(chunk.data(), length, 0);
+    int written = write(stream, chunk.data(), length);
+    if (written <= 0) {
+      break;
+    }
+    queue_.Pull(chunk.data(), written);
+    drained += written;
+    if (written != length) {
+      break;
+    }
+  }
+  return drained;
+}
+
+template <int kCapacity, LogTimestampConcept Timestamp,
+          unsigned kMaxLoggersCount>
+int BinaryLogDistributor<kCapacity, Timestamp,
+                         kMaxLoggersCount>::GetBufferedLength() const {
+  return queue_.GetLength();
+}
+
+template <int kCapacity, LogTimestampConcept Timestamp,
+          unsigned kMaxLoggersCount>
+int BinaryLogDistributor<kCapacity, Timestamp,
+                         kMaxLoggersCount>::GetDroppedCount() const {
+  return dropped_count_;
+}
+
+}  // namespace hydrolib::logger
+
+#endif
@@ -0,0 +1,39 @@
+#ifndef HYDROLIB_BINARY_LOG_FORMAT_H_
+#define HYDROLIB_BINARY_LOG_FORMAT_H_
+
+#include <cstdint>
+
+namespace hydrolib::logger {
+
+// A binary log is a sequence of records: a BinaryLogRecordHeader and then
+// `payload_length` bytes of arguments. Every argument is a BinaryLogArgument
+// tag and its value: kInt and kUint are 4-byte integers, kInt64 and kUint64
+// 8-byte ones, kString a length byte and the characters. All fields are
+// little-endian and unaligned; the text comes back from the string table of
+// the message IDs. The sequence is counted per distributor, so gaps show
+// dropped records, and the timestamp is in raw ticks of the source of the
+// distributor.
+enum class BinaryLogArgument : uint8_t {
+  kInt = 1,
+  kString = 2,
+  kUint = 3,
+  kInt64 = 4,
+  kUint64 = 5
+};
+
+struct BinaryLogRecordHeader {
+  uint32_t message_id;
+  uint32_t sequence;
+  uint64_t timestamp;
+  uint8_t level;
+  uint8_t logger_id;
+  uint8_t payload_length;
+} __attribute__((__packed__));
+
+constexpr int kMaxBinaryLogPayloadLength = 64;
+constexpr int kMaxBinaryLogRecordLength =
+    sizeof(BinaryLogRecordHeader) + kMaxBinaryLogPayloadLength;
+
+}  // namespace hydrolib::logger
+
+#endif
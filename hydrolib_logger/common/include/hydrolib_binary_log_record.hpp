@@ -0,0 +1,111 @@
+#ifndef HYDROLIB_BINARY_LOG_RECORD_H_
+#define HYDROLIB_BINARY_LOG_RECORD_H_
+
+#include <algorithm>
+#include <array>
+#include <concepts>
+#include <cstdint>
+#include <cstring>
+
+#include "hydrolib_binary_log_format.hpp"
+#include "hydrolib_cstring.hpp"
+#include "hydrolib_log.hpp"
+
+namespace hydrolib::logger {
+
+// Encodes a log into the binary record format without formatting it: integers
+// and strings are copied as they are, only arguments with their own ToBytes()
+// are rendered to text. Arguments that do not fit into the payload are left
+// out together with all the following ones.
+class BinaryLogRecord {
+ public:
+  template <typename... Ts>
+  BinaryLogRecord(unsigned logger_id, uint32_t sequence, uint64_t timestamp,
+                  const Log<Ts...> &log, Ts... params);
+
+ public:
+  [[nodiscard]] const uint8_t *GetData() const;
+  [[nodiscard]] int GetLength() const;
+
+ private:
+  template <typename T>
+  void Append_(T param);
+  template <typename T>
+  void AppendInteger_(BinaryLogArgument tag, T value);
+  void AppendString_(const char *string, int length);
+
+  std::array<uint8_t, kMaxBinaryLogRecordLength> bytes_;
+  int length_ = sizeof(BinaryLogRecordHeader);
+  bool is_full_ = false;
+};
+
+template <typename... Ts>
+BinaryLogRecord::BinaryLogRecord(unsigned logger_id, uint32_t sequence,
+                                 uint64_t timestamp, const Log<Ts...> &log,
+                                 Ts... params) {
+  (Append_(params), ...);
+  BinaryLogRecordHeader header{
+      .message_id = log.site->GetId(),
+      .sequence = sequence,
+      .timestamp = timestamp,
+      .level = static_cast<uint8_t>(log.level),
+      .logger_id = static_cast<uint8_t>(logger_id),
+      .payload_length =
+          static_cast<uint8_t>(length_ - sizeof(BinaryLogRecordHeader))};
+  memcpy(bytes_.data(), &header, sizeof(header));
+}
+
+inline const uint8_t *BinaryLogRecord::GetData() const { return bytes_.data(); }
+
+inline int BinaryLogRecord::GetLength() const { return length_; }
+
+template <typename T>
+void BinaryLogRecord::Append_(T param) {
+  if constexpr (std::integral<T> && sizeof(T) <= sizeof(int32_t)) {
+    if constexpr (std::signed_integral<T>) {
+      AppendInteger_(BinaryLogArgument::kInt, static_cast<int32_t>(param));
+    } else {
+      AppendInteger_(BinaryLogArgument::kUint, static_cast<uint32_t>(param));
+    }
+  } else if constexpr (std::integral<T>) {
+    if constexpr (std::signed_integral<T>) {
+      AppendInteger_(BinaryLogArgument::kInt64, static_cast<int64_t>(param));
+    } else {
+      AppendInteger_(BinaryLogArgument::kUint64, static_cast<uint64_t>(param));
+    }
+  } else if constexpr (strings::StringConsept<T>) {
+    AppendString_(static_cast<const char *>(param), param.GetLength());
+  } else {
+    strings::CString<kMaxBinaryLogPayloadLength> text;
+    param.ToBytes(text);
+    AppendString_(text, text.GetLength());
+  }
+}
+
+template <typename T>
+void BinaryLogRecord::AppendInteger_(BinaryLogArgument tag, T value) {
+  constexpr int kLength = 1 + sizeof(T);
+  if (is_full_ || length_ + kLength > kMaxBinaryLogRecordLength) {
+    is_full_ = true;
+    return;
+  }
+  bytes_[length_] = static_cast<uint8_t>(tag);
+  memcpy(bytes_.data() + length_ + 1, &value, sizeof(value));
+  length_ += kLength;
+}
+
+inline void BinaryLogRecord::AppendString_(const char *string, int length) {
+  if (is_full_ || length_ + 2 > kMaxBinaryLogRecordLength) {
+    is_full_ = true;
+    return;
+  }
+  length = std::min(length, kMaxBinaryLogRecordLength - length_ - 2);
+  bytes_[length_] = static_cast<uint8_t>(BinaryLogArgument::kString);
+  bytes_[length_ + 1] = static_cast<uint8_t>(length);
+  memcpy(bytes_.data() + length_ + 2, string, length);
+  length_ += 2 + length;
+}
+
+}  // namespace hydrolib::logger
+
+#endif
@@ -5,6 +5,7 @@
 
 #include "hydrolib_cstring.hpp"
 #include "hydrolib_formatable_string.hpp"
+#include "hydrolib_log_site.hpp"
 #include "hydrolib_return_codes.hpp"
 
 namespace hydrolib::logger {
@@ -18,10 +19,20 @@ enum class LogLevel {
   CRITICAL = 5
 };
 
+#ifndef HYDROLIB_LOG_MIN_LEVEL
+#define HYDROLIB_LOG_MIN_LEVEL DEBUG
+#endif
+
+// Global floor: LOG statements below it are compiled out with their arguments.
+// Set by the LOG_MIN_LEVEL CMake option.
+constexpr LogLevel kMinLogLevel = LogLevel::HYDROLIB_LOG_MIN_LEVEL;
+
+class LogFormat;
+
 class LogInfo {
  public:
   constexpr static size_t MAX_NAME_LENGTH = 50;
-  constexpr static size_t MAX_FORMAT_STRING_LENGTH = 20;
+  constexpr static size_t MAX_FORMAT_STRING_LENGTH = 64;
   constexpr static int TRANSLATION_ERROR = -1;
 
   constexpr static char DEBUG_STR[] = "DEBUG";
@@ -31,15 +42,18 @@ class LogInfo {
   constexpr static char CRITICAL_STR[] = "CRITICAL";
 
  public:
-  enum SpecialSymbols { MESSAGE = 'm', SOURCE_PROCESS = 's', LEVEL = 'l' };
+  enum SpecialSymbols {
+    MESSAGE = 'm',
+    SOURCE_PROCESS = 's',
+    LEVEL = 'l',
+    TIMESTAMP = 't',
+    SEQUENCE = 'n'
+  };
 };
 
 template <typename... ArgTypes>
 class Log {
- public:
-  template <concepts::stream::ByteWritableStreamConcept DestType>
-  ReturnCode ToBytes(const char *format_string, DestType &buffer,
-                     ArgTypes... other) const;
+  friend class LogFormat;
 
  private:
   template <concepts::stream::ByteWritableStreamConcept DestType>
@@ -51,79 +65,13 @@ class Log {
   template <concepts::stream::ByteWritableStreamConcept DestType>
   ReturnCode TranslateSource_(DestType &buffer) const;
 
-  template <concepts::stream::ByteWritableStreamConcept DestType>
-  ReturnCode BurstWrite_(DestType &buffer, const char *burst_start,
-                         int &burst_length) const;
-
  public:
   strings::StaticFormatableString<ArgTypes...> message;
   LogLevel level;
   const strings::CString<LogInfo::MAX_NAME_LENGTH> *process_name;
+  LogSite *site;
 };
 
-template <typename... ArgTypes>
-template <concepts::stream::ByteWritableStreamConcept DestType>
-ReturnCode Log<ArgTypes...>::ToBytes(const char *format_string,
-                                     DestType &buffer,
-                                     ArgTypes... other) const {
-  unsigned format_index = 0;
-
-  const char *burst_start = nullptr;
-  int burst_length = 0;
-
-  while (format_string[format_index]) {
-    if (format_string[format_index] == '%') {
-      ReturnCode burst_res = BurstWrite_(buffer, burst_start, burst_length);
-      if (burst_res != ReturnCode::OK) {
-        return burst_res;
-      }
-
-      format_index++;
-
-      switch (format_string[format_index]) {
-        case LogInfo::SpecialSymbols::MESSAGE: {
-          ReturnCode message_res = TranslateMessage_(buffer, other...);
-          if (message_res != ReturnCode::OK) {
-            return message_res;
-          }
-          format_index++;
-          break;
-        }
-
-        case LogInfo::SpecialSymbols::LEVEL: {
-          ReturnCode level_res = TranslateLevel_(buffer);
-          if (level_res != ReturnCode::OK) {
-            return level_res;
-          }
-          format_index++;
-          break;
-        }
-        case LogInfo::SpecialSymbols::SOURCE_PROCESS: {
-          ReturnCode source_res = TranslateSource_(buffer);
-          if (source_res != ReturnCode::OK) {
-            return source_res;
-          }
-          format_index++;
-          break;
-        }
-        default:
-          return ReturnCode::ERROR;
-      }
-    } else {
-      if (burst_length == 0) {
-        burst_start = format_string + format_index;
-      }
-      burst_length++;
-      format_index++;
-    }
-  }
-  ReturnCode burst_res = BurstWrite_(buffer, burst_start, burst_length);
-  if (burst_res != ReturnCode::OK) {
-    return burst_res;
-  }
-  return ReturnCode::OK;
-}
-
 template <typename... ArgTypes>
 template <concepts::stream::ByteWritableStreamConcept DestType>
 ReturnCode Log<ArgTypes...>::TranslateMessage_(DestType &buffer,
@@ -186,24 +134,6 @@ ReturnCode Log<ArgTypes...>::TranslateSource_(DestType &buffer) const {
   return ReturnCode::OK;
 }
 
-template <typename... ArgTypes>
-template <concepts::stream::ByteWritableStreamConcept DestType>
-ReturnCode Log<ArgTypes...>::BurstWrite_(DestType &buffer,
-                                         const char *burst_start,
-                                         int &burst_length) const {
-  if (burst_length != 0) {
-    int res = write(buffer, burst_start, burst_length);
-    if (res == -1) {
-      return ReturnCode::OVERFLOW;
-    }
-    if (res != burst_length) {
-      return ReturnCode::ERROR;
-    }
-    burst_length = 0;
-  }
-  return ReturnCode::OK;
-}
-
 }  // namespace hydrolib::logger
 
 #endif
@@ -0,0 +1,286 @@
+#ifndef HYDROLIB_LOG_DECODER_H_
+#define HYDROLIB_LOG_DECODER_H_
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+#include <cstring>
+#include <span>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include "hydrolib_binary_log_format.hpp"
+#include "hydrolib_log.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::logger {
+
+// Host-side counterpart of the binary distributor: rebuilds log lines from
+// binary records and the string table of their message IDs.
+class LogDecoder {
+ public:
+  struct Record {
+    uint32_t message_id;
+    uint32_t sequence;
+    uint64_t timestamp;
+    LogLevel level;
+    unsigned logger_id;
+    std::string message;
+  };
+
+ public:
+  // Takes the lines written by WriteLogStringTable(). Fails on a malformed
+  // line or on an ID already known with another format.
+  ReturnCode LoadStringTable(std::string_view table);
+  ReturnCode AddMessage(uint32_t message_id, std::string_view format);
+  void SetLoggerName(unsigned logger_id, std::string_view name);
+  // Rate of the timestamp source of the records, e.g. the
+  // GetTicksPerSecond() of the node. Defaults to microseconds.
+  void SetTicksPerSecond(uint64_t ticks_per_second);
+
+  // Decodes the record at the start of the data. Returns its length, 0 when
+  // the record is not complete yet and -1 when it is malformed. A message
+  // missing from the string table is decoded as its ID.
+  int Decode(std::span<const uint8_t> data, Record &record) const;
+
+  // Renders the record with the same %s, %l, %m, %t, %n and %% fields as
+  // LogFormat.
+  [[nodiscard]] std::string Render(const Record &record,
+                                   std::string_view format) const;
+
+ private:
+  static const char *GetLevelName_(LogLevel level);
+  // Appends the integer argument with the tag. Returns its length, or 0 if
+  // the tag is not an integer or the value is cut off.
+  static int DecodeInteger_(BinaryLogArgument tag,
+                            std::span<const uint8_t> value, std::string &text);
+  template <typename T>
+  static int DecodeInteger_(std::span<const uint8_t> value, std::string &text);
+
+  std::unordered_map<uint32_t, std::string> formats_;
+  std::unordered_map<unsigned, std::string> logger_names_;
+  uint64_t ticks_per_second_ = 1000000;
+};
+
+inline ReturnCode LogDecoder::LoadStringTable(std::string_view table) {
+  while (!table.empty()) {
+    auto line_end = table.find('\n');
+    if (line_end == std::string_view::npos) {
+      return ReturnCode::FAIL;
+    }
+    auto line = table.substr(0, line_end);
+    table.remove_prefix(line_end + 1);
+
+    uint32_t message_id = 0;
+    auto [id_end, error] =
+        std::from_chars(line.data(), line.data() + line.size(), message_id, 16);
+    if (error != std::errc() || id_end != line.data() + 8 || line.size() < 9 ||
+        line[8] != ' ') {
+      return ReturnCode::FAIL;
+    }
+    std::string format;
+    for (std::size_t i = 9; i < line.size(); i++) {
+      if (line[i] != '\\') {
+        format.push_back(line[i]);
+      } else if (i + 1 < line.size() && line[i + 1] == 'n') {
+        format.push_back('\n');
+        i++;
+      } else if (i + 1 < line.size() && line[i + 1] == '\\') {
+        format.push_back('\\');
+        i++;
+      } else {
+        return ReturnCode::FAIL;
+      }
+    }
+    auto result = AddMessage(message_id, format);
+    if (result != ReturnCode::OK) {
+      return result;
+    }
+  }
+  return ReturnCode::OK;
+}
+
+inline ReturnCode LogDecoder::AddMessage(uint32_t message_id,
+                                         std::string_view format) {
+  auto [it, is_inserted] = formats_.emplace(message_id, format);
+  if (!is_inserted && it->second != format) {
+    return ReturnCode::FAIL;
+  }
+  return ReturnCode::OK;
+}
+
+inline void LogDecoder::SetLoggerName(unsigned logger_id,
+                                      std::string_view name) {
+  logger_names_[logger_id] = name;
+}
+
+inline void LogDecoder::SetTicksPerSecond(uint64_t ticks_per_second) {
+  ticks_per_second_ = ticks_per_second == 0 ? 1 : ticks_per_second;
+}
+
+inline int LogDecoder::Decode(std::span<const uint8_t> data,
+                              Record &record) const {
+  BinaryLogRecordHeader header;
+  if (data.size() < sizeof(header)) {
+    return 0;
+  }
+  memcpy(&header, data.data(), sizeof(header));
+  if (header.level < static_cast<uint8_t>(LogLevel::DEBUG) ||
+      header.level > static_cast<uint8_t>(LogLevel::CRITICAL) ||
+      header.payload_length > kMaxBinaryLogPayloadLength) {
+    return -1;
+  }
+  int length = sizeof(header) + header.payload_length;
+  if (data.size() < static_cast<std::size_t>(length)) {
+    return 0;
+  }
+  auto payload = data.subspan(sizeof(header), header.payload_length);
+
+  record.message_id = header.message_id;
+  record.sequence = header.sequence;
+  record.timestamp = header.timestamp;
+  record.level = static_cast<LogLevel>(header.level);
+  record.logger_id = header.logger_id;
+  record.message.clear();
+
+  auto format_it = formats_.find(header.message_id);
+  if (format_it == formats_.end()) {
+    std::array<char, 9> id = {};
+    std::to_chars(id.data(), id.data() + id.size(), header.message_id, 16);
+    record.message = "<unknown message 0x";
+    record.message += id.data();
+    record.message += ">";
+  }
+  std::string_view format =
+      format_it == formats_.end() ? std::string_view() : format_it->second;
+
+  std::size_t offset = 0;
+  while (true) {
+    auto param = format.find("{}");
+    record.message += format.substr(0, param);
+    if (param == std::string_view::npos) {
+      break;
+    }
+    format.remove_prefix(param + 2);
+    if (offset == payload.size()) {
+      record.message += "{}";
+      continue;
+    }
+    auto tag = static_cast<BinaryLogArgument>(payload[offset]);
+    int integer_length = DecodeInteger_(tag, payload.subspan(offset + 1),
+                                        record.message);
+    if (integer_length > 0) {
+      offset += 1 + integer_length;
+    } else if (tag == BinaryLogArgument::kString &&
+               offset + 2 <= payload.size() &&
+               offset + 2 + payload[offset + 1] <= payload.size()) {
+      record.message.append(
+          reinterpret_cast<const char *>(payload.data() + offset + 2),
+          payload[offset + 1]);
+      offset += 2 + payload[offset + 1];
+    } else {
+      return -1;
+    }
+  }
+  return length;
+}
+
+inline std::string LogDecoder::Render(const Record &record,
+                                      std::string_view format) const {
+  std::string line;
+  for (std::size_t i = 0; i < format.size(); i++) {
+    if (format[i] != '%' || i + 1 == format.size()) {
+      line.push_back(format[i]);
+      continue;
+    }
+    i++;
+    switch (format[i]) {
+      case LogInfo::SpecialSymbols::MESSAGE:
+        line += record.message;
+        break;
+      case LogInfo::SpecialSymbols::LEVEL:
+        line += GetLevelName_(record.level);
+        break;
+      case LogInfo::SpecialSymbols::SOURCE_PROCESS: {
+        auto name_it = logger_names_.find(record.logger_id);
+        if (name_it != logger_names_.end()) {
+          line += name_it->second;
+        } else {
+          line += std::to_string(record.logger_id);
+        }
+        break;
+      }
+      case LogInfo::SpecialSymbols::TIMESTAMP: {
+        auto microseconds = std::to_string(record.timestamp %
+                                           ticks_per_second_ * 1000000 /
+                                           ticks_per_second_);
+        line += std::to_string(record.timestamp / ticks_per_second_);
+        line.push_back('.');
+        line.append(6 - microseconds.size(), '0');
+        line += microseconds;
+        break;
+      }
+      case LogInfo::SpecialSymbols::SEQUENCE:
+        line += std::to_string(record.sequence);
+        break;
+      case '%':
+        line.push_back('%');
+        break;
+      default:
+        line.push_back('%');
+        line.push_back(format[i]);
+    }
+  }
+  return line;
+}
+
+inline int LogDecoder::DecodeInteger_(BinaryLogArgument tag,
+                                      std::span<const uint8_t> value,
+                                      std::string &text) {
+  switch (tag) {
+    case BinaryLogArgument::kInt:
+      return DecodeInteger_<int32_t>(value, text);
+    case BinaryLogArgument::kUint:
+      return DecodeInteger_<uint32_t>(value, text);
+    case BinaryLogArgument::kInt64:
+      return DecodeInteger_<int64_t>(value, text);
+    case BinaryLogArgument::kUint64:
+      return DecodeInteger_<uint64_t>(value, text);
+    default:
+      return 0;
+  }
+}
+
+template <typename T>
+int LogDecoder::DecodeInteger_(std::span<const uint8_t> value,
+                               std::string &text) {
+  T integer = 0;
+  if (value.size() < sizeof(integer)) {
+    return 0;
+  }
+  memcpy(&integer, value.data(), sizeof(integer));
+  text += std::to_string(integer);
+  return sizeof(integer);
+}
+
+inline const char *LogDecoder::GetLevelName_(LogLevel level) {
+  switch (level) {
+    case LogLevel::DEBUG:
+      return LogInfo::DEBUG_STR;
+    case LogLevel::INFO:
+      return LogInfo::INFO_STR;
+    case LogLevel::WARNING:
+      return LogInfo::WARNING_STR;
+    case LogLevel::ERROR:
+      return LogInfo::ERROR_STR;
+    case LogLevel::CRITICAL:
+      return LogInfo::CRITICAL_STR;
+    default:
+      return "";
+  }
+}
+
+}  // namespace hydrolib::logger
+
+#endif
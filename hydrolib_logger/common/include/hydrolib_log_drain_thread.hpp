@@ -0,0 +1,58 @@
+#ifndef HYDROLIB_LOG_DRAIN_THREAD_H_
+#define HYDROLIB_LOG_DRAIN_THREAD_H_
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+
+namespace hydrolib::logger {
+
+// Linux drain step of an AsyncLogDistributor: a thread that drains the queue
+// and sleeps for the period whenever it is empty. The destructor stops the
+// thread after a last drain.
+template <typename Distributor>
+class LogDrainThread {
+ public:
+  LogDrainThread(Distributor &distributor, std::chrono::microseconds period);
+  LogDrainThread(const LogDrainThread &) = delete;
+  LogDrainThread(LogDrainThread &&) = delete;
+  LogDrainThread &operator=(const LogDrainThread &) = delete;
+  LogDrainThread &operator=(LogDrainThread &&) = delete;
+  ~LogDrainThread();
+
+ private:
+  void Run_();
+
+  Distributor &distributor_;
+  const std::chrono::microseconds period_;
+  std::atomic<bool> is_running_ = true;
+  std::thread thread_;
+};
+
+template <typename Distributor>
+LogDrainThread<Distributor>::LogDrainThread(Distributor &distributor,
+                                            std::chrono::microseconds period)
+    : distributor_(distributor),
+      period_(period),
+      thread_(&LogDrainThread::Run_, this) {}
+
+template <typename Distributor>
+LogDrainThread<Distributor>::~LogDrainThread() {
+  is_running_.store(false, std::memory_order_relaxed);
+  thread_.join();
+}
+
+template <typename Distributor>
+void LogDrainThread<Distributor>::Run_() {
+  while (is_running_.load(std::memory_order_relaxed)) {
+    if (distributor_.Drain() == 0) {
+      std::this_thread::sleep_for(period_);
+    }
+  }
+  while (distributor_.Drain() != 0) {
+  }
+}
+
+}  // namespace hydrolib::logger
+
+#endif
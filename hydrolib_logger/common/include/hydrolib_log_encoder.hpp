@@ -0,0 +1,92 @@
+#ifndef HYDROLIB_LOG_ENCODER_H_
+#define HYDROLIB_LOG_ENCODER_H_
+
+#include <cstdint>
+
+#include "hydrolib_binary_log_format.hpp"
+#include "hydrolib_binary_log_record.hpp"
+#include "hydrolib_cstring.hpp"
+#include "hydrolib_log.hpp"
+#include "hydrolib_log_format.hpp"
+#include "hydrolib_log_timestamp.hpp"
+
+namespace hydrolib::logger {
+
+// Encoders turn a log into the bytes a deferred distributor queues: a text
+// line or a binary record. The record never exceeds kMaxRecordLength. The
+// sequence number is assigned by the distributor.
+class TextLogEncoder {
+ public:
+  static constexpr int kMaxRecordLength = 100;
+
+  consteval explicit TextLogEncoder(
+      LogFormat format, LogTimestampSource timestamp_source = {})
+      : format_(format), timestamp_source_(timestamp_source) {}
+
+ public:
+  template <typename... Ts>
+  void Encode(strings::CString<kMaxRecordLength> &record, unsigned source_id,
+              uint32_t sequence, Log<Ts...> &log, Ts... params) const;
+
+ private:
+  LogFormat format_;
+  LogTimestampSource timestamp_source_;
+};
+
+// Stamps records with raw ticks of the timestamp source, or of the clock.
+template <LogTimestampConcept Timestamp>
+class BinaryLogEncoder {
+ public:
+  static constexpr int kMaxRecordLength = kMaxBinaryLogRecordLength;
+
+  constexpr BinaryLogEncoder() = default;
+
+ public:
+  template <typename... Ts>
+  void Encode(strings::CString<kMaxRecordLength> &record, unsigned source_id,
+              uint32_t sequence, Log<Ts...> &log, Ts... params) const;
+
+  // Registers the site of the log for the string table and timestamps it.
+  template <typename... Ts>
+  static BinaryLogRecord MakeRecord(unsigned source_id, uint32_t sequence,
+                                    Log<Ts...> &log, Ts... params);
+};
+
+template <typename... Ts>
+void TextLogEncoder::Encode(strings::CString<kMaxRecordLength> &record,
+                            [[maybe_unused]] unsigned source_id,
+                            uint32_t sequence, Log<Ts...> &log,
+                            Ts... params) const {
+  LogLineFields fields = {
+      .sequence = sequence, .timestamp = 0, .ticks_per_second = 0};
+  if (format_.HasTimestamp() && timestamp_source_.now != nullptr) {
+    fields.timestamp = timestamp_source_.now();
+    fields.ticks_per_second = timestamp_source_.get_ticks_per_second();
+  }
+  format_.Render(record, log, fields, params...);
+}
+
+template <LogTimestampConcept Timestamp>
+template <typename... Ts>
+void BinaryLogEncoder<Timestamp>::Encode(
+    strings::CString<kMaxRecordLength> &record, unsigned source_id,
+    uint32_t sequence, Log<Ts...> &log, Ts... params) const {
+  auto binary_record = MakeRecord(source_id, sequence, log, params...);
+  record.Push(binary_record.GetData(), binary_record.GetLength());
+}
+
+template <LogTimestampConcept Timestamp>
+template <typename... Ts>
+BinaryLogRecord BinaryLogEncoder<Timestamp>::MakeRecord(unsigned source_id,
+                                                        uint32_t sequence,
+                                                        Log<Ts...> &log,
+                                                        Ts... params) {
+  log.site->Register();
+  return BinaryLogRecord(source_id, sequence,
+                         LogTimestampSourceOf<Timestamp>::Now(), log,
+                         params...);
+}
+
+}  // namespace hydrolib::logger
+
+#endif
@@ -0,0 +1,100 @@
+#ifndef HYDROLIB_LOG_FILTER_TABLE_H_
+#define HYDROLIB_LOG_FILTER_TABLE_H_
+
+#include <array>
+#include <cassert>
+#include <cstdint>
+#include <type_traits>
+
+#include "hydrolib_log.hpp"
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::logger {
+
+template <unsigned kStreamsCount>
+using LogStreamMask = std::conditional_t<
+    kStreamsCount <= 8, uint8_t,
+    std::conditional_t<kStreamsCount <= 16, uint16_t, uint32_t>>;
+
+// Level filters of every logger for every stream, packed as a bit matrix: for
+// each logger and level one bit per stream that accepts it. Choosing the
+// streams for a log is one lookup, and a logger takes five bytes with up to
+// eight streams. NO_LEVEL disables the logger on the stream.
+template <unsigned kStreamsCount, unsigned kMaxLoggersCount>
+class LogFilterTable {
+ public:
+  static_assert(kStreamsCount <= 32, "Stream mask must fit into 32 bits");
+
+  constexpr LogFilterTable() = default;
+
+ public:
+  ReturnCode Set(unsigned stream_number, unsigned logger_id, LogLevel level);
+  ReturnCode SetAll(unsigned logger_id, LogLevel level);
+
+  // Bit i is set if stream i accepts the level from the logger.
+  [[nodiscard]] uint32_t GetStreamMask(unsigned logger_id,
+                                       LogLevel level) const;
+
+ private:
+  static constexpr unsigned kLevelsCount =
+      static_cast<unsigned>(LogLevel::CRITICAL);
+
+  using Mask_ = LogStreamMask<kStreamsCount>;
+
+  void SetMaskBit_(unsigned stream_number, unsigned logger_id,
+                   LogLevel level);
+
+  std::array<std::array<Mask_, kLevelsCount>, kMaxLoggersCount> masks_{};
+};
+
+template <unsigned kStreamsCount, unsigned kMaxLoggersCount>
+ReturnCode LogFilterTable<kStreamsCount, kMaxLoggersCount>::Set(
+    unsigned stream_number, unsigned logger_id, LogLevel level) {
+  if (stream_number >= kStreamsCount || logger_id >= kMaxLoggersCount) {
+    return ReturnCode::FAIL;
+  }
+  SetMaskBit_(stream_number, logger_id, level);
+  return ReturnCode::OK;
+}
+
+template <unsigned kStreamsCount, unsigned kMaxLoggersCount>
+ReturnCode LogFilterTable<kStreamsCount, kMaxLoggersCount>::SetAll(
+    unsigned logger_id, LogLevel level) {
+  if (logger_id >= kMaxLoggersCount) {
+    return ReturnCode::FAIL;
+  }
+  for (unsigned i = 0; i < kStreamsCount; i++) {
+    SetMaskBit_(i, logger_id, level);
+  }
+  return ReturnCode::OK;
+}
+
+template <unsigned kStreamsCount, unsigned kMaxLoggersCount>
+uint32_t LogFilterTable<kStreamsCount, kMaxLoggersCount>::GetStreamMask(
+    unsigned logger_id, LogLevel level) const {
+  assert(logger_id < kMaxLoggersCount);
+  // NO_LEVEL wraps around and is accepted by no stream.
+  unsigned level_index = static_cast<unsigned>(level) - 1;
+  if (level_index >= kLevelsCount) {
+    return 0;
+  }
+  return masks_[logger_id][level_index];
+}
+
+template <unsigned kStreamsCount, unsigned kMaxLoggersCount>
+void LogFilterTable<kStreamsCount, kMaxLoggersCount>::SetMaskBit_(
+    unsigned stream_number, unsigned logger_id, LogLevel level) {
+  auto bit = static_cast<Mask_>(1U << stream_number);
+  for (unsigned i = 0; i < kLevelsCount; i++) {
+    auto row_level = static_cast<LogLevel>(i + 1);
+    if (level != LogLevel::NO_LEVEL && row_level >= level) {
+      masks_[logger_id][i] |= bit;
+    } else {
+      masks_[logger_id][i] &= static_cast<Mask_>(~bit);
+    }
+  }
+}
+
+}  // namespace hydrolib::logger
+
+#endif
@@ -0,0 +1,180 @@
+#ifndef HYDROLIB_LOG_FLIGHT_RECORDER_H_
+#define HYDROLIB_LOG_FLIGHT_RECORDER_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "hydrolib_binary_log_format.hpp"
+#include "hydrolib_cstring.hpp"
+#include "hydrolib_log.hpp"
+#include "hydrolib_log_encoder.hpp"
+#include "hydrolib_log_record_queue.hpp"
+#include "hydrolib_log_timestamp.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::logger {
+
+// Always-on distributor that keeps the last kRecordsCount logs of every level
+// as binary records, overwriting the oldest ones. Notify() never formats and
+// may be called from any thread or interrupt. The records are read out, oldest
+// first, by Dump() or as a readable stream, e.g. from a shell command or a
+// fault handler; they are decoded by a LogDecoder with the string table from
+// WriteLogStringTable(). Reading empties the recorder and must not run in
+// several contexts at once.
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+class LogFlightRecorder {
+ public:
+  constexpr LogFlightRecorder() = default;
+  LogFlightRecorder(const LogFlightRecorder &) = delete;
+  LogFlightRecorder(LogFlightRecorder &&) = delete;
+  LogFlightRecorder &operator=(const LogFlightRecorder &) = delete;
+  LogFlightRecorder &operator=(LogFlightRecorder &&) = delete;
+  ~LogFlightRecorder() = default;
+
+ public:
+  template <typename... Ts>
+  void Notify(unsigned source_id, Log<Ts...> &log, Ts... params) const;
+
+  // Writes the records to the stream. Returns the number of written bytes.
+  template <concepts::stream::ByteWritableStreamConcept Stream>
+  int Dump(Stream &stream);
+
+  // Copies up to length bytes of the records. Returns the number of copied
+  // bytes.
+  int Read(void *dest, unsigned length);
+
+  [[nodiscard]] int GetRecordedCount() const;
+  [[nodiscard]] uint32_t GetOverwrittenCount() const;
+  [[nodiscard]] uint32_t GetDroppedCount() const;
+
+ private:
+  using Record_ = strings::CString<kMaxBinaryLogRecordLength>;
+
+  // Makes sure the current record has unread bytes.
+  bool LoadRecord_();
+
+  // Loggers refer to their distributor as const.
+  mutable LogRecordQueue<Record_, kRecordsCount> queue_;
+  mutable std::atomic<uint32_t> overwritten_count_ = 0;
+  mutable std::atomic<uint32_t> dropped_count_ = 0;
+  mutable std::atomic<uint32_t> sequence_ = 0;
+
+  Record_ current_record_;
+  int current_offset_ = 0;
+};
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+int read(LogFlightRecorder<kRecordsCount, Timestamp> &recorder, void *dest,
+         unsigned length);
+
+// The recorder is filled by loggers only.
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+int write(LogFlightRecorder<kRecordsCount, Timestamp> &recorder,
+          const void *source, unsigned length);
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+template <typename... Ts>
+void LogFlightRecorder<kRecordsCount, Timestamp>::Notify(unsigned source_id,
+                                                         Log<Ts...> &log,
+                                                         Ts... params) const {
+  auto sequence = sequence_.fetch_add(1, std::memory_order_relaxed);
+  auto fill = [&](Record_ &record) {
+    record.Pop(record.GetLength());
+    BinaryLogEncoder<Timestamp>().Encode(record, source_id, sequence, log,
+                                         params...);
+  };
+  if (queue_.Push(fill)) {
+    return;
+  }
+  if (queue_.Pop([](Record_ &) {})) {
+    overwritten_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+  // Fails only when the oldest slots are held by interrupted producers.
+  if (!queue_.Push(fill)) {
+    dropped_count_.fetch_add(1, std::memory_order_relaxed);
+  }
+}
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+template <concepts::stream::ByteWritableStreamConcept Stream>
+int LogFlightRecorder<kRecordsCount, Timestamp>::Dump(Stream &stream) {
+  int dumped = 0;
+  while (LoadRecord_()) {
+    int length = current_record_.GetLength() - current_offset_;
+    int written = write(
+        stream, static_cast<const char *>(current_record_) + current_offset_,
+        length);
+    if (written <= 0) {
+      break;
+    }
+    current_offset_ += written;
+    dumped += written;
+    if (written != length) {
+      break;
+    }
+  }
+  return dumped;
+}
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+int LogFlightRecorder<kRecordsCount, Timestamp>::Read(void *dest,
+                                                       unsigned length) {
+  auto *bytes = static_cast<char *>(dest);
+  int copied = 0;
+  while (copied < static_cast<int>(length) && LoadRecord_()) {
+    int chunk_length =
+        std::min(current_record_.GetLength() - current_offset_,
+                 static_cast<int>(length) - copied);
+    memcpy(bytes + copied,
+           static_cast<const char *>(current_record_) + current_offset_,
+           chunk_length);
+    current_offset_ += chunk_length;
+    copied += chunk_length;
+  }
+  return copied;
+}
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+int LogFlightRecorder<kRecordsCount, Timestamp>::GetRecordedCount() const {
+  return queue_.GetLength();
+}
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+uint32_t LogFlightRecorder<kRecordsCount, Timestamp>::GetOverwrittenCount()
+    const {
+  return overwritten_count_.load(std::memory_order_relaxed);
+}
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+uint32_t LogFlightRecorder<kRecordsCount, Timestamp>::GetDroppedCount() const {
+  return dropped_count_.load(std::memory_order_relaxed);
+}
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+bool LogFlightRecorder<kRecordsCount, Timestamp>::LoadRecord_() {
+  if (current_offset_ < current_record_.GetLength()) {
+    return true;
+  }
+  current_offset_ = 0;
+  current_record_.Pop(current_record_.GetLength());
+  return queue_.Pop([this](Record_ &record) { current_record_ = record; });
+}
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+int read(LogFlightRecorder<kRecordsCount, Timestamp> &recorder, void *dest,
+         unsigned length) {
+  return recorder.Read(dest, length);
+}
+
+template <int kRecordsCount, LogTimestampConcept Timestamp>
+int write(
+    [[maybe_unused]] LogFlightRecorder<kRecordsCount, Timestamp> &recorder,
+    [[maybe_unused]] const void *source, [[maybe_unused]] unsigned length) {
+  return -1;
+}
+
+}  // namespace hydrolib::logger
+
+#endif
@@ -0,0 +1,219 @@
+#ifndef HYDROLIB_LOG_FORMAT_H_
+#define HYDROLIB_LOG_FORMAT_H_
+
+#include <array>
+#include <charconv>
+#include <cstdint>
+
+#include "hydrolib_cstring.hpp"
+#include "hydrolib_formatable_string.hpp"
+#include "hydrolib_log.hpp"
+#include "hydrolib_log_timestamp.hpp"
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::logger {
+
+// Per-line values of the %t and %n fields. The timestamp is in raw ticks of
+// its source.
+struct LogLineFields {
+  uint32_t sequence;
+  uint64_t timestamp;
+  uint64_t ticks_per_second;
+};
+
+// Layout of a log line, parsed at compile time into a plan of literal and
+// field segments, so rendering a line does not scan the format. Fields are
+// %s (logger name), %l (level), %m (message), %t (timestamp in seconds with
+// microseconds), %n (sequence number) and %% (percent sign).
+class LogFormat {
+ public:
+  static constexpr int kMaxSegmentsCount = 16;
+
+  consteval LogFormat(const char *format);  // NOLINT
+
+ public:
+  template <concepts::stream::ByteWritableStreamConcept DestType,
+            typename... Ts>
+  ReturnCode Render(DestType &buffer, const Log<Ts...> &log,
+                    const LogLineFields &fields, Ts... params) const;
+
+  [[nodiscard]] constexpr bool HasTimestamp() const;
+
+ private:
+  enum class SegmentKind : uint8_t {
+    kLiteral,
+    kMessage,
+    kLevel,
+    kSource,
+    kTimestamp,
+    kSequence
+  };
+
+  struct Segment {
+    SegmentKind kind;
+    uint8_t offset;
+    uint8_t length;
+  };
+
+  using Literals_ = std::array<char, LogInfo::MAX_FORMAT_STRING_LENGTH>;
+
+  consteval void AddLiteral_(Literals_ &literals, int &literals_length,
+                             char symbol);
+  consteval void AddField_(SegmentKind kind);
+
+  template <concepts::stream::ByteWritableStreamConcept DestType>
+  static ReturnCode Write_(DestType &buffer, const char *source, int length);
+  template <concepts::stream::ByteWritableStreamConcept DestType>
+  static ReturnCode WriteNumber_(DestType &buffer, uint64_t value,
+                                 int min_digits);
+
+  strings::CString<LogInfo::MAX_FORMAT_STRING_LENGTH> literals_;
+  std::array<Segment, kMaxSegmentsCount> segments_{};
+  int segments_count_ = 0;
+  bool has_timestamp_ = false;
+};
+
+consteval LogFormat::LogFormat(const char *format) {
+  Literals_ literals = {};
+  int literals_length = 0;
+  for (int i = 0; format[i] != '\0'; i++) {
+    if (format[i] != '%') {
+      AddLiteral_(literals, literals_length, format[i]);
+      continue;
+    }
+    i++;
+    switch (format[i]) {
+      case '%':
+        AddLiteral_(literals, literals_length, '%');
+        break;
+      case LogInfo::SpecialSymbols::MESSAGE:
+        AddField_(SegmentKind::kMessage);
+        break;
+      case LogInfo::SpecialSymbols::LEVEL:
+        AddField_(SegmentKind::kLevel);
+        break;
+      case LogInfo::SpecialSymbols::SOURCE_PROCESS:
+        AddField_(SegmentKind::kSource);
+        break;
+      case LogInfo::SpecialSymbols::TIMESTAMP:
+        AddField_(SegmentKind::kTimestamp);
+        has_timestamp_ = true;
+        break;
+      case LogInfo::SpecialSymbols::SEQUENCE:
+        AddField_(SegmentKind::kSequence);
+        break;
+      default:
+        strings::Error("Unknown field in log format");
+    }
+  }
+  literals_ = strings::CString<LogInfo::MAX_FORMAT_STRING_LENGTH>(
+      literals.data(), literals_length);
+}
+
+template <concepts::stream::ByteWritableStreamConcept DestType,
+          typename... Ts>
+ReturnCode LogFormat::Render(DestType &buffer, const Log<Ts...> &log,
+                             const LogLineFields &fields, Ts... params) const {
+  for (int i = 0; i < segments_count_; i++) {
+    const auto &segment = segments_[i];
+    ReturnCode result = ReturnCode::OK;
+    switch (segment.kind) {
+      case SegmentKind::kLiteral:
+        result = Write_(buffer, static_cast<const char *>(literals_) +
+                                    segment.offset,
+                        segment.length);
+        break;
+      case SegmentKind::kMessage:
+        result = log.TranslateMessage_(buffer, params...);
+        break;
+      case SegmentKind::kLevel:
+        result = log.TranslateLevel_(buffer);
+        break;
+      case SegmentKind::kSource:
+        result = log.TranslateSource_(buffer);
+        break;
+      case SegmentKind::kTimestamp: {
+        uint64_t ticks_per_second =
+            fields.ticks_per_second == 0 ? 1 : fields.ticks_per_second;
+        result = WriteNumber_(buffer, fields.timestamp / ticks_per_second, 1);
+        if (result == ReturnCode::OK) {
+          result = Write_(buffer, ".", 1);
+        }
+        if (result == ReturnCode::OK) {
+          result = WriteNumber_(
+              buffer,
+              fields.timestamp % ticks_per_second * 1000000 / ticks_per_second,
+              6);
+        }
+        break;
+      }
+      case SegmentKind::kSequence:
+        result = WriteNumber_(buffer, fields.sequence, 1);
+        break;
+    }
+    if (result != ReturnCode::OK) {
+      return result;
+    }
+  }
+  return ReturnCode::OK;
+}
+
+constexpr bool LogFormat::HasTimestamp() const { return has_timestamp_; }
+
+consteval void LogFormat::AddLiteral_(Literals_ &literals,
+                                     int &literals_length, char symbol) {
+  if (literals_length == static_cast<int>(literals.size())) {
+    strings::Error("Log format is too long");
+  }
+  if (segments_count_ == 0 ||
+      segments_[segments_count_ - 1].kind != SegmentKind::kLiteral) {
+    AddField_(SegmentKind::kLiteral);
+    segments_[segments_count_ - 1].offset =
+        static_cast<uint8_t>(literals_length);
+  }
+  literals[literals_length] = symbol;
+  literals_length++;
+  segments_[segments_count_ - 1].length++;
+}
+
+consteval void LogFormat::AddField_(SegmentKind kind) {
+  if (segments_count_ == kMaxSegmentsCount) {
+    strings::Error("Too many segments in log format");
+  }
+  segments_[segments_count_] = {.kind = kind, .offset = 0, .length = 0};
+  segments_count_++;
+}
+
+template <concepts::stream::ByteWritableStreamConcept DestType>
+ReturnCode LogFormat::Write_(DestType &buffer, const char *source,
+                             int length) {
+  int res = write(buffer, source, length);
+  if (res == -1) {
+    return ReturnCode::OVERFLOW;
+  }
+  if (res != length) {
+    return ReturnCode::ERROR;
+  }
+  return ReturnCode::OK;
+}
+
+template <concepts::stream::ByteWritableStreamConcept DestType>
+ReturnCode LogFormat::WriteNumber_(DestType &buffer, uint64_t value,
+                                   int min_digits) {
+  std::array<char, 20> digits = {};
+  auto result =
+      std::to_chars(digits.data(), digits.data() + digits.size(), value);
+  int length = static_cast<int>(result.ptr - digits.data());
+  for (int i = length; i < min_digits; i++) {
+    ReturnCode zero_res = Write_(buffer, "0", 1);
+    if (zero_res != ReturnCode::OK) {
+      return zero_res;
+    }
+  }
+  return Write_(buffer, digits.data(), length);
+}
+
+}  // namespace hydrolib::logger
+
+#endif
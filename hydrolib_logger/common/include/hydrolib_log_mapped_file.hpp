@@ -0,0 +1,287 @@
+#ifndef HYDROLIB_LOG_MAPPED_FILE_H_
+#define HYDROLIB_LOG_MAPPED_FILE_H_
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <mutex>
+#include <span>
+#include <string>
+#include <utility>
+
+#include "hydrolib_return_codes.hpp"
+
+namespace hydrolib::logger {
+
+// Every log file starts with a LogFileHeader and then `length` bytes of
+// records, as written by the distributor. Files are reused in turn, so the
+// one with the highest generation is the newest. Fields are in host order.
+struct LogFileHeader {
+  char magic[4];  // NOLINT
+  uint16_t version;
+  uint16_t header_length;
+  uint32_t generation;
+  uint32_t length;
+};
+
+static_assert(sizeof(LogFileHeader) == 16);
+
+constexpr LogFileHeader kLogFileHeader{.magic = {'H', 'L', 'O', 'G'},
+                                       .version = 1,
+                                       .header_length = sizeof(LogFileHeader),
+                                       .generation = 0,
+                                       .length = 0};
+
+// When the mapped pages are flushed to the disk, besides munmap() and the
+// kernel writeback.
+enum class LogFileSyncPolicy { NONE, ON_ROTATION, ON_WRITE };
+
+// Linux log sink over kFilesCount preallocated files of file_length bytes,
+// mapped at once: a write reserves its bytes with an atomic offset bump and
+// copies them into the mapping. A write that does not fit in the current file
+// moves to the next one, which drops its previous content. Writers may run
+// concurrently; the length in the header counts the completed writes.
+template <unsigned kFilesCount>
+class LogMappedFile {
+ public:
+  // The files are named `<path>.0` to `<path>.<kFilesCount - 1>`.
+  LogMappedFile(std::string path, uint32_t file_length,
+                LogFileSyncPolicy sync_policy);
+  LogMappedFile(const LogMappedFile &) = delete;
+  LogMappedFile(LogMappedFile &&) = delete;
+  LogMappedFile &operator=(const LogMappedFile &) = delete;
+  LogMappedFile &operator=(LogMappedFile &&) = delete;
+  ~LogMappedFile();
+
+ public:
+  // Creates or maps the files and starts a new generation after the newest
+  // one found, keeping the logs of the previous runs but the oldest file.
+  ReturnCode Open();
+
+  // Returns the number of written bytes or -1 if the data does not fit in a
+  // file or the files are not open.
+  int Write(const void *source, unsigned length);
+
+  // Flushes the current file to the disk.
+  ReturnCode Sync();
+
+  [[nodiscard]] uint32_t GetGeneration() const;
+
+ private:
+  struct File_ {
+    int fd = -1;
+    std::byte *mapping = nullptr;
+  };
+
+  static constexpr int kGenerationShift = 32;
+
+  [[nodiscard]] LogFileHeader &GetHeader_(uint32_t generation) const;
+  void Rotate_(uint32_t generation);
+  void Close_();
+
+  const std::string path_;
+  const uint32_t file_length_;
+  const LogFileSyncPolicy sync_policy_;
+
+  std::array<File_, kFilesCount> files_;
+  // Generation in the upper half and offset in the current file in the lower.
+  std::atomic<uint64_t> state_ = 0;
+  std::mutex rotation_mutex_;
+  bool is_open_ = false;
+};
+
+// Returns the records of a mapped log file, or an empty span if it does not
+// hold a log.
+std::span<const std::byte> GetLogFileRecords(std::span<const std::byte> file);
+
+template <unsigned kFilesCount>
+int write(LogMappedFile<kFilesCount> &file, const void *source,
+          unsigned length);
+
+template <unsigned kFilesCount>
+LogMappedFile<kFilesCount>::LogMappedFile(std::string path,
+                                          uint32_t file_length,
+                                          LogFileSyncPolicy sync_policy)
+    : path_(std::move(path)),
+      file_length_(file_length),
+      sync_policy_(sync_policy) {}
+
+template <unsigned kFilesCount>
+LogMappedFile<kFilesCount>::~LogMappedFile() {
+  if (is_open_ && sync_policy_ != LogFileSyncPolicy::NONE) {
+    Sync();
+  }
+  Close_();
+}
+
+template <unsigned kFilesCount>
+ReturnCode LogMappedFile<kFilesCount>::Open() {
+  if (is_open_ || file_length_ <= sizeof(LogFileHeader)) {
+    return ReturnCode::FAIL;
+  }
+  uint32_t newest_generation = 0;
+  unsigned newest_index = kFilesCount - 1;
+  for (unsigned i = 0; i < kFilesCount; i++) {
+    std::string name = path_ + "." + std::to_string(i);
+    files_[i].fd = open(name.c_str(), O_RDWR | O_CREAT, 0644);
+    if (files_[i].fd < 0 ||
+        posix_fallocate(files_[i].fd, 0, file_length_) != 0) {
+      Close_();
+      return ReturnCode::ERROR;
+    }
+    void *mapping = mmap(nullptr, file_length_, PROT_READ | PROT_WRITE,
+                         MAP_SHARED | MAP_POPULATE, files_[i].fd, 0);
+    if (mapping == MAP_FAILED) {
+      Close_();
+      return ReturnCode::ERROR;
+    }
+    files_[i].mapping = static_cast<std::byte *>(mapping);
+
+    auto *header = reinterpret_cast<LogFileHeader *>(mapping);
+    if (memcmp(header->magic, kLogFileHeader.magic,
+               sizeof(header->magic)) == 0 &&
+        header->generation >= newest_generation) {
+      newest_generation = header->generation;
+      newest_index = i;
+    }
+  }
+
+  // Generations map to files modulo kFilesCount, so the first one is chosen
+  // to land right after the newest file.
+  uint32_t generation = newest_generation + 1;
+  generation += (newest_index + 1 + kFilesCount - generation % kFilesCount) %
+                kFilesCount;
+  LogFileHeader &header = GetHeader_(generation);
+  header = kLogFileHeader;
+  header.generation = generation;
+  state_.store((static_cast<uint64_t>(generation) << kGenerationShift) |
+                   sizeof(LogFileHeader),
+               std::memory_order_release);
+  is_open_ = true;
+  return ReturnCode::OK;
+}
+
+template <unsigned kFilesCount>
+int LogMappedFile<kFilesCount>::Write(const void *source, unsigned length) {
+  if (!is_open_ || length > file_length_ - sizeof(LogFileHeader)) {
+    return -1;
+  }
+  uint64_t state = state_.load(std::memory_order_acquire);
+  while (true) {
+    auto offset = static_cast<uint32_t>(state);
+    if (offset + length <= file_length_) {
+      if (state_.compare_exchange_weak(state, state + length,
+                                       std::memory_order_acquire)) {
+        break;
+      }
+      continue;
+    }
+    Rotate_(static_cast<uint32_t>(state >> kGenerationShift));
+    state = state_.load(std::memory_order_acquire);
+  }
+
+  auto generation = static_cast<uint32_t>(state >> kGenerationShift);
+  auto offset = static_cast<uint32_t>(state);
+  std::byte *mapping = files_[generation % kFilesCount].mapping;
+  memcpy(mapping + offset, source, length);
+  std::atomic_ref<uint32_t>(GetHeader_(generation).length)
+      .fetch_add(length, std::memory_order_release);
+
+  if (sync_policy_ == LogFileSyncPolicy::ON_WRITE) {
+    auto page_length = static_cast<uint32_t>(sysconf(_SC_PAGESIZE));
+    uint32_t page_offset = offset - offset % page_length;
+    msync(mapping + page_offset, offset + length - page_offset, MS_SYNC);
+  }
+  return static_cast<int>(length);
+}
+
+template <unsigned kFilesCount>
+ReturnCode LogMappedFile<kFilesCount>::Sync() {
+  if (!is_open_) {
+    return ReturnCode::FAIL;
+  }
+  auto generation = static_cast<uint32_t>(
+      state_.load(std::memory_order_acquire) >> kGenerationShift);
+  if (msync(files_[generation % kFilesCount].mapping, file_length_, MS_SYNC) !=
+      0) {
+    return ReturnCode::ERROR;
+  }
+  return ReturnCode::OK;
+}
+
+template <unsigned kFilesCount>
+uint32_t LogMappedFile<kFilesCount>::GetGeneration() const {
+  return static_cast<uint32_t>(state_.load(std::memory_order_relaxed) >>
+                               kGenerationShift);
+}
+
+template <unsigned kFilesCount>
+LogFileHeader &LogMappedFile<kFilesCount>::GetHeader_(
+    uint32_t generation) const {
+  return *reinterpret_cast<LogFileHeader *>(
+      files_[generation % kFilesCount].mapping);
+}
+
+template <unsigned kFilesCount>
+void LogMappedFile<kFilesCount>::Rotate_(uint32_t generation) {
+  std::lock_guard lock(rotation_mutex_);
+  if (static_cast<uint32_t>(state_.load(std::memory_order_acquire) >>
+                            kGenerationShift) != generation) {
+    return;
+  }
+  if (sync_policy_ == LogFileSyncPolicy::ON_ROTATION) {
+    msync(files_[generation % kFilesCount].mapping, file_length_, MS_SYNC);
+  }
+  LogFileHeader &header = GetHeader_(generation + 1);
+  header = kLogFileHeader;
+  header.generation = generation + 1;
+  state_.store((static_cast<uint64_t>(generation + 1) << kGenerationShift) |
+                   sizeof(LogFileHeader),
+               std::memory_order_release);
+}
+
+template <unsigned kFilesCount>
+void LogMappedFile<kFilesCount>::Close_() {
+  for (auto &file : files_) {
+    if (file.mapping != nullptr) {
+      munmap(file.mapping, file_length_);
+      file.mapping = nullptr;
+    }
+    if (file.fd >= 0) {
+      close(file.fd);
+      file.fd = -1;
+    }
+  }
+  is_open_ = false;
+}
+
+inline std::span<const std::byte> GetLogFileRecords(
+    std::span<const std::byte> file) {
+  if (file.size() < sizeof(LogFileHeader)) {
+    return {};
+  }
+  LogFileHeader header{};
+  memcpy(&header, file.data(), sizeof(header));
+  if (memcmp(header.magic, kLogFileHeader.magic, sizeof(header.magic)) != 0 ||
+      header.header_length < sizeof(LogFileHeader) ||
+      header.header_length + header.length > file.size()) {
+    return {};
+  }
+  return file.subspan(header.header_length, header.length);
+}
+
+template <unsigned kFilesCount>
+int write(LogMappedFile<kFilesCount> &file, const void *source,
+          unsigned length) {
+  return file.Write(source, length);
+}
+
+}  // namespace hydrolib::logger
+
+#endif
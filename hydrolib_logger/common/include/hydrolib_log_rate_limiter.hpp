@@ -0,0 +1,84 @@
+#ifndef HYDROLIB_LOG_RATE_LIMITER_H_
+#define HYDROLIB_LOG_RATE_LIMITER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "hydrolib_clock_concepts.hpp"
+
+namespace hydrolib::logger {
+
+// State of a rate-limited LOG statement: lets at most max_count logs through
+// per interval of the clock and counts the others. Every statement owns one,
+// so a noisy site does not throttle the rest. Safe to call concurrently and
+// from interrupts, as long as the atomics are lock-free; under contention a
+// window may let a few extra logs through.
+template <concepts::clock::ClockConcept Clock>
+class LogRateLimiter {
+ public:
+  constexpr LogRateLimiter(unsigned max_count,
+                           typename Clock::duration interval);
+  LogRateLimiter(const LogRateLimiter &) = delete;
+  LogRateLimiter(LogRateLimiter &&) = delete;
+  LogRateLimiter &operator=(const LogRateLimiter &) = delete;
+  LogRateLimiter &operator=(LogRateLimiter &&) = delete;
+  ~LogRateLimiter() = default;
+
+ public:
+  // Returns false if the log is suppressed. Otherwise sets suppressed_count
+  // to the number of logs suppressed since the previous one let through.
+  bool Acquire(uint32_t &suppressed_count);
+
+ private:
+  using Rep_ = typename Clock::duration::rep;
+
+  const unsigned max_count_;
+  const Rep_ interval_;
+
+  std::atomic<Rep_> window_start_ = 0;
+  std::atomic<unsigned> window_count_ = 0;
+  std::atomic<uint32_t> suppressed_count_ = 0;
+};
+
+// Format of a suppressed statement as a log argument. It is written as is, so
+// its placeholders do not take arguments.
+class SuppressedLogFormat {
+ public:
+  constexpr explicit SuppressedLogFormat(const char *format)
+      : format_(format) {}
+
+ public:
+  constexpr operator const char *() const { return format_; }  // NOLINT
+  [[nodiscard]] unsigned GetLength() const { return std::strlen(format_); }
+
+ private:
+  const char *format_;
+};
+
+template <concepts::clock::ClockConcept Clock>
+constexpr LogRateLimiter<Clock>::LogRateLimiter(
+    unsigned max_count, typename Clock::duration interval)
+    : max_count_(max_count), interval_(interval.count()) {}
+
+template <concepts::clock::ClockConcept Clock>
+bool LogRateLimiter<Clock>::Acquire(uint32_t &suppressed_count) {
+  Rep_ now = Clock::now().time_since_epoch().count();
+  Rep_ window_start = window_start_.load(std::memory_order_relaxed);
+  if (now - window_start >= interval_ &&
+      window_start_.compare_exchange_strong(window_start, now,
+                                            std::memory_order_relaxed)) {
+    window_count_.store(0, std::memory_order_relaxed);
+  }
+  if (window_count_.load(std::memory_order_relaxed) >= max_count_ ||
+      window_count_.fetch_add(1, std::memory_order_relaxed) >= max_count_) {
+    suppressed_count_.fetch_add(1, std::memory_order_relaxed);
+    return false;
+  }
+  suppressed_count = suppressed_count_.exchange(0, std::memory_order_relaxed);
+  return true;
+}
+
+}  // namespace hydrolib::logger
+
+#endif
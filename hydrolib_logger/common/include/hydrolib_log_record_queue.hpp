@@ -0,0 +1,132 @@
+#ifndef HYDROLIB_LOG_RECORD_QUEUE_H_
+#define HYDROLIB_LOG_RECORD_QUEUE_H_
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstdint>
+
+namespace hydrolib::logger {
+
+// Bounded lock-free queue of fixed-size records for any number of producers
+// and consumers (D. Vyukov's bounded MPMC queue). A record is filled and
+// consumed in place, so a slow consumer only holds its own slot. Nothing
+// blocks: a push into a full queue and a pop from an empty one fail, as do
+// pops of a record still being filled by an interrupted producer.
+template <typename Record, int kLength>
+class LogRecordQueue {
+ public:
+  static_assert(kLength > 1 &&
+                    std::has_single_bit(static_cast<unsigned>(kLength)),
+                "Queue length must be a power of two");
+
+  constexpr LogRecordQueue() = default;
+  LogRecordQueue(const LogRecordQueue &) = delete;
+  LogRecordQueue(LogRecordQueue &&) = delete;
+  LogRecordQueue &operator=(const LogRecordQueue &) = delete;
+  LogRecordQueue &operator=(LogRecordQueue &&) = delete;
+  ~LogRecordQueue() = default;
+
+ public:
+  // Calls fill(Record &) on a free slot and publishes it.
+  template <typename Filler>
+  bool Push(Filler &&fill);
+
+  // Calls consume(Record &) on the oldest record and frees its slot.
+  template <typename Consumer>
+  bool Pop(Consumer &&consume);
+
+  [[nodiscard]] int GetLength() const;
+
+ private:
+  static constexpr uint32_t kMask = kLength - 1;
+
+  struct Cell {
+    // Stored relative to the cell index, so that a zeroed queue is empty.
+    std::atomic<uint32_t> sequence;
+    Record record;
+  };
+
+  [[nodiscard]] static uint32_t GetSequence_(const Cell &cell, uint32_t index);
+  static void SetSequence_(Cell &cell, uint32_t index, uint32_t sequence);
+
+  std::array<Cell, kLength> cells_{};
+  std::atomic<uint32_t> enqueue_position_ = 0;
+  std::atomic<uint32_t> dequeue_position_ = 0;
+};
+
+template <typename Record, int kLength>
+template <typename Filler>
+bool LogRecordQueue<Record, kLength>::Push(Filler &&fill) {
+  auto position = enqueue_position_.load(std::memory_order_relaxed);
+  Cell *cell = nullptr;
+  while (true) {
+    cell = &cells_[position & kMask];
+    auto difference = static_cast<int32_t>(
+        GetSequence_(*cell, position & kMask) - position);
+    if (difference == 0) {
+      if (enqueue_position_.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      return false;
+    } else {
+      position = enqueue_position_.load(std::memory_order_relaxed);
+    }
+  }
+  fill(cell->record);
+  SetSequence_(*cell, position & kMask, position + 1);
+  return true;
+}
+
+template <typename Record, int kLength>
+template <typename Consumer>
+bool LogRecordQueue<Record, kLength>::Pop(Consumer &&consume) {
+  auto position = dequeue_position_.load(std::memory_order_relaxed);
+  Cell *cell = nullptr;
+  while (true) {
+    cell = &cells_[position & kMask];
+    auto difference = static_cast<int32_t>(
+        GetSequence_(*cell, position & kMask) - (position + 1));
+    if (difference == 0) {
+      if (dequeue_position_.compare_exchange_weak(position, position + 1,
+                                                  std::memory_order_relaxed)) {
+        break;
+      }
+    } else if (difference < 0) {
+      return false;
+    } else {
+      position = dequeue_position_.load(std::memory_order_relaxed);
+    }
+  }
+  consume(cell->record);
+  SetSequence_(*cell, position & kMask, position + kLength);
+  return true;
+}
+
+template <typename Record, int kLength>
+int LogRecordQueue<Record, kLength>::GetLength() const {
+  // The dequeue position never passes the enqueue one loaded after it.
+  auto dequeue_position = dequeue_position_.load(std::memory_order_relaxed);
+  auto length =
+      enqueue_position_.load(std::memory_order_relaxed) - dequeue_position;
+  return static_cast<int>(std::min<uint32_t>(length, kLength));
+}
+
+template <typename Record, int kLength>
+uint32_t LogRecordQueue<Record, kLength>::GetSequence_(const Cell &cell,
+                                                       uint32_t index) {
+  return cell.sequence.load(std::memory_order_acquire) + index;
+}
+
+template <typename Record, int kLength>
+void LogRecordQueue<Record, kLength>::SetSequence_(Cell &cell, uint32_t index,
+                                                   uint32_t sequence) {
+  cell.sequence.store(sequence - index, std::memory_order_release);
+}
+
+}  // namespace hydrolib::logger
+
+#endif
@@ -0,0 +1,130 @@
+#ifndef HYDROLIB_LOG_SITE_H_
+#define HYDROLIB_LOG_SITE_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <string_view>
+
+#include "hydrolib_return_codes.hpp"
+#include "hydrolib_stream_concepts.hpp"
+
+namespace hydrolib::logger {
+
+// FNV-1a hash of a message format, used as its ID in binary logs. It depends
+// on the text only, so every build of the same sources agrees on the IDs.
+consteval uint32_t HashLogMessage(std::string_view format) {
+  uint32_t hash = 2166136261U;
+  for (char symbol : format) {
+    hash ^= static_cast<uint8_t>(symbol);
+    hash *= 16777619U;
+  }
+  return hash;
+}
+
+// A LOG statement: its format and the compile-time ID of the format. Binary
+// distributors register a site on its first record, so the registered sites
+// make up the string table a decoder needs for the records written so far.
+class LogSite {
+ public:
+  consteval explicit LogSite(const char *format);
+  LogSite(const LogSite &) = delete;
+  LogSite(LogSite &&) = delete;
+  LogSite &operator=(const LogSite &) = delete;
+  LogSite &operator=(LogSite &&) = delete;
+  ~LogSite() = default;
+
+ public:
+  [[nodiscard]] uint32_t GetId() const;
+  [[nodiscard]] const char *GetFormat() const;
+
+  // Safe to call concurrently and from interrupts, as long as the atomics are
+  // lock-free.
+  void Register();
+
+  [[nodiscard]] static const LogSite *GetFirstRegistered();
+  [[nodiscard]] const LogSite *GetNextRegistered() const;
+
+ private:
+  void Link_();
+
+  const uint32_t id_;
+  const char *const format_;
+  std::atomic<bool> is_registered_ = false;
+  const LogSite *next_ = nullptr;
+
+  static inline std::atomic<const LogSite *> first_ = nullptr;
+};
+
+// Writes the registered sites as lines of an eight-digit hex ID, a space and
+// the format, in which backslashes and line breaks are escaped.
+template <concepts::stream::ByteWritableStreamConcept Stream>
+ReturnCode WriteLogStringTable(Stream &stream);
+
+consteval LogSite::LogSite(const char *format)
+    : id_(HashLogMessage(format)), format_(format) {}
+
+inline uint32_t LogSite::GetId() const { return id_; }
+
+inline const char *LogSite::GetFormat() const { return format_; }
+
+inline void LogSite::Register() {
+  if (!is_registered_.load(std::memory_order_relaxed)) [[unlikely]] {
+    Link_();
+  }
+}
+
+inline const LogSite *LogSite::GetFirstRegistered() {
+  return first_.load(std::memory_order_acquire);
+}
+
+inline const LogSite *LogSite::GetNextRegistered() const { return next_; }
+
+inline void LogSite::Link_() {
+  if (is_registered_.exchange(true, std::memory_order_relaxed)) {
+    return;
+  }
+  auto *first = first_.load(std::memory_order_relaxed);
+  do {
+    next_ = first;
+  } while (!first_.compare_exchange_weak(first, this, std::memory_order_release,
+                                         std::memory_order_relaxed));
+}
+
+template <concepts::stream::ByteWritableStreamConcept Stream>
+ReturnCode WriteLogStringTable(Stream &stream) {
+  constexpr std::string_view kHexDigits = "0123456789abcdef";
+  for (auto *site = LogSite::GetFirstRegistered(); site != nullptr;
+       site = site->GetNextRegistered()) {
+    std::array<char, 9> id;
+    for (int i = 0; i < 8; i++) {
+      id[i] = kHexDigits[(site->GetId() >> (28 - 4 * i)) & 0xF];
+    }
+    id[8] = ' ';
+    if (write(stream, id.data(), id.size()) != static_cast<int>(id.size())) {
+      return ReturnCode::OVERFLOW;
+    }
+    for (const char *symbol = site->GetFormat(); *symbol != '\0'; symbol++) {
+      std::array<char, 2> escaped = {'\\', *symbol};
+      int length = 1;
+      if (*symbol == '\\') {
+        length = 2;
+      } else if (*symbol == '\n') {
+        escaped[1] = 'n';
+        length = 2;
+      }
+      const char *source = length == 2 ? escaped.data() : symbol;
+      if (write(stream, source, length) != length) {
+        return ReturnCode::OVERFLOW;
+      }
+    }
+    if (write(stream, "\n", 1) != 1) {
+      return ReturnCode::OVERFLOW;
+    }
+  }
+  return ReturnCode::OK;
+}
+
+}  // namespace hydrolib::logger
+
+#endif
@@ -0,0 +1,40 @@
+#ifndef HYDROLIB_LOG_TEE_H_
+#define HYDROLIB_LOG_TEE_H_
+
+#include <tuple>
+
+#include "hydrolib_log.hpp"
+
+namespace hydrolib::logger {
+
+// Passes every log to several distributors, e.g. to a LogDistributor that
+// formats the filtered logs for a UART and to a LogFlightRecorder that keeps
+// all of them.
+template <typename... Distributors>
+class LogTee {
+ public:
+  constexpr explicit LogTee(const Distributors &...distributors)
+      : distributors_(distributors...) {}
+
+ public:
+  template <typename... Ts>
+  void Notify(unsigned source_id, Log<Ts...> &log, Ts... params) const;
+
+ private:
+  std::tuple<const Distributors &...> distributors_;
+};
+
+template <typename... Distributors>
+template <typename... Ts>
+void LogTee<Distributors...>::Notify(unsigned source_id, Log<Ts...> &log,
+                                     Ts... params) const {
+  std::apply(
+      [&](const auto &...distributors) {
+        (distributors.Notify(source_id, log, params...), ...);
+      },
+      distributors_);
+}
+
+}  // namespace hydrolib::logger
+
+#endif
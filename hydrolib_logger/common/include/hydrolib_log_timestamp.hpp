@@ -0,0 +1,184 @@
+#ifndef HYDROLIB_LOG_TIMESTAMP_H_
+#define HYDROLIB_LOG_TIMESTAMP_H_
+
+#include <chrono>
+#include <concepts>
+#include <cstdint>
+
+#include "hydrolib_clock_concepts.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+#if defined(__linux__)
+#include <time.h>
+#endif
+
+namespace hydrolib::logger {
+
+// Source of log timestamps: Now() returns raw ticks of a free-running counter
+// and is called for every record, so it must not convert or lock. The ticks
+// are turned into time only when a line is rendered or decoded, with
+// GetTicksPerSecond().
+template <typename T>
+concept LogTimestampSourceConcept = requires {
+  { T::Now() } -> std::same_as<uint64_t>;
+  { T::GetTicksPerSecond() } -> std::same_as<uint64_t>;
+};
+
+// Ticks of a std::chrono style clock, e.g. a mock clock in tests.
+template <concepts::clock::ClockConcept Clock>
+class ClockTimestampSource {
+ public:
+  static uint64_t Now();
+  static uint64_t GetTicksPerSecond();
+};
+
+// Binary distributors take either a timestamp source or a clock.
+template <typename T>
+concept LogTimestampConcept =
+    LogTimestampSourceConcept<T> || concepts::clock::ClockConcept<T>;
+
+template <LogTimestampConcept T>
+struct LogTimestampSourceTraits {
+  using Source = ClockTimestampSource<T>;
+};
+
+template <LogTimestampSourceConcept T>
+struct LogTimestampSourceTraits<T> {
+  using Source = T;
+};
+
+template <LogTimestampConcept T>
+using LogTimestampSourceOf = typename LogTimestampSourceTraits<T>::Source;
+
+// Type-erased source for the text distributors, which keep it as a runtime
+// setting.
+struct LogTimestampSource {
+  uint64_t (*now)() = nullptr;
+  uint64_t (*get_ticks_per_second)() = nullptr;
+};
+
+template <LogTimestampConcept T>
+constexpr LogTimestampSource MakeLogTimestampSource();
+
+#if defined(__x86_64__) || defined(__i386__)
+// Time stamp counter of x86 cores. Its rate is constant on current CPUs and
+// is measured against the steady clock on the first GetTicksPerSecond() call,
+// which takes kCalibrationTime.
+class TscTimestampSource {
+ public:
+  static constexpr std::chrono::milliseconds kCalibrationTime{10};
+
+  static uint64_t Now();
+  static uint64_t GetTicksPerSecond();
+};
+#endif
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__)
+// Cycle counter of the DWT unit of Cortex-M3 and later cores. The counter is
+// 32 bits wide, so timestamps wrap every 2^32 / kCoreClockHz seconds, about
+// 25 s at 168 MHz. Enable() must be called once before logging.
+template <uint32_t kCoreClockHz>
+class DwtTimestampSource {
+ public:
+  static void Enable();
+
+  static uint64_t Now();
+  static uint64_t GetTicksPerSecond();
+
+ private:
+  static constexpr uintptr_t kDemcrAddress = 0xE000EDFC;
+  static constexpr uintptr_t kDwtCtrlAddress = 0xE0001000;
+  static constexpr uintptr_t kDwtCyccntAddress = 0xE0001004;
+  static constexpr uint32_t kDemcrTrcena = 1U << 24;
+  static constexpr uint32_t kDwtCtrlCyccntena = 1U;
+};
+#endif
+
+#if defined(__linux__)
+// CLOCK_MONOTONIC_COARSE in nanoseconds: read from the vDSO without a system
+// call, with the resolution of the scheduler tick.
+class CoarseMonotonicTimestampSource {
+ public:
+  static uint64_t Now();
+  static uint64_t GetTicksPerSecond();
+};
+#endif
+
+template <concepts::clock::ClockConcept Clock>
+uint64_t ClockTimestampSource<Clock>::Now() {
+  return static_cast<uint64_t>(Clock::now().time_since_epoch().count());
+}
+
+template <concepts::clock::ClockConcept Clock>
+uint64_t ClockTimestampSource<Clock>::GetTicksPerSecond() {
+  using Period = typename Clock::duration::period;
+  return Period::den / Period::num;
+}
+
+template <LogTimestampConcept T>
+constexpr LogTimestampSource MakeLogTimestampSource() {
+  using Source = LogTimestampSourceOf<T>;
+  return {.now = &Source::Now,
+          .get_ticks_per_second = &Source::GetTicksPerSecond};
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+inline uint64_t TscTimestampSource::Now() { return __rdtsc(); }
+
+inline uint64_t TscTimestampSource::GetTicksPerSecond() {
+  static const uint64_t ticks_per_second = [] {
+    auto start_time = std::chrono::steady_clock::now();
+    uint64_t start_ticks = __rdtsc();
+    auto time = start_time;
+    while (time - start_time < kCalibrationTime) {
+      time = std::chrono::steady_clock::now();
+    }
+    uint64_t ticks = __rdtsc() - start_ticks;
+    std::chrono::duration<double> duration = time - start_time;
+    return static_cast<uint64_t>(static_cast<double>(ticks) /
+                                 duration.count());
+  }();
+  return ticks_per_second;
+}
+#endif
+
+#if defined(__ARM_ARCH_7M__) || defined(__ARM_ARCH_7EM__) || \
+    defined(__ARM_ARCH_8M_MAIN__)
+template <uint32_t kCoreClockHz>
+void DwtTimestampSource<kCoreClockHz>::Enable() {
+  *reinterpret_cast<volatile uint32_t *>(kDemcrAddress) |= kDemcrTrcena;
+  *reinterpret_cast<volatile uint32_t *>(kDwtCyccntAddress) = 0;
+  *reinterpret_cast<volatile uint32_t *>(kDwtCtrlAddress) |= kDwtCtrlCyccntena;
+}
+
+template <uint32_t kCoreClockHz>
+uint64_t DwtTimestampSource<kCoreClockHz>::Now() {
+  return *reinterpret_cast<volatile uint32_t *>(kDwtCyccntAddress);
+}
+
+template <uint32_t kCoreClockHz>
+uint64_t DwtTimestampSource<kCoreClockHz>::GetTicksPerSecond() {
+  return kCoreClockHz;
+}
+#endif
+
+#if defined(__linux__)
+inline uint64_t CoarseMonotonicTimestampSource::Now() {
+  timespec time{};
+  clock_gettime(CLOCK_MONOTONIC_COARSE, &time);
+  return static_cast<uint64_t>(time.tv_sec) * 1000000000 +
+         static_cast<uint64_t>(time.tv_nsec);
+}
+
+inline uint64_t CoarseMonotonicTimestampSource::GetTicksPerSecond() {
+  return 1000000000;
+}
+#endif
+
+}  // namespace hydrolib::logger
+
+#endif
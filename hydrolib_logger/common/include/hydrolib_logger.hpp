@@ -1,9 +1,12 @@
 #ifndef HYDROLIB_LOGGER_H_
 #define HYDROLIB_LOGGER_H_
 
+#include <type_traits>
+
 #include "hydrolib_cstring.hpp"
 #include "hydrolib_formatable_string.hpp"
 #include "hydrolib_log.hpp"
+#include "hydrolib_log_site.hpp"
 
 namespace hydrolib::logger {
 template <typename T, typename... Ts>
@@ -12,7 +15,11 @@ concept LogDistributorConcept =
       distributor.Notify(source_id, log, params...);
     };
 
-template <LogDistributorConcept Distributor>
+// kMinLevel is the static floor of the logger: statements below it are
+// compiled out like the ones below kMinLogLevel. Levels above the floor are
+// still filtered by the distributor at run time.
+template <LogDistributorConcept Distributor,
+          LogLevel kMinLevel = LogLevel::DEBUG>
 class Logger {
  public:
   constexpr Logger(const char *name, unsigned id,
@@ -21,9 +28,12 @@ class Logger {
 
  public:
   template <typename... Ts>
-  void WriteLog(LogLevel level, strings::StaticFormatableString<Ts...> message,
-                Ts... params) {
-    Log<Ts...> log{.message = message, .level = level, .process_name = &name_};
+  void WriteLog(LogSite &site, LogLevel level,
+                strings::StaticFormatableString<Ts...> message, Ts... params) {
+    Log<Ts...> log{.message = message,
+                   .level = level,
+                   .process_name = &name_,
+                   .site = &site};
 
     distributor_.Notify(id_, log, params...);
   }
@@ -35,22 +45,41 @@ class Logger {
   const Distributor &distributor_;
 };
 
-template <LogDistributorConcept Distributor, typename... Ts>
+template <typename T>
+constexpr LogLevel kLoggerMinLevel = LogLevel::DEBUG;
+
+template <LogDistributorConcept Distributor, LogLevel kMinLevel>
+constexpr LogLevel kLoggerMinLevel<Logger<Distributor, kMinLevel>> = kMinLevel;
+
+template <typename LoggerType>
+consteval bool IsLogLevelEnabled(LogLevel level) {
+  return level >= kMinLogLevel &&
+         level >= kLoggerMinLevel<std::remove_cvref_t<LoggerType>>;
+}
+
+template <LogDistributorConcept Distributor, LogLevel kMinLevel,
+          typename... Ts>
 class LoggingCase {
  public:
-  constexpr LoggingCase(Logger<Distributor> &logger,
-                        [[maybe_unused]] Ts... params)
+  constexpr explicit LoggingCase(Logger<Distributor, kMinLevel> &logger)
       : logger_(logger) {}
 
  public:
-  void WriteLog(LogLevel level, strings::StaticFormatableString<Ts...> message,
-                Ts... params) {
-    logger_.WriteLog(level, message, params...);
+  void WriteLog(LogSite &site, LogLevel level,
+                strings::StaticFormatableString<Ts...> message, Ts... params) {
+    logger_.WriteLog(site, level, message, params...);
   }
 
  public:
-  Logger<Distributor> &logger_;
+  Logger<Distributor, kMinLevel> &logger_;
 };
+
+// Only names the LoggingCase type for the arguments in an unevaluated context,
+// so that LOG evaluates them once.
+template <LogDistributorConcept Distributor, LogLevel kMinLevel,
+          typename... Ts>
+LoggingCase<Distributor, kMinLevel, Ts...> DeduceLoggingCase(
+    Logger<Distributor, kMinLevel> &logger, Ts... params);
 }  // namespace hydrolib::logger
 
 #endif
@@ -9,6 +9,8 @@ struct CoutStream {};
 int write([[maybe_unused]] CoutStream &stream, const void *source,
           unsigned length);
 
-extern Logger<LogDistributor<CoutStream>> mock_logger;
-extern LogDistributor<CoutStream> mock_distributor;
+using MockLogDistributor = LogDistributor<kDefaultMaxLoggersCount, CoutStream>;
+
+extern Logger<MockLogDistributor> mock_logger;
+extern MockLogDistributor mock_distributor;
 }  // namespace hydrolib::logger
@@ -4,12 +4,10 @@
 
 namespace hydrolib::logger {
 
-constexpr char *kDefaultFormat = "[%s] [%l] %m\n";
+constexpr const char *kDefaultFormat = "[%s] [%l] %m\n";
 constinit CoutStream cout_stream{};
-constinit LogDistributor<CoutStream> mock_distributor{kDefaultFormat,
-                                                      cout_stream};
-constinit Logger<LogDistributor<CoutStream>> mock_logger{"Mock", 0,
-                                                         mock_distributor};
+constinit MockLogDistributor mock_distributor{kDefaultFormat, cout_stream};
+constinit Logger<MockLogDistributor> mock_logger{"Mock", 0, mock_distributor};
 
 int write([[maybe_unused]] CoutStream &stream, const void *source,
           unsigned length) {
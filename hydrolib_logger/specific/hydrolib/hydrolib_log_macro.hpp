@@ -1,10 +1,51 @@
 #pragma once
 
+#include "hydrolib_log_rate_limiter.hpp"
 #include "hydrolib_logger.hpp"
 
-#define LOG(logger_, level, message, ...)                           \
-  hydrolib::logger::LoggingCase(logger_ __VA_OPT__(, ) __VA_ARGS__) \
-      .WriteLog(level, message __VA_OPT__(, ) __VA_ARGS__)
+// The site of every statement is a constant-initialized static, so passing it
+// costs nothing until a binary distributor registers it.
+#define HYDROLIB_LOG_SITE(message)                                          \
+  ([]() -> hydrolib::logger::LogSite & {                                    \
+    static constinit hydrolib::logger::LogSite log_site_{message};          \
+    return log_site_;                                                       \
+  }())
+
+// Statements below the global or the logger floor are discarded at compile
+// time, so their arguments are not evaluated either. The arguments of enabled
+// statements are evaluated once, by WriteLog.
+#define LOG(logger_, level, message, ...)                                   \
+  do {                                                                      \
+    if constexpr (hydrolib::logger::IsLogLevelEnabled<decltype(logger_)>(   \
+                      level)) {                                             \
+      decltype(hydrolib::logger::DeduceLoggingCase(                         \
+          logger_ __VA_OPT__(, ) __VA_ARGS__))(logger_)                     \
+          .WriteLog(HYDROLIB_LOG_SITE(message), level,                      \
+                    message __VA_OPT__(, ) __VA_ARGS__);                    \
+    }                                                                       \
+  } while (false)
+
+// Lets at most max_count logs of the statement through per interval of the
+// Clock. Suppressed logs are not formatted; the next log let through is
+// preceded by a record of how many were suppressed.
+#define LOG_RATE_LIMITED(logger_, level, Clock, max_count, interval, message, \
+                         ...)                                                 \
+  do {                                                                        \
+    if constexpr (hydrolib::logger::IsLogLevelEnabled<decltype(logger_)>(     \
+                      level)) {                                               \
+      static constinit hydrolib::logger::LogRateLimiter<Clock> log_limiter_{  \
+          max_count, interval};                                               \
+      uint32_t log_suppressed_count_ = 0;                                     \
+      if (log_limiter_.Acquire(log_suppressed_count_)) {                      \
+        if (log_suppressed_count_ != 0) {                                     \
+          LOG(logger_, level, "Suppressed {} repeats of: {}",                 \
+              static_cast<int>(log_suppressed_count_),                        \
+              hydrolib::logger::SuppressedLogFormat(message));                \
+        }                                                                     \
+        LOG(logger_, level, message __VA_OPT__(, ) __VA_ARGS__);              \
+      }                                                                       \
+    }                                                                         \
+  } while (false)
 
 #define LOG_DEBUG(logger_, message, ...) \
   LOG(logger_, hydrolib::logger::LogLevel::DEBUG, message, __VA_ARGS__)
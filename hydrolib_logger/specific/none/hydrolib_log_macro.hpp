@@ -1,6 +1,8 @@
 #pragma once
 
 #define LOG(logger_, level, message, ...)
+#define LOG_RATE_LIMITED(logger_, level, Clock, max_count, interval, message, \
+                         ...)
 
 #define LOG_DEBUG(logger_, message, ...)
 #define LOG_INFO(logger_, message, ...)
@@ -0,0 +1,204 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hydrolib_async_log_distributor.hpp"
+#include "hydrolib_log_decoder.hpp"
+#include "hydrolib_log_drain_thread.hpp"
+#include "hydrolib_log_encoder.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_logger.hpp"
+#include "mock_clock.hpp"
+
+using namespace hydrolib::logger;
+using namespace std::literals::chrono_literals;
+
+namespace {
+using TestClock = hydrolib::streams::mock::TestClock;
+
+struct LineStream {
+  std::string text;
+  int writes = 0;
+  bool is_broken = false;
+};
+
+int write(LineStream &stream, const void *source, unsigned length) {
+  if (stream.is_broken) {
+    return -1;
+  }
+  stream.text.append(static_cast<const char *>(source), length);
+  stream.writes++;
+  return static_cast<int>(length);
+}
+
+struct LockedStream {
+  std::mutex mutex;
+  std::vector<std::string> lines;
+};
+
+int write(LockedStream &stream, const void *source, unsigned length) {
+  std::lock_guard lock(stream.mutex);
+  stream.lines.emplace_back(static_cast<const char *>(source), length);
+  return static_cast<int>(length);
+}
+
+constexpr TextLogEncoder kTextEncoder("[%s] %m\n");
+
+constexpr unsigned kLoggersCount = 4;
+
+using TextDistributor = AsyncLogDistributor<TextLogEncoder, 4, kLoggersCount,
+                                            LineStream, LineStream>;
+
+class TestHydrolibAsyncLogger : public ::testing::Test {
+ protected:
+  TestHydrolibAsyncLogger() {
+    distributor.SetAllFilters(0, LogLevel::DEBUG);
+    distributor.SetFilter(1, 0, LogLevel::WARNING);
+  }
+
+  LineStream uart;
+  LineStream file;
+  TextDistributor distributor{kTextEncoder, uart, file};
+  Logger<TextDistributor> logger{"Control", 0, distributor};
+};
+}  // namespace
+
+TEST_F(TestHydrolibAsyncLogger, NotifyOnlyQueues) {
+  LOG_DEBUG(logger, "Step {}", 1);
+  LOG_WARNING(logger, "Step {}", 2);
+  EXPECT_EQ(uart.writes, 0);
+  EXPECT_EQ(file.writes, 0);
+  EXPECT_EQ(distributor.GetQueuedCount(), 2);
+
+  EXPECT_EQ(distributor.Drain(), 2);
+  EXPECT_EQ(uart.text, "[Control] Step 1\n[Control] Step 2\n");
+  EXPECT_EQ(file.text, "[Control] Step 2\n");
+  EXPECT_EQ(distributor.GetQueuedCount(), 0);
+  EXPECT_EQ(distributor.Drain(), 0);
+}
+
+TEST_F(TestHydrolibAsyncLogger, DrainIsBounded) {
+  LOG_INFO(logger, "One");
+  LOG_INFO(logger, "Two");
+  LOG_INFO(logger, "Three");
+  EXPECT_EQ(distributor.Drain(2), 2);
+  EXPECT_EQ(uart.text, "[Control] One\n[Control] Two\n");
+  EXPECT_EQ(distributor.Drain(2), 1);
+}
+
+TEST_F(TestHydrolibAsyncLogger, OverflowDropsNewest) {
+  for (int i = 0; i < 6; i++) {
+    LOG_INFO(logger, "Record {}", i);
+  }
+  EXPECT_EQ(distributor.GetDroppedCount(), 2);
+  distributor.Drain();
+  EXPECT_EQ(uart.text,
+            "[Control] Record 0\n[Control] Record 1\n[Control] Record 2\n"
+            "[Control] Record 3\n");
+}
+
+TEST_F(TestHydrolibAsyncLogger, OverflowDropsOldest) {
+  distributor.SetOverflowPolicy(LogOverflowPolicy::kDropOldest);
+  for (int i = 0; i < 6; i++) {
+    LOG_INFO(logger, "Record {}", i);
+  }
+  EXPECT_EQ(distributor.GetDroppedCount(), 2);
+  distributor.Drain();
+  EXPECT_EQ(uart.text,
+            "[Control] Record 2\n[Control] Record 3\n[Control] Record 4\n"
+            "[Control] Record 5\n");
+}
+
+TEST_F(TestHydrolibAsyncLogger, FiltersAreSizedByLoggersCount) {
+  EXPECT_EQ(distributor.SetAllFilters(kLoggersCount - 1, LogLevel::INFO),
+            hydrolib::ReturnCode::OK);
+  EXPECT_EQ(distributor.SetAllFilters(kLoggersCount, LogLevel::INFO),
+            hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(distributor.SetFilter(0, kLoggersCount, LogLevel::INFO),
+            hydrolib::ReturnCode::FAIL);
+}
+
+TEST_F(TestHydrolibAsyncLogger, FailedWritesAreCounted) {
+  file.is_broken = true;
+  LOG_ERROR(logger, "Lost on file");
+  EXPECT_EQ(distributor.Drain(), 1);
+  EXPECT_EQ(distributor.GetFailedWriteCount(), 1);
+  EXPECT_EQ(uart.text, "[Control] Lost on file\n");
+}
+
+TEST_F(TestHydrolibAsyncLogger, BinaryRecordsAreQueued) {
+  using BinaryDistributor =
+      AsyncLogDistributor<BinaryLogEncoder<TestClock>, 8, kLoggersCount,
+                          LineStream>;
+  TestClock::current_time = TestClock::time_point(2ms);
+  BinaryDistributor binary_distributor(BinaryLogEncoder<TestClock>(), uart);
+  Logger<BinaryDistributor> binary_logger("Binary", 3, binary_distributor);
+  binary_distributor.SetAllFilters(3, LogLevel::INFO);
+
+  LOG_INFO(binary_logger, "Depth {}", 12);
+  LOG_DEBUG(binary_logger, "Filtered");
+  EXPECT_EQ(binary_distributor.Drain(), 1);
+
+  LogDecoder decoder;
+  decoder.AddMessage(HashLogMessage("Depth {}"), "Depth {}");
+  LogDecoder::Record record;
+  std::span<const uint8_t> bytes(
+      reinterpret_cast<const uint8_t *>(uart.text.data()), uart.text.size());
+  EXPECT_EQ(decoder.Decode(bytes, record), static_cast<int>(bytes.size()));
+  EXPECT_EQ(record.message, "Depth 12");
+  EXPECT_EQ(record.logger_id, 3);
+  EXPECT_EQ(record.timestamp, 2000000);
+}
+
+TEST(TestHydrolibAsyncLoggerThreads, ProducersRaceTheDrainThread) {
+  using Distributor =
+      AsyncLogDistributor<TextLogEncoder, 64, kLoggersCount, LockedStream>;
+  LockedStream locked;
+  Distributor distributor(TextLogEncoder("%m"), locked);
+  constexpr int kThreadsCount = 4;
+  constexpr int kLogsCount = 2000;
+  std::array<Logger<Distributor>, kThreadsCount> loggers = {
+      Logger<Distributor>("0", 0, distributor),
+      Logger<Distributor>("1", 1, distributor),
+      Logger<Distributor>("2", 2, distributor),
+      Logger<Distributor>("3", 3, distributor)};
+  for (unsigned i = 0; i < kThreadsCount; i++) {
+    distributor.SetAllFilters(i, LogLevel::DEBUG);
+  }
+
+  {
+    LogDrainThread drain_thread(distributor, 10us);
+    std::vector<std::thread> producers;
+    for (int i = 0; i < kThreadsCount; i++) {
+      producers.emplace_back([&loggers, i] {
+        for (int j = 0; j < kLogsCount; j++) {
+          LOG_INFO(loggers[i], "{} {}", i, j);
+        }
+      });
+    }
+    for (auto &producer : producers) {
+      producer.join();
+    }
+  }
+
+  EXPECT_EQ(distributor.GetQueuedCount(), 0);
+  EXPECT_EQ(locked.lines.size() + distributor.GetDroppedCount(),
+            kThreadsCount * kLogsCount);
+  std::array<int, kThreadsCount> last = {-1, -1, -1, -1};
+  for (const auto &line : locked.lines) {
+    int producer = line[0] - '0';
+    int number = std::stoi(line.substr(2));
+    ASSERT_GE(producer, 0);
+    ASSERT_LT(producer, kThreadsCount);
+    EXPECT_GT(number, last[producer]) << line;
+    last[producer] = number;
+  }
+}
@@ -0,0 +1,211 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <charconv>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+#include "hydrolib_binary_log_distributor.hpp"
+#include "hydrolib_cstring.hpp"
+#include "hydrolib_log_decoder.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_log_site.hpp"
+#include "hydrolib_logger.hpp"
+#include "mock_clock.hpp"
+#include "mock_sink_stream.hpp"
+
+using namespace hydrolib::logger;
+using namespace std::literals::chrono_literals;
+
+namespace {
+using TestClock = hydrolib::streams::mock::TestClock;
+using hydrolib::streams::mock::BinaryStream;
+using hydrolib::streams::mock::TextStream;
+
+using Distributor = BinaryLogDistributor<256, TestClock>;
+
+class TestHydrolibBinaryLogger : public ::testing::Test {
+ protected:
+  TestHydrolibBinaryLogger() {
+    TestClock::current_time = {};
+    distributor.SetFilter(0, LogLevel::DEBUG);
+    distributor.SetFilter(1, LogLevel::WARNING);
+    decoder.SetLoggerName(0, "Parser");
+    decoder.SetLoggerName(1, "Link");
+    decoder.SetTicksPerSecond(TestClock::duration::period::den);
+  }
+
+  std::vector<std::string> Decode() {
+    TextStream table;
+    EXPECT_EQ(WriteLogStringTable(table), hydrolib::ReturnCode::OK);
+    EXPECT_EQ(decoder.LoadStringTable(table.text), hydrolib::ReturnCode::OK);
+
+    BinaryStream stream;
+    distributor.Drain(stream);
+    std::vector<std::string> lines;
+    std::span<const uint8_t> data(stream.bytes);
+    LogDecoder::Record record;
+    while (!data.empty()) {
+      int length = decoder.Decode(data, record);
+      EXPECT_GT(length, 0);
+      if (length <= 0) {
+        break;
+      }
+      lines.push_back(decoder.Render(record, "[%s] [%l] %m"));
+      data = data.subspan(length);
+    }
+    return lines;
+  }
+
+  Distributor distributor;
+  Logger<Distributor> parser{"Parser", 0, distributor};
+  Logger<Distributor> link{"Link", 1, distributor};
+  LogDecoder decoder;
+};
+}  // namespace
+
+TEST_F(TestHydrolibBinaryLogger, RecordsAreDecodedToText) {
+  hydrolib::strings::CString<16> name("depth");
+  LOG_INFO(parser, "Sensor {} reads {}", name, -42);
+  LOG_DEBUG(parser, "Plain message");
+  LOG_WARNING(link, "Rubbish byte: {}", 0xA5);
+
+  auto lines = Decode();
+  ASSERT_EQ(lines.size(), 3);
+  EXPECT_EQ(lines[0], "[Parser] [INFO] Sensor depth reads -42");
+  EXPECT_EQ(lines[1], "[Parser] [DEBUG] Plain message");
+  EXPECT_EQ(lines[2], "[Link] [WARNING] Rubbish byte: 165");
+}
+
+TEST_F(TestHydrolibBinaryLogger, RecordHoldsIdsAndTimestamp) {
+  TestClock::current_time += 1500us;
+  LOG_ERROR(link, "Timeout");
+
+  BinaryStream stream;
+  distributor.Drain(stream);
+  LogDecoder::Record record;
+  EXPECT_EQ(decoder.Decode(stream.bytes, record),
+            static_cast<int>(sizeof(BinaryLogRecordHeader)));
+  EXPECT_EQ(record.message_id, HashLogMessage("Timeout"));
+  EXPECT_EQ(record.sequence, 0);
+  EXPECT_EQ(record.timestamp, 1500000);
+  EXPECT_EQ(record.level, LogLevel::ERROR);
+  EXPECT_EQ(record.logger_id, 1);
+  std::array<char, 9> id = {};
+  std::to_chars(id.data(), id.data() + 8, HashLogMessage("Timeout"), 16);
+  EXPECT_EQ(record.message,
+            "<unknown message 0x" + std::string(id.data()) + ">");
+  EXPECT_EQ(decoder.Render(record, "#%n %t %l"), "#0 0.001500 ERROR");
+}
+
+TEST_F(TestHydrolibBinaryLogger, SequenceShowsDroppedRecords) {
+  constexpr int kRecordLength = sizeof(BinaryLogRecordHeader);
+  constexpr int kFittingCount = 256 / kRecordLength;
+  for (int i = 0; i < kFittingCount + 2; i++) {
+    LOG_ERROR(link, "Timeout");
+  }
+  EXPECT_EQ(distributor.GetDroppedCount(), 2);
+  BinaryStream discarded;
+  distributor.Drain(discarded);
+  LOG_ERROR(link, "Timeout");
+
+  BinaryStream stream;
+  distributor.Drain(stream);
+  LogDecoder::Record record;
+  EXPECT_EQ(decoder.Decode(stream.bytes, record), kRecordLength);
+  EXPECT_EQ(record.sequence, kFittingCount + 2);
+}
+
+TEST_F(TestHydrolibBinaryLogger, FilteredLogsAreNotRecorded) {
+  LOG_INFO(link, "Below the filter");
+  LOG_DEBUG(parser, "Above the filter");
+  distributor.SetFilter(0, LogLevel::NO_LEVEL);
+  LOG_CRITICAL(parser, "Disabled logger");
+
+  auto lines = Decode();
+  ASSERT_EQ(lines.size(), 1);
+  EXPECT_EQ(lines[0], "[Parser] [DEBUG] Above the filter");
+  EXPECT_EQ(distributor.SetFilter(50, LogLevel::DEBUG),
+            hydrolib::ReturnCode::FAIL);
+
+  Logger<Distributor> unknown("Unknown", 50, distributor);
+  LOG_CRITICAL(unknown, "Out of the filters");
+  EXPECT_EQ(distributor.GetBufferedLength(), 0);
+}
+
+TEST_F(TestHydrolibBinaryLogger, IntegersKeepTheirWidth) {
+  LOG_INFO(parser, "{} {} {} {} {}", uint32_t{4000000000}, -7,
+           int64_t{-5000000000}, uint64_t{18000000000000000000U},
+           static_cast<uint8_t>(200));
+
+  auto lines = Decode();
+  ASSERT_EQ(lines.size(), 1);
+  EXPECT_EQ(lines[0],
+            "[Parser] [INFO] 4000000000 -7 -5000000000 18000000000000000000 "
+            "200");
+}
+
+TEST_F(TestHydrolibBinaryLogger, FullBufferDropsRecords) {
+  for (int i = 0; i < 100; i++) {
+    LOG_DEBUG(parser, "Sample {}", i);
+  }
+  constexpr int kRecordLength = sizeof(BinaryLogRecordHeader) + 5;
+  constexpr int kStoredCount = 256 / kRecordLength;
+  EXPECT_EQ(distributor.GetBufferedLength(), kStoredCount * kRecordLength);
+  EXPECT_EQ(distributor.GetDroppedCount(), 100 - kStoredCount);
+
+  auto lines = Decode();
+  ASSERT_EQ(lines.size(), kStoredCount);
+  EXPECT_EQ(lines.back(),
+            "[Parser] [DEBUG] Sample " + std::to_string(kStoredCount - 1));
+}
+
+TEST_F(TestHydrolibBinaryLogger, DrainStopsAtFullStream) {
+  LOG_DEBUG(parser, "First {}", 1);
+  LOG_DEBUG(parser, "Second {}", 2);
+  int total = distributor.GetBufferedLength();
+
+  BinaryStream stream{.bytes = {}, .free_space = 7};
+  EXPECT_EQ(distributor.Drain(stream), 7);
+  EXPECT_EQ(distributor.GetBufferedLength(), total - 7);
+  stream.free_space = INT32_MAX;
+  EXPECT_EQ(distributor.Drain(stream), total - 7);
+  EXPECT_EQ(distributor.GetBufferedLength(), 0);
+
+  LogDecoder::Record record;
+  decoder.AddMessage(HashLogMessage("First {}"), "First {}");
+  int length = decoder.Decode(stream.bytes, record);
+  ASSERT_GT(length, 0);
+  EXPECT_EQ(record.message, "First 1");
+}
+
+TEST_F(TestHydrolibBinaryLogger, LongStringsAreTruncated) {
+  hydrolib::strings::CString<100> text(std::string(100, 'x'));
+  LOG_INFO(parser, "{} and {}", text, 7);
+
+  auto lines = Decode();
+  ASSERT_EQ(lines.size(), 1);
+  std::string expected(kMaxBinaryLogPayloadLength - 2, 'x');
+  EXPECT_EQ(lines[0], "[Parser] [INFO] " + expected + " and {}");
+}
+
+TEST_F(TestHydrolibBinaryLogger, StringTableIsEscaped) {
+  LOG_INFO(parser, "Two\nlines \\ {}", 1);
+
+  auto lines = Decode();
+  ASSERT_EQ(lines.size(), 1);
+  EXPECT_EQ(lines[0], "[Parser] [INFO] Two\nlines \\ 1");
+}
+
+TEST_F(TestHydrolibBinaryLogger, ConflictingStringTableIsRejected) {
+  EXPECT_EQ(decoder.AddMessage(1, "One"), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(decoder.AddMessage(1, "One"), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(decoder.AddMessage(1, "Two"), hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(decoder.LoadStringTable("0000000g text\n"),
+            hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(decoder.LoadStringTable("00000002 text"),
+            hydrolib::ReturnCode::FAIL);
+}
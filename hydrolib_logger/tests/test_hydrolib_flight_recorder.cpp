@@ -0,0 +1,180 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hydrolib_log_decoder.hpp"
+#include "hydrolib_log_distributor.hpp"
+#include "hydrolib_log_flight_recorder.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_log_site.hpp"
+#include "hydrolib_log_tee.hpp"
+#include "hydrolib_logger.hpp"
+#include "mock_clock.hpp"
+#include "mock_sink_stream.hpp"
+
+using namespace hydrolib::logger;
+using namespace std::literals::chrono_literals;
+
+namespace {
+using TestClock = hydrolib::streams::mock::TestClock;
+using hydrolib::streams::mock::BinaryStream;
+using hydrolib::streams::mock::TextStream;
+
+using Recorder = LogFlightRecorder<4, TestClock>;
+using Uart = LogDistributor<2, TextStream>;
+using Tee = LogTee<Uart, Recorder>;
+
+constinit TextStream uart = {};
+constinit Uart uart_distributor("[%l] %m\n", uart);
+constinit Recorder recorder;
+constinit Tee tee(uart_distributor, recorder);
+constinit Logger<Tee> logger("Depth", 0, tee);
+
+class TestHydrolibFlightRecorder : public ::testing::Test {
+ protected:
+  TestHydrolibFlightRecorder() {
+    BinaryStream discarded;
+    recorder.Dump(discarded);
+    uart.text.clear();
+    overwritten_count = recorder.GetOverwrittenCount();
+    TestClock::current_time = {};
+    uart_distributor.SetAllFilters(0, LogLevel::WARNING);
+    decoder.SetLoggerName(0, "Depth");
+    decoder.SetTicksPerSecond(TestClock::duration::period::den);
+  }
+
+  std::vector<std::string> Decode(std::span<const uint8_t> data) {
+    TextStream table;
+    EXPECT_EQ(WriteLogStringTable(table), hydrolib::ReturnCode::OK);
+    EXPECT_EQ(decoder.LoadStringTable(table.text), hydrolib::ReturnCode::OK);
+
+    std::vector<std::string> lines;
+    LogDecoder::Record record;
+    while (!data.empty()) {
+      int length = decoder.Decode(data, record);
+      EXPECT_GT(length, 0);
+      if (length <= 0) {
+        break;
+      }
+      lines.push_back(decoder.Render(record, "%t [%l] %m"));
+      data = data.subspan(length);
+    }
+    return lines;
+  }
+
+  uint32_t overwritten_count;
+  LogDecoder decoder;
+};
+}  // namespace
+
+TEST_F(TestHydrolibFlightRecorder, RecordsEveryLevel) {
+  LOG_DEBUG(logger, "Pressure {}", 1013);
+  TestClock::current_time += 250us;
+  LOG_WARNING(logger, "Leak on {}", 2);
+  EXPECT_EQ(uart.text, "[WARNING] Leak on 2\n");
+  EXPECT_EQ(recorder.GetRecordedCount(), 2);
+
+  BinaryStream dump;
+  int dumped = recorder.Dump(dump);
+  EXPECT_EQ(dumped, static_cast<int>(dump.bytes.size()));
+  EXPECT_EQ(recorder.GetRecordedCount(), 0);
+  auto lines = Decode(dump.bytes);
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_EQ(lines[0], "0.000000 [DEBUG] Pressure 1013");
+  EXPECT_EQ(lines[1], "0.000250 [WARNING] Leak on 2");
+}
+
+TEST_F(TestHydrolibFlightRecorder, OverwritesOldestRecords) {
+  for (int i = 0; i < 6; i++) {
+    LOG_DEBUG(logger, "Sample {}", i);
+  }
+  EXPECT_EQ(recorder.GetRecordedCount(), 4);
+  EXPECT_EQ(recorder.GetOverwrittenCount() - overwritten_count, 2);
+
+  BinaryStream dump;
+  recorder.Dump(dump);
+  auto lines = Decode(dump.bytes);
+  ASSERT_EQ(lines.size(), 4);
+  EXPECT_EQ(lines[0], "0.000000 [DEBUG] Sample 2");
+  EXPECT_EQ(lines[3], "0.000000 [DEBUG] Sample 5");
+}
+
+TEST_F(TestHydrolibFlightRecorder, DumpResumesAfterFullStream) {
+  LOG_INFO(logger, "Heading {}", 90);
+  LOG_INFO(logger, "Heading {}", 91);
+
+  BinaryStream dump;
+  dump.free_space = 5;
+  EXPECT_EQ(recorder.Dump(dump), 5);
+  dump.free_space = INT32_MAX;
+  recorder.Dump(dump);
+  auto lines = Decode(dump.bytes);
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_EQ(lines[1], "0.000000 [INFO] Heading 91");
+}
+
+TEST_F(TestHydrolibFlightRecorder, ReadsAsStream) {
+  LOG_ERROR(logger, "Thruster {} stalled", 3);
+  LOG_CRITICAL(logger, "Surfacing");
+
+  std::vector<uint8_t> bytes;
+  std::array<uint8_t, 3> chunk;
+  int length = read(recorder, chunk.data(), chunk.size());
+  while (length > 0) {
+    bytes.insert(bytes.end(), chunk.begin(), chunk.begin() + length);
+    length = read(recorder, chunk.data(), chunk.size());
+  }
+  EXPECT_EQ(write(recorder, chunk.data(), chunk.size()), -1);
+  auto lines = Decode(bytes);
+  ASSERT_EQ(lines.size(), 2);
+  EXPECT_EQ(lines[0], "0.000000 [ERROR] Thruster 3 stalled");
+  EXPECT_EQ(lines[1], "0.000000 [CRITICAL] Surfacing");
+}
+
+TEST(TestHydrolibFlightRecorderThreads, ProducersKeepTheLastRecords) {
+  using ThreadsRecorder = LogFlightRecorder<64, TestClock>;
+  ThreadsRecorder recorder;
+  constexpr int kThreadsCount = 4;
+  constexpr int kLogsCount = 2000;
+  std::array<Logger<ThreadsRecorder>, kThreadsCount> loggers = {
+      Logger<ThreadsRecorder>("0", 0, recorder),
+      Logger<ThreadsRecorder>("1", 1, recorder),
+      Logger<ThreadsRecorder>("2", 2, recorder),
+      Logger<ThreadsRecorder>("3", 3, recorder)};
+
+  std::vector<std::thread> producers;
+  for (int i = 0; i < kThreadsCount; i++) {
+    producers.emplace_back([&loggers, i] {
+      for (int j = 0; j < kLogsCount; j++) {
+        LOG_DEBUG(loggers[i], "{}", j);
+      }
+    });
+  }
+  for (auto &producer : producers) {
+    producer.join();
+  }
+
+  EXPECT_EQ(recorder.GetRecordedCount(), 64);
+  EXPECT_EQ(recorder.GetOverwrittenCount() + recorder.GetDroppedCount() + 64,
+            kThreadsCount * kLogsCount);
+  BinaryStream dump;
+  recorder.Dump(dump);
+  LogDecoder decoder;
+  decoder.AddMessage(HashLogMessage("{}"), "{}");
+  std::span<const uint8_t> data(dump.bytes);
+  LogDecoder::Record record;
+  int records_count = 0;
+  while (!data.empty()) {
+    int length = decoder.Decode(data, record);
+    ASSERT_GT(length, 0);
+    records_count++;
+    data = data.subspan(length);
+  }
+  EXPECT_EQ(records_count, 64);
+}
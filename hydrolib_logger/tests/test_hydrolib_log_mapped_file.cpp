@@ -0,0 +1,181 @@
+#include <fcntl.h>
+#include <gtest/gtest.h>
+#include <unistd.h>
+
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "hydrolib_log_distributor.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_log_mapped_file.hpp"
+#include "hydrolib_logger.hpp"
+
+using namespace hydrolib::logger;
+
+namespace {
+void RemoveLogFiles(const std::string &path) {
+  for (int i = 0; i < 3; i++) {
+    std::remove((path + "." + std::to_string(i)).c_str());
+  }
+}
+
+std::string GetTestPath(const char *name) {
+  std::string path = testing::TempDir() + name + "_" + std::to_string(getpid());
+  RemoveLogFiles(path);
+  return path;
+}
+
+std::string ReadRecords(const std::string &path, int index) {
+  std::ifstream file(path + "." + std::to_string(index), std::ios::binary);
+  std::vector<char> bytes((std::istreambuf_iterator<char>(file)),
+                          std::istreambuf_iterator<char>());
+  auto records = GetLogFileRecords(std::as_bytes(std::span(bytes)));
+  return {reinterpret_cast<const char *>(records.data()), records.size()};
+}
+}  // namespace
+
+TEST(TestHydrolibLogMappedFile, WritesLogsAfterHeader) {
+  std::string path = GetTestPath("mapped_log");
+  using File = LogMappedFile<2>;
+  static File file(path, 4096, LogFileSyncPolicy::ON_WRITE);
+  static LogDistributor distributor("[%s] [%l] %m\n", file);
+  Logger logger("Sonar", 0, distributor);
+  distributor.SetAllFilters(0, LogLevel::DEBUG);
+
+  EXPECT_EQ(write(file, "x", 1), -1);
+  ASSERT_EQ(file.Open(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(file.Open(), hydrolib::ReturnCode::FAIL);
+  LOG_INFO(logger, "Range {}", 12);
+  LOG_ERROR(logger, "Lost echo");
+  EXPECT_EQ(ReadRecords(path, 0),
+            "[Sonar] [INFO] Range 12\n[Sonar] [ERROR] Lost echo\n");
+  EXPECT_EQ(ReadRecords(path, 1), "");
+  RemoveLogFiles(path);
+}
+
+TEST(TestHydrolibLogMappedFile, RotatesAndResumes) {
+  std::string path = GetTestPath("rotating_log");
+  constexpr uint32_t kFileLength = sizeof(LogFileHeader) + 8;
+  {
+    LogMappedFile<3> file(path, kFileLength, LogFileSyncPolicy::ON_ROTATION);
+    ASSERT_EQ(file.Open(), hydrolib::ReturnCode::OK);
+    EXPECT_EQ(file.GetGeneration(), 3);
+    EXPECT_EQ(write(file, "aaaa", 4), 4);
+    EXPECT_EQ(write(file, "bbbb", 4), 4);
+    EXPECT_EQ(write(file, "ccccc", 5), 5);
+    EXPECT_EQ(write(file, "ddddd", 5), 5);
+    EXPECT_EQ(write(file, "toolong!!", 9), -1);
+    EXPECT_EQ(file.GetGeneration(), 5);
+  }
+  EXPECT_EQ(ReadRecords(path, 0), "aaaabbbb");
+  EXPECT_EQ(ReadRecords(path, 1), "ccccc");
+  EXPECT_EQ(ReadRecords(path, 2), "ddddd");
+
+  LogMappedFile<3> file(path, kFileLength, LogFileSyncPolicy::NONE);
+  ASSERT_EQ(file.Open(), hydrolib::ReturnCode::OK);
+  EXPECT_EQ(file.GetGeneration(), 6);
+  EXPECT_EQ(write(file, "eeee", 4), 4);
+  EXPECT_EQ(ReadRecords(path, 0), "eeee");
+  EXPECT_EQ(ReadRecords(path, 1), "ccccc");
+  EXPECT_EQ(ReadRecords(path, 2), "ddddd");
+  RemoveLogFiles(path);
+}
+
+TEST(TestHydrolibLogMappedFile, ConcurrentWriters) {
+  std::string path = GetTestPath("concurrent_log");
+  constexpr int kThreadsCount = 4;
+  constexpr int kWritesCount = 5000;
+  constexpr int kRecordLength = 8;
+  LogMappedFile<1> file(path, 1 << 20, LogFileSyncPolicy::NONE);
+  ASSERT_EQ(file.Open(), hydrolib::ReturnCode::OK);
+
+  std::vector<std::thread> writers;
+  for (int i = 0; i < kThreadsCount; i++) {
+    writers.emplace_back([&file, i] {
+      char record[kRecordLength + 1];
+      for (int j = 0; j < kWritesCount; j++) {
+        snprintf(record, sizeof(record), "%d%05d\n", i, j);
+        write(file, record, kRecordLength - 1);
+      }
+    });
+  }
+  for (auto &writer : writers) {
+    writer.join();
+  }
+
+  std::string records = ReadRecords(path, 0);
+  ASSERT_EQ(records.size(), kThreadsCount * kWritesCount * (kRecordLength - 1));
+  std::set<std::string> lines;
+  for (size_t i = 0; i < records.size(); i += kRecordLength - 1) {
+    lines.insert(records.substr(i, kRecordLength - 1));
+  }
+  EXPECT_EQ(lines.size(), kThreadsCount * kWritesCount);
+  RemoveLogFiles(path);
+}
+
+namespace {
+struct FileStream {
+  FILE *file;
+};
+
+int write(FileStream &stream, const void *source, unsigned length) {
+  return static_cast<int>(fwrite(source, 1, length, stream.file));
+}
+
+struct FdStream {
+  int fd;
+};
+
+int write(FdStream &stream, const void *source, unsigned length) {
+  return static_cast<int>(::write(stream.fd, source, length));
+}
+
+template <typename Distributor>
+double MeasureMessagesPerSecond(Distributor &distributor) {
+  constexpr int kMessagesCount = 200000;
+  Logger logger("Bench", 0, distributor);
+  distributor.SetAllFilters(0, LogLevel::DEBUG);
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kMessagesCount; i++) {
+    LOG_INFO(logger, "Depth {} heading {}", i, 90);
+  }
+  std::chrono::duration<double> duration =
+      std::chrono::steady_clock::now() - start;
+  return kMessagesCount / duration.count();
+}
+}  // namespace
+
+// Benchmark: messages per second through a text distributor into a mapped
+// file, a stdio FILE and a plain fd.
+TEST(TestHydrolibLogMappedFile, SinksBenchmark) {
+  std::string path = GetTestPath("bench_log");
+  static LogMappedFile<2> mapped(path, 16 << 20, LogFileSyncPolicy::NONE);
+  ASSERT_EQ(mapped.Open(), hydrolib::ReturnCode::OK);
+  static FileStream stdio{fopen((path + ".stdio").c_str(), "w")};
+  static FdStream fd{open((path + ".fd").c_str(),
+                          O_WRONLY | O_CREAT | O_TRUNC, 0644)};
+  ASSERT_NE(stdio.file, nullptr);
+  ASSERT_GE(fd.fd, 0);
+  static LogDistributor mapped_distributor("[%s] [%l] %m\n", mapped);
+  static LogDistributor stdio_distributor("[%s] [%l] %m\n", stdio);
+  static LogDistributor fd_distributor("[%s] [%l] %m\n", fd);
+
+  std::cout << "Mapped file: " << MeasureMessagesPerSecond(mapped_distributor)
+            << " messages/s\n";
+  std::cout << "FILE: " << MeasureMessagesPerSecond(stdio_distributor)
+            << " messages/s\n";
+  std::cout << "fd: " << MeasureMessagesPerSecond(fd_distributor)
+            << " messages/s\n";
+  fclose(stdio.file);
+  close(fd.fd);
+  std::remove((path + ".stdio").c_str());
+  std::remove((path + ".fd").c_str());
+  RemoveLogFiles(path);
+}
@@ -0,0 +1,109 @@
+#include <gtest/gtest.h>
+
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <thread>
+
+#include "hydrolib_binary_log_distributor.hpp"
+#include "hydrolib_log_macro.hpp"
+#include "hydrolib_log_timestamp.hpp"
+#include "hydrolib_logger.hpp"
+#include "mock_clock.hpp"
+
+using namespace hydrolib::logger;
+using namespace std::literals::chrono_literals;
+using TestClock = hydrolib::streams::mock::TestClock;
+
+namespace {
+template <LogTimestampSourceConcept Source>
+void ExpectAdvances(std::chrono::milliseconds interval) {
+  uint64_t start = Source::Now();
+  std::this_thread::sleep_for(interval);
+  uint64_t ticks = Source::Now() - start;
+  uint64_t expected = Source::GetTicksPerSecond() * interval.count() / 1000;
+  EXPECT_GE(ticks, expected / 2);
+  EXPECT_LE(ticks, expected * 4);
+}
+
+struct NullStream {};
+
+int write([[maybe_unused]] NullStream &stream,
+          [[maybe_unused]] const void *source, unsigned length) {
+  return static_cast<int>(length);
+}
+
+template <LogTimestampSourceConcept Source>
+double MeasureNowNanoseconds() {
+  constexpr int kReadsCount = 1000000;
+  uint64_t sum = 0;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kReadsCount; i++) {
+    sum += Source::Now();
+  }
+  std::chrono::duration<double, std::nano> duration =
+      std::chrono::steady_clock::now() - start;
+  EXPECT_NE(sum, 0);
+  return duration.count() / kReadsCount;
+}
+
+template <LogTimestampSourceConcept Source>
+double MeasureRecordNanoseconds() {
+  constexpr int kRecordsCount = 100000;
+  static BinaryLogDistributor<1 << 12, Source> distributor;
+  Logger logger("Bench", 0, distributor);
+  distributor.SetFilter(0, LogLevel::DEBUG);
+  NullStream stream;
+  auto start = std::chrono::steady_clock::now();
+  for (int i = 0; i < kRecordsCount; i++) {
+    LOG_INFO(logger, "Depth {}", i);
+    if (distributor.GetBufferedLength() > (1 << 11)) {
+      distributor.Drain(stream);
+    }
+  }
+  std::chrono::duration<double, std::nano> duration =
+      std::chrono::steady_clock::now() - start;
+  return duration.count() / kRecordsCount;
+}
+}  // namespace
+
+TEST(TestHydrolibLogTimestamp, ClockSourceKeepsRawTicks) {
+  using Source = LogTimestampSourceOf<TestClock>;
+  TestClock::current_time = TestClock::time_point(1500us);
+  EXPECT_EQ(Source::Now(), 1500000);
+  EXPECT_EQ(Source::GetTicksPerSecond(), 1000000000);
+
+  constexpr LogTimestampSource source = MakeLogTimestampSource<TestClock>();
+  EXPECT_EQ(source.now(), 1500000);
+  EXPECT_EQ(source.get_ticks_per_second(), 1000000000);
+}
+
+TEST(TestHydrolibLogTimestamp, CoarseMonotonicSourceAdvances) {
+  ExpectAdvances<CoarseMonotonicTimestampSource>(50ms);
+}
+
+#if defined(__x86_64__) || defined(__i386__)
+TEST(TestHydrolibLogTimestamp, TscSourceAdvances) {
+  EXPECT_GT(TscTimestampSource::GetTicksPerSecond(), 100000000);
+  ExpectAdvances<TscTimestampSource>(50ms);
+}
+#endif
+
+// Benchmark: cost of a timestamp read and of a whole binary record stamped
+// with it.
+TEST(TestHydrolibLogTimestamp, SourcesBenchmark) {
+  using Steady = LogTimestampSourceOf<std::chrono::steady_clock>;
+  std::cout << "steady_clock: " << MeasureNowNanoseconds<Steady>()
+            << " ns/read, " << MeasureRecordNanoseconds<Steady>()
+            << " ns/record\n";
+  std::cout << "CLOCK_MONOTONIC_COARSE: "
+            << MeasureNowNanoseconds<CoarseMonotonicTimestampSource>()
+            << " ns/read, "
+            << MeasureRecordNanoseconds<CoarseMonotonicTimestampSource>()
+            << " ns/record\n";
+#if defined(__x86_64__) || defined(__i386__)
+  std::cout << "TSC: " << MeasureNowNanoseconds<TscTimestampSource>()
+            << " ns/read, " << MeasureRecordNanoseconds<TscTimestampSource>()
+            << " ns/record\n";
+#endif
+}
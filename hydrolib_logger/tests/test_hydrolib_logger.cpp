@@ -1,14 +1,22 @@
 #include <gtest/gtest.h>
 
+#include <array>
+#include <chrono>
 #include <cstring>
 #include <iostream>
+#include <string>
+#include <vector>
 
 #include "hydrolib_log_distributor.hpp"
+#include "hydrolib_log_filter_table.hpp"
 #include "hydrolib_log_macro.hpp"
 #include "hydrolib_logger.hpp"
+#include "mock_clock.hpp"
+#include "mock_sink_stream.hpp"
 
 using namespace hydrolib::logger;
 using namespace std;
+using namespace std::literals::chrono_literals;
 
 class LogStream {
  public:
@@ -77,6 +85,17 @@ TEST(TestHydrolibLogger, TranslatorTest) {
   EXPECT_EQ(0, strcmp(buffer2, "[Logger1] [CRITICAL] Third: 3\n"));
 }
 
+TEST(TestHydrolibLogger, WideIntegersTest) {
+  manager.SetAllFilters(0, LogLevel::DEBUG);
+  stream1.Reset();
+  LOG_INFO(logger1, "{} {} {}", uint32_t{4000000000}, int64_t{-5000000000},
+           uint64_t{18000000000000000000U});
+  buffer1[stream1.GetLength()] = '\0';
+  EXPECT_STREQ(buffer1,
+               "[Logger1] [INFO] 4000000000 -5000000000 "
+               "18000000000000000000\n");
+}
+
 TEST(TestHydrolibLogger, FilterTest) {
   manager.SetAllFilters(0, LogLevel::DEBUG);
   manager.SetAllFilters(1, LogLevel::DEBUG);
@@ -108,6 +127,168 @@ TEST(TestHydrolibLogger, FilterTest) {
   EXPECT_EQ(length1, sizeof("[Logger2] [DEBUG] Message two: 2\n") - 1);
 }
 
+TEST(TestHydrolibLogger, StaticFloorTest) {
+  Logger<decltype(manager), LogLevel::WARNING> quiet_logger("Quiet", 0,
+                                                            manager);
+  static_assert(!IsLogLevelEnabled<decltype(quiet_logger)>(LogLevel::INFO));
+  static_assert(IsLogLevelEnabled<decltype(quiet_logger)>(LogLevel::WARNING));
+  static_assert(IsLogLevelEnabled<decltype(logger1)>(LogLevel::DEBUG));
+  manager.SetAllFilters(0, LogLevel::DEBUG);
+
+  int evaluated = 0;
+  stream1.Reset();
+  stream2.Reset();
+  LOG_DEBUG(quiet_logger, "Dropped: {}", ++evaluated);
+  LOG_INFO(quiet_logger, "Dropped: {}", ++evaluated);
+  EXPECT_EQ(evaluated, 0);
+  EXPECT_EQ(stream1.GetLength(), 0);
+
+  LOG_WARNING(quiet_logger, "Kept: {}", ++evaluated);
+  EXPECT_EQ(evaluated, 1);
+  EXPECT_EQ(stream1.GetLength(), sizeof("[Quiet] [WARNING] Kept: 1\n") - 1);
+}
+
+namespace {
+struct MillisecondSource {
+  static uint64_t Now() { return 3042; }
+  static uint64_t GetTicksPerSecond() { return 1000; }
+};
+}  // namespace
+
+TEST(TestHydrolibLogger, FormatFieldsTest) {
+  static constinit char buffer[100] = {};
+  static constinit LogStream stream(buffer);
+  static constinit LogDistributor distributor("#%n %t %l 100%% %m\n", stream);
+  Logger logger("Fields", 0, distributor);
+  distributor.SetAllFilters(0, LogLevel::DEBUG);
+  distributor.SetTimestampSource(MakeLogTimestampSource<MillisecondSource>());
+
+  LOG_INFO(logger, "Depth {}", 12);
+  buffer[stream.GetLength()] = '\0';
+  EXPECT_STREQ(buffer, "#0 3.042000 INFO 100% Depth 12\n");
+
+  stream.Reset();
+  LOG_ERROR(logger, "Leak");
+  buffer[stream.GetLength()] = '\0';
+  EXPECT_STREQ(buffer, "#1 3.042000 ERROR 100% Leak\n");
+}
+
+TEST(TestHydrolibLogger, FilterTableTest) {
+  LogFilterTable<3, 4> filters;
+  EXPECT_EQ(filters.GetStreamMask(0, LogLevel::CRITICAL), 0);
+
+  filters.SetAll(1, LogLevel::INFO);
+  filters.Set(2, 1, LogLevel::ERROR);
+  EXPECT_EQ(filters.GetStreamMask(1, LogLevel::DEBUG), 0b000);
+  EXPECT_EQ(filters.GetStreamMask(1, LogLevel::WARNING), 0b011);
+  EXPECT_EQ(filters.GetStreamMask(1, LogLevel::ERROR), 0b111);
+  EXPECT_EQ(filters.GetStreamMask(1, LogLevel::NO_LEVEL), 0);
+
+  filters.Set(0, 1, LogLevel::NO_LEVEL);
+  EXPECT_EQ(filters.GetStreamMask(1, LogLevel::CRITICAL), 0b110);
+  EXPECT_EQ(filters.GetStreamMask(3, LogLevel::CRITICAL), 0);
+
+  EXPECT_EQ(filters.Set(3, 0, LogLevel::DEBUG), hydrolib::ReturnCode::FAIL);
+  EXPECT_EQ(filters.SetAll(4, LogLevel::DEBUG), hydrolib::ReturnCode::FAIL);
+  static_assert(sizeof(LogFilterTable<8, 200>) == 200 * 5);
+}
+
+namespace {
+struct CountingStream {
+  int writes = 0;
+};
+
+int write(CountingStream &stream, [[maybe_unused]] const void *source,
+          unsigned length) {
+  stream.writes++;
+  return static_cast<int>(length);
+}
+
+constinit std::array<CountingStream, 8> sinks = {};
+}  // namespace
+
+// Benchmark: 200 loggers over 8 sinks, each sink taking a different level
+// range of every logger. Prints the mean time of a log.
+TEST(TestHydrolibLogger, EightSinksTwoHundredLoggersBenchmark) {
+  constexpr unsigned kLoggersCount = 200;
+  using Distributor =
+      LogDistributor<kLoggersCount, CountingStream, CountingStream,
+                     CountingStream, CountingStream, CountingStream,
+                     CountingStream, CountingStream, CountingStream>;
+  static constinit Distributor distributor(
+      "[%s] [%l] %m\n", sinks[0], sinks[1], sinks[2], sinks[3], sinks[4],
+      sinks[5], sinks[6], sinks[7]);
+  std::vector<Logger<Distributor>> loggers;
+  int accepted_count = 0;
+  for (unsigned i = 0; i < kLoggersCount; i++) {
+    loggers.emplace_back("Logger", i, distributor);
+    for (unsigned j = 0; j < sinks.size(); j++) {
+      auto level = static_cast<LogLevel>((i + j) % 6);
+      distributor.SetFilter(j, i, level);
+      if (level != LogLevel::NO_LEVEL) {
+        accepted_count += (LogLevel::DEBUG >= level ? 1 : 0) +
+                          (LogLevel::WARNING >= level ? 1 : 0);
+      }
+    }
+  }
+
+  constexpr int kRoundsCount = 50;
+  auto start = std::chrono::steady_clock::now();
+  for (int round = 0; round < kRoundsCount; round++) {
+    for (auto &logger : loggers) {
+      LOG_DEBUG(logger, "Value {}", round);
+      LOG_WARNING(logger, "Value {}", round);
+    }
+  }
+  auto duration = std::chrono::steady_clock::now() - start;
+
+  int writes = 0;
+  for (const auto &sink : sinks) {
+    writes += sink.writes;
+  }
+  EXPECT_EQ(writes, kRoundsCount * accepted_count);
+  std::cout << "Mean log time: "
+            << std::chrono::duration<double, std::nano>(duration).count() /
+                   (kRoundsCount * kLoggersCount * 2)
+            << " ns\n";
+}
+
+namespace {
+using hydrolib::streams::mock::TextStream;
+
+constinit TextStream text_stream = {};
+}  // namespace
+
+TEST(TestHydrolibLogger, RateLimitTest) {
+  using TestClock = hydrolib::streams::mock::TestClock;
+  static constinit LogDistributor distributor("%m\n", text_stream);
+  Logger logger("Limited", 0, distributor);
+  distributor.SetAllFilters(0, LogLevel::DEBUG);
+  TestClock::current_time = TestClock::time_point(10s);
+
+  int evaluated = 0;
+  auto log_depth = [&logger, &evaluated]() {
+    LOG_RATE_LIMITED(logger, LogLevel::WARNING, TestClock, 2, 1s,
+                     "Depth {}", ++evaluated);
+  };
+  for (int i = 0; i < 5; i++) {
+    log_depth();
+  }
+  EXPECT_EQ(evaluated, 2);
+  EXPECT_EQ(text_stream.text, "Depth 1\nDepth 2\n");
+
+  TestClock::current_time += 999ms;
+  log_depth();
+  EXPECT_EQ(evaluated, 2);
+
+  text_stream.text.clear();
+  TestClock::current_time += 1ms;
+  log_depth();
+  log_depth();
+  EXPECT_EQ(text_stream.text,
+            "Suppressed 4 repeats of: Depth {}\nDepth 3\nDepth 4\n");
+}
+
 // TEST(TestHydrolibLogger, DistributorTest)
 // {
 //     LogTranslator translator;
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <chrono>
+
+namespace hydrolib::streams::mock {
+
+// Virtual clock for tests: it only moves when a test advances current_time.
+struct TestClock {
+  using rep = std::chrono::nanoseconds::rep;
+  using period = std::chrono::nanoseconds::period;
+  using duration = std::chrono::nanoseconds;
+  using time_point = std::chrono::time_point<TestClock>;
+  static constexpr bool is_steady = true;
+
+  static time_point now() { return current_time; }
+
+  static inline time_point current_time{};
+};
+
+}  // namespace hydrolib::streams::mock
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace hydrolib::streams::mock {
+
+// Write-only streams that keep everything written to them. BinaryStream
+// accepts no more than free_space bytes, so tests can make writes fall short.
+struct BinaryStream {
+  std::vector<uint8_t> bytes;
+  int free_space = INT32_MAX;
+};
+
+struct TextStream {
+  std::string text;
+};
+
+inline int write(BinaryStream &stream, const void *source, unsigned length) {
+  int written = std::min(static_cast<int>(length), stream.free_space);
+  const auto *bytes = static_cast<const uint8_t *>(source);
+  stream.bytes.insert(stream.bytes.end(), bytes, bytes + written);
+  stream.free_space -= written;
+  return written;
+}
+
+inline int write(TextStream &stream, const void *source, unsigned length) {
+  stream.text.append(static_cast<const char *>(source), length);
+  return static_cast<int>(length);
+}
+
+}  // namespace hydrolib::streams::mock
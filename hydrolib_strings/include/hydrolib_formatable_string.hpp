@@ -6,6 +6,7 @@
 #include <concepts>
 #include <cstring>
 #include <string_view>
+#include <type_traits>
 
 #include "hydrolib_return_codes.hpp"
 #include "hydrolib_stream_concepts.hpp"
@@ -50,9 +51,10 @@ class StaticFormatableString {
                       int translated_length, T param, Ts... others) const
     requires ConvertibleToBytesConcept<T, DestType>;
   template <concepts::stream::ByteWritableStreamConcept DestType,
-            typename... Ts>
+            std::integral Integer, typename... Ts>
   ReturnCode ToBytes_(DestType &buffer, int next_param_index,
-                      int translated_length, int param, Ts... others) const;
+                      int translated_length, Integer param,
+                      Ts... others) const;
   template <concepts::stream::ByteWritableStreamConcept DestType>
   ReturnCode ToBytes_(DestType &buffer, int next_param_index,
                       int translated_length) const;
@@ -142,11 +144,12 @@ ReturnCode StaticFormatableString<ArgTypes...>::ToBytes_(DestType &buffer,
 }
 
 template <typename... ArgTypes>
-template <concepts::stream::ByteWritableStreamConcept DestType, typename... Ts>
+template <concepts::stream::ByteWritableStreamConcept DestType,
+          std::integral Integer, typename... Ts>
 ReturnCode StaticFormatableString<ArgTypes...>::ToBytes_(DestType &buffer,
                                                          int next_param_index,
                                                          int translated_length,
-                                                         int param,
+                                                         Integer param,
                                                          Ts... others) const {
   if (translated_length >= static_cast<int>(string_.size())) {
     return ReturnCode::OK;
@@ -163,10 +166,13 @@ ReturnCode StaticFormatableString<ArgTypes...>::ToBytes_(DestType &buffer,
   translated_length += param_pos_diffs_[next_param_index] + (sizeof("{}") - 1);
   next_param_index++;
 
-  std::array<char, 12> integer_bytes = {};
+  std::array<char, 20> integer_bytes = {};
 
+  // Printed at full width; bool has no to_chars().
+  auto value = std::conditional_t<std::same_as<Integer, bool>, int, Integer>(
+      param);
   auto convertion_result = std::to_chars(
-      integer_bytes.data(), integer_bytes.data() + integer_bytes.size(), param);
+      integer_bytes.data(), integer_bytes.data() + integer_bytes.size(), value);
   auto writing_result = write(buffer, integer_bytes.data(),
                               convertion_result.ptr - integer_bytes.data());
   if (writing_result == -1) {
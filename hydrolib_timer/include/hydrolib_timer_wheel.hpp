@@ -0,0 +1,271 @@
+#pragma once
+
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cstdint>
+
+#include "hydrolib_clock_concepts.hpp"
+
+namespace hydrolib::timer {
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+class TimerWheel;
+
+// One-shot timer, linked into a TimerWheel while it runs. It stays expired
+// until it is started again or stopped, so owners may poll IsExpired() instead
+// of passing a callback. A running timer must be stopped before it is
+// destroyed.
+class Timer final {
+ public:
+  using Callback = void (*)(void* context);
+
+  Timer() = default;
+  Timer(const Timer&) = delete;
+  Timer(Timer&&) = delete;
+  Timer& operator=(const Timer&) = delete;
+  Timer& operator=(Timer&&) = delete;
+  ~Timer();
+
+  [[nodiscard]] bool IsRunning() const;
+  [[nodiscard]] bool IsExpired() const;
+
+ private:
+  template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+            int kLevelsCount>
+  friend class TimerWheel;
+
+  enum class State : uint8_t { kIdle, kRunning, kExpired };
+
+  State state_ = State::kIdle;
+  uint64_t expiry_tick_ = 0;
+  Timer* next_ = nullptr;
+  Timer** link_ = nullptr;
+  Callback callback_ = nullptr;
+  void* context_ = nullptr;
+};
+
+// Hierarchical timing wheel shared by any number of timer owners. Level 0 has
+// a slot per tick, every next level has kSlotsCount times coarser slots, which
+// are cascaded down once per revolution of the level below. Starting and
+// stopping a timer is O(1) and a tick costs one slot of level 0 plus an
+// occasional cascade, however many timers run. A timer fires no earlier than
+// its timeout and at most two ticks later. Timeouts beyond the span of the
+// wheel are parked in the top level and rescheduled when their slot is
+// cascaded.
+template <concepts::clock::ClockConcept Clock, int kSlotsCount = 32,
+          int kLevelsCount = 4>
+class TimerWheel final {
+ public:
+  explicit TimerWheel(typename Clock::duration tick);
+  TimerWheel(const TimerWheel&) = delete;
+  TimerWheel(TimerWheel&&) = delete;
+  TimerWheel& operator=(const TimerWheel&) = delete;
+  TimerWheel& operator=(TimerWheel&&) = delete;
+  ~TimerWheel() = default;
+
+  // (Re)starts the timer. The callback is called from Process() when the
+  // timer fires and may start timers itself.
+  void Start(Timer& timer, typename Clock::duration timeout,
+             Timer::Callback callback = nullptr, void* context = nullptr);
+  void Stop(Timer& timer);
+
+  // Advances the wheel to Clock::now() and fires the due timers. Returns the
+  // number of fired timers.
+  int Process();
+
+  [[nodiscard]] int GetRunningCount() const;
+  [[nodiscard]] typename Clock::duration GetTick() const;
+
+ private:
+  static_assert(kSlotsCount > 1 &&
+                    std::has_single_bit(static_cast<unsigned>(kSlotsCount)),
+                "Slots count must be a power of two");
+  static constexpr int kSlotBits =
+      std::countr_zero(static_cast<unsigned>(kSlotsCount));
+  static_assert(kLevelsCount > 0 && kSlotBits * kLevelsCount < 64,
+                "Wheel span must fit into ticks");
+  static constexpr uint64_t kSlotMask = kSlotsCount - 1;
+  static constexpr uint64_t kSpan = uint64_t{1} << (kSlotBits * kLevelsCount);
+
+  [[nodiscard]] uint64_t GetNowTick() const;
+  void Insert(Timer& timer);
+  static void Unlink(Timer& timer);
+  void Cascade(int level);
+  int Advance();
+
+  const typename Clock::duration tick_;
+  uint64_t current_tick_ = 0;
+  int running_count_ = 0;
+  std::array<std::array<Timer*, kSlotsCount>, kLevelsCount> slots_{};
+};
+
+inline Timer::~Timer() {
+  assert(state_ != State::kRunning && "timer destroyed while running");
+}
+
+inline bool Timer::IsRunning() const { return state_ == State::kRunning; }
+
+inline bool Timer::IsExpired() const { return state_ == State::kExpired; }
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+TimerWheel<Clock, kSlotsCount, kLevelsCount>::TimerWheel(
+    typename Clock::duration tick)
+    : tick_(tick) {
+  assert(tick > typename Clock::duration{} && "tick must be positive");
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+void TimerWheel<Clock, kSlotsCount, kLevelsCount>::Start(
+    Timer& timer, typename Clock::duration timeout, Timer::Callback callback,
+    void* context) {
+  Stop(timer);
+  auto now_tick = GetNowTick();
+  // An empty wheel skips the ticks it was not processed for.
+  if (running_count_ == 0) {
+    current_tick_ = now_tick;
+  }
+  uint64_t ticks = 0;
+  if (timeout > typename Clock::duration{}) {
+    auto rounded = timeout + tick_ - typename Clock::duration{1};
+    ticks = static_cast<uint64_t>(rounded / tick_);
+  }
+  // The current tick has partly passed already.
+  timer.expiry_tick_ = now_tick + ticks + 1;
+  timer.callback_ = callback;
+  timer.context_ = context;
+  timer.state_ = Timer::State::kRunning;
+  running_count_++;
+  Insert(timer);
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+void TimerWheel<Clock, kSlotsCount, kLevelsCount>::Stop(Timer& timer) {
+  if (timer.state_ == Timer::State::kRunning) {
+    Unlink(timer);
+    running_count_--;
+  }
+  timer.state_ = Timer::State::kIdle;
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+int TimerWheel<Clock, kSlotsCount, kLevelsCount>::Process() {
+  if (running_count_ == 0) {
+    return 0;
+  }
+  auto now_tick = GetNowTick();
+  int fired = 0;
+  while (current_tick_ < now_tick && running_count_ != 0) {
+    current_tick_++;
+    fired += Advance();
+  }
+  if (running_count_ == 0) {
+    current_tick_ = now_tick;
+  }
+  return fired;
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+int TimerWheel<Clock, kSlotsCount, kLevelsCount>::GetRunningCount() const {
+  return running_count_;
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+typename Clock::duration TimerWheel<Clock, kSlotsCount, kLevelsCount>::GetTick()
+    const {
+  return tick_;
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+uint64_t TimerWheel<Clock, kSlotsCount, kLevelsCount>::GetNowTick() const {
+  return static_cast<uint64_t>(Clock::now().time_since_epoch() / tick_);
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+void TimerWheel<Clock, kSlotsCount, kLevelsCount>::Insert(Timer& timer) {
+  auto placement = timer.expiry_tick_;
+  if (placement < current_tick_) {
+    placement = current_tick_;
+  } else if (placement - current_tick_ >= kSpan) {
+    placement = current_tick_ + kSpan - 1;
+  }
+  auto delta = placement - current_tick_;
+  int level = 0;
+  while (level < kLevelsCount - 1 &&
+         delta >= (uint64_t{1} << (kSlotBits * (level + 1)))) {
+    level++;
+  }
+  auto& head = slots_[level][(placement >> (kSlotBits * level)) & kSlotMask];
+  timer.next_ = head;
+  timer.link_ = &head;
+  if (head != nullptr) {
+    head->link_ = &timer.next_;
+  }
+  head = &timer;
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+void TimerWheel<Clock, kSlotsCount, kLevelsCount>::Unlink(Timer& timer) {
+  *timer.link_ = timer.next_;
+  if (timer.next_ != nullptr) {
+    timer.next_->link_ = timer.link_;
+  }
+  timer.next_ = nullptr;
+  timer.link_ = nullptr;
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+void TimerWheel<Clock, kSlotsCount, kLevelsCount>::Cascade(int level) {
+  // Every timer of the slot is due within the current slot of the level
+  // below, so none of them is inserted back into this slot.
+  auto& head =
+      slots_[level][(current_tick_ >> (kSlotBits * level)) & kSlotMask];
+  while (head != nullptr) {
+    auto& timer = *head;
+    Unlink(timer);
+    Insert(timer);
+  }
+}
+
+template <concepts::clock::ClockConcept Clock, int kSlotsCount,
+          int kLevelsCount>
+int TimerWheel<Clock, kSlotsCount, kLevelsCount>::Advance() {
+  for (int level = 1; level < kLevelsCount; level++) {
+    if ((current_tick_ & ((uint64_t{1} << (kSlotBits * level)) - 1)) != 0) {
+      break;
+    }
+    Cascade(level);
+  }
+
+  // Timers are taken one by one, as callbacks may stop the others.
+  auto& head = slots_[0][current_tick_ & kSlotMask];
+  int fired = 0;
+  while (head != nullptr) {
+    auto& timer = *head;
+    Unlink(timer);
+    if (timer.expiry_tick_ > current_tick_) {
+      Insert(timer);
+      continue;
+    }
+    timer.state_ = Timer::State::kExpired;
+    running_count_--;
+    fired++;
+    if (timer.callback_ != nullptr) {
+      timer.callback_(timer.context_);
+    }
+  }
+  return fired;
+}
+
+}  // namespace hydrolib::timer
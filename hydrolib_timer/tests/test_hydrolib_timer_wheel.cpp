@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+
+#include <array>
+#include <chrono>
+#include <cstdint>
+
+#include "hydrolib_timer_wheel.hpp"
+#include "mock_clock.hpp"
+
+using namespace std::literals::chrono_literals;
+
+namespace {
+using TestClock = hydrolib::streams::mock::TestClock;
+
+struct Firing {
+  int count = 0;
+  TestClock::time_point time{};
+};
+
+void Record(void* context) {
+  auto* firing = static_cast<Firing*>(context);
+  firing->count++;
+  firing->time = TestClock::now();
+}
+
+class TestHydrolibTimerWheel : public ::testing::Test {
+ protected:
+  TestHydrolibTimerWheel() { TestClock::current_time = {}; }
+
+  template <typename Wheel>
+  static void Run(Wheel& wheel, TestClock::duration duration) {
+    auto end = TestClock::now() + duration;
+    while (TestClock::now() < end) {
+      TestClock::current_time += 1ms;
+      wheel.Process();
+    }
+  }
+};
+}  // namespace
+
+TEST_F(TestHydrolibTimerWheel, FiresAfterTimeout) {
+  hydrolib::timer::TimerWheel<TestClock> wheel(1ms);
+  hydrolib::timer::Timer timer;
+  Firing firing;
+  wheel.Start(timer, 10ms, Record, &firing);
+  EXPECT_TRUE(timer.IsRunning());
+
+  Run(wheel, 10ms);
+  EXPECT_EQ(firing.count, 0);
+  Run(wheel, 2ms);
+  EXPECT_EQ(firing.count, 1);
+  EXPECT_TRUE(timer.IsExpired());
+  EXPECT_EQ(wheel.GetRunningCount(), 0);
+  Run(wheel, 100ms);
+  EXPECT_EQ(firing.count, 1);
+}
+
+TEST_F(TestHydrolibTimerWheel, StoppedTimerDoesNotFire) {
+  hydrolib::timer::TimerWheel<TestClock> wheel(1ms);
+  hydrolib::timer::Timer timer;
+  Firing firing;
+  wheel.Start(timer, 5ms, Record, &firing);
+  Run(wheel, 3ms);
+  wheel.Stop(timer);
+  Run(wheel, 10ms);
+  EXPECT_EQ(firing.count, 0);
+  EXPECT_FALSE(timer.IsRunning());
+  EXPECT_FALSE(timer.IsExpired());
+}
+
+TEST_F(TestHydrolibTimerWheel, RestartPostponesTimeout) {
+  hydrolib::timer::TimerWheel<TestClock> wheel(1ms);
+  hydrolib::timer::Timer timer;
+  Firing firing;
+  wheel.Start(timer, 5ms, Record, &firing);
+  Run(wheel, 4ms);
+  wheel.Start(timer, 5ms, Record, &firing);
+  Run(wheel, 4ms);
+  EXPECT_EQ(firing.count, 0);
+  Run(wheel, 3ms);
+  EXPECT_EQ(firing.count, 1);
+  EXPECT_EQ(wheel.GetRunningCount(), 0);
+}
+
+TEST_F(TestHydrolibTimerWheel, FiresWithinTwoTicksAtEveryLevel) {
+  // Two levels of four slots span only 16 ticks, so long timeouts cascade
+  // and get parked beyond the span.
+  hydrolib::timer::TimerWheel<TestClock, 4, 2> wheel(1ms);
+  constexpr int kTimersCount = 64;
+  std::array<hydrolib::timer::Timer, kTimersCount> timers;
+  std::array<Firing, kTimersCount> firings{};
+  std::array<TestClock::duration, kTimersCount> timeouts{};
+  uint32_t seed = 1;
+  for (int i = 0; i < kTimersCount; i++) {
+    seed = seed * 1103515245 + 12345;
+    timeouts[i] = std::chrono::milliseconds(seed % 200);
+    wheel.Start(timers[i], timeouts[i], Record, &firings[i]);
+  }
+
+  Run(wheel, 210ms);
+  for (int i = 0; i < kTimersCount; i++) {
+    EXPECT_EQ(firings[i].count, 1) << i;
+    auto elapsed = firings[i].time - TestClock::time_point{};
+    EXPECT_GT(elapsed, timeouts[i]) << i;
+    EXPECT_LE(elapsed, timeouts[i] + 2ms) << i;
+  }
+}
+
+TEST_F(TestHydrolibTimerWheel, CallbackMayRestartTimer) {
+  struct Periodic {
+    hydrolib::timer::TimerWheel<TestClock>* wheel;
+    hydrolib::timer::Timer timer;
+    int count = 0;
+
+    static void OnTimeout(void* context) {
+      auto* self = static_cast<Periodic*>(context);
+      if (++self->count < 2) {
+        self->wheel->Start(self->timer, 9ms, OnTimeout, context);
+      }
+    }
+  } periodic{};
+  hydrolib::timer::TimerWheel<TestClock> wheel(1ms);
+  periodic.wheel = &wheel;
+  wheel.Start(periodic.timer, 9ms, Periodic::OnTimeout, &periodic);
+
+  Run(wheel, 25ms);
+  EXPECT_EQ(periodic.count, 2);
+  EXPECT_EQ(wheel.GetRunningCount(), 0);
+}
+
+TEST_F(TestHydrolibTimerWheel, CallbackMayStopDueTimer) {
+  struct Pair {
+    hydrolib::timer::TimerWheel<TestClock>* wheel;
+    std::array<hydrolib::timer::Timer, 2> timers;
+    int count = 0;
+  } pair{};
+  hydrolib::timer::TimerWheel<TestClock> wheel(1ms);
+  pair.wheel = &wheel;
+  auto on_timeout = [](void* context) {
+    auto* self = static_cast<Pair*>(context);
+    self->count++;
+    for (auto& timer : self->timers) {
+      self->wheel->Stop(timer);
+    }
+  };
+  wheel.Start(pair.timers[0], 3ms, on_timeout, &pair);
+  wheel.Start(pair.timers[1], 3ms, on_timeout, &pair);
+
+  Run(wheel, 10ms);
+  EXPECT_EQ(pair.count, 1);
+  EXPECT_EQ(wheel.GetRunningCount(), 0);
+}
+
+TEST_F(TestHydrolibTimerWheel, IdleWheelSkipsElapsedTime) {
+  hydrolib::timer::TimerWheel<TestClock> wheel(1ms);
+  hydrolib::timer::Timer timer;
+  TestClock::current_time += 10h;
+  EXPECT_EQ(wheel.Process(), 0);
+  wheel.Start(timer, 1ms);
+  TestClock::current_time += 2ms;
+  EXPECT_EQ(wheel.Process(), 1);
+  EXPECT_TRUE(timer.IsExpired());
+}
+
+TEST_F(TestHydrolibTimerWheel, ZeroTickIsRefused) {
+  EXPECT_DEATH(hydrolib::timer::TimerWheel<TestClock> wheel(0ms),
+               "tick must be positive");
+}